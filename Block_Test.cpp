@@ -40,14 +40,24 @@ static_assert(std::is_nothrow_move_assignable<BlockN>::value,
 
 const size_t MAX_SIZE_OF_BLOCK_FROM_STREAM = MAX_NDN_PACKET_SIZE; 
 
+const size_t BlockN::INLINE_CAPACITY;
+
 BlockN::BlockN()   //create an empty Block 
+  : m_next(NULL)
+  , m_begin(NULL)
+  , m_end(NULL)
+  , m_isInline(false)
+  , m_capacity(0)
+  , m_offset(0)
+  , m_size(0)
 {
 }
 
 BlockN::BlockN(const ConstBufferPtr& buffer) 
   : m_buffer(buffer)
-  , m_begin(m_buffer->begin())
-  , m_end(m_buffer->end())
+  , m_begin(m_buffer->data())
+  , m_end(m_begin + m_buffer->size())
+  , m_isInline(false)
   , m_capacity(m_end - m_begin)
 {
   m_next = NULL;
@@ -58,82 +68,124 @@ BlockN::BlockN(const ConstBufferPtr& buffer)
 BlockN::BlockN(const ConstBufferPtr& buffer,
                const Buffer::const_iterator& begin, const Buffer::const_iterator& end)
   : m_buffer(buffer)
-  , m_begin(begin)
-  , m_end(end)
+  , m_begin(m_buffer->data() + (begin - m_buffer->begin()))
+  , m_end(m_buffer->data() + (end - m_buffer->begin()))
+  , m_isInline(false)
   , m_capacity(m_end - m_begin)
 {
   m_next = NULL;
-  m_size = buffer->size();
+  m_size = m_capacity;
   m_offset = 0;
 }
 
+BlockN::BlockN(const BlockN& block, const_iterator begin, const_iterator end)
+  : m_next(NULL)
+  , m_isInline(block.isInline())
+  , m_capacity(end - begin)
+  , m_offset(0)
+  , m_size(m_capacity)
+{
+  if (m_isInline) {
+    std::copy(begin, end, m_inline);
+    m_begin = m_end = NULL;
+  }
+  else {
+    m_buffer = block.m_buffer;
+    m_begin = begin;
+    m_end = end;
+  }
+}
+
 BlockN::BlockN(const uint8_t* array, size_t length) 
 {
-  m_buffer = make_shared<Buffer>(array, array+length);
-  m_begin = m_buffer->begin();
-  m_end = m_buffer->end();
-  m_size = m_end - m_begin;
+  if (length <= INLINE_CAPACITY) {
+    std::copy(array, array + length, m_inline);
+    m_begin = m_end = NULL;
+    m_isInline = true;
+  }
+  else {
+    m_buffer = make_shared<Buffer>(array, array+length);
+    m_begin = m_buffer->data();
+    m_end = m_begin + m_buffer->size();
+    m_isInline = false;
+  }
+  m_size = length;
   m_capacity = m_size;
+  m_offset = 0;
   m_next = NULL;
 }
 
 BlockN::BlockN(size_t capacity)
 {
-  shared_ptr<Buffer> buf = new Buffer(capacity);
-  m_buffer = buf;
-  m_begin = m_buffer->begin();
-  m_end = m_buffer->end();
-  m_size = m_end - m_begin;
+  // the bytes are left uninitialized, they are written by the encoder
+  if (capacity <= INLINE_CAPACITY) {
+    m_begin = m_end = NULL;
+    m_isInline = true;
+  }
+  else {
+    m_buffer = make_shared<Buffer>(capacity, Buffer::UninitializedTag());
+    m_begin = m_buffer->data();
+    m_end = m_begin + m_buffer->size();
+    m_isInline = false;
+  }
+  m_size = capacity;
   m_capacity = m_size;
+  m_offset = 0;
   m_next = NULL;
 }
 
 BlockN*
 BlockN::allocate(size_t capacity) 
 {
-  shared_ptr<Buffer> buf = new Buffer(capacity);
-  BlockN block(buf);
-
-  return &block;
+  BlockN* block = new BlockN(make_shared<Buffer>(capacity, Buffer::UninitializedTag()));
+  block->setSize(0);
+  return block;
 }
 
 bool
 BlockN::hasBuffer() const
 {
-  return static_cast<bool>(m_buffer);
+  return m_isInline || static_cast<bool>(m_buffer);
+}
+
+bool
+BlockN::isInline() const
+{
+  return m_isInline;
 }
 
 bool
 BlockN::empty() const
 {
-  return m_buffer && (m_size == 0);
+  return hasBuffer() && (m_size == 0);
 }
 
 void
 BlockN::reset()
 {
   m_buffer.reset(); // reset of the shared_ptr
-  m_begin = m_end = Buffer::const_iterator();
+  m_begin = m_end = NULL;
+  m_isInline = false;
   m_capacity = m_offset = m_size = 0;
   m_next = NULL;
 }
 
-Buffer::const_iterator
+BlockN::const_iterator
 BlockN::begin() const
 {
   if (!hasBuffer())
     BOOST_THROW_EXCEPTION(Error("Underlying buffer is empty"));
 
-  return m_begin;
+  return m_isInline ? m_inline : m_begin;
 }
 
-Buffer::const_iterator
+BlockN::const_iterator
 BlockN::end() const
 {
   if (!hasBuffer())
     BOOST_THROW_EXCEPTION(Error("Underlying buffer is empty"));
 
-  return m_end;
+  return m_isInline ? m_inline + m_capacity : m_end;
 }
 
 const uint8_t*
@@ -142,7 +194,7 @@ BlockN::bufferValue() const
   if (!hasBuffer())
     BOOST_THROW_EXCEPTION(Error("Underlying buffer is empty"));
 
-  return &*m_begin; 
+  return begin();
 }
 
 size_t
@@ -218,7 +270,7 @@ BlockN::setOffset(size_t offset)
 }
 
 void
-BlockN::setBegin(Buffer::const_iterator newBegin)
+BlockN::setBegin(const_iterator newBegin)
 {
   m_begin = newBegin;
 }
@@ -226,9 +278,19 @@ BlockN::setBegin(Buffer::const_iterator newBegin)
 shared_ptr<const Buffer>
 BlockN::getBuffer() const
 {
+  if (m_isInline) {
+    // a copy, so that concurrent readers of a const block do not race on its members
+    return make_shared<Buffer>(m_inline, m_capacity);
+  }
   return m_buffer;
 }
 
+bool
+BlockN::isBufferShared() const
+{
+  return !m_isInline && m_buffer.use_count() > 1;
+}
+
 bool
 BlockN::inBlock(size_t position)
 {
@@ -245,6 +307,11 @@ BlockN::deAllocate()
   this->reset();
 }
 
+BlockN::operator boost::asio::const_buffer() const
+{
+  return boost::asio::const_buffer(begin(), size());
+}
+
 bool
 BlockN::operator!=(const BlockN& other) const
 {
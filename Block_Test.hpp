@@ -39,6 +39,10 @@ class const_buffer;
 namespace ndn {
 
 /** @brief Class representing a single element to construct a buffer wire of TLV format
+ *
+ *  A block of at most INLINE_CAPACITY bytes created from an array (or with such a capacity)
+ *  keeps its bytes inline, without a Buffer or shared_ptr.  getBuffer() returns a copy of
+ *  them, so an inline block is never modified by a const member function.
  */
 class BlockN
 {
@@ -52,6 +56,13 @@ class Error : public tlv::Error
     {
     }
   };
+
+  typedef const uint8_t* const_iterator;
+
+  /** @brief Maximum number of bytes stored inside the block itself
+   */
+  static const size_t INLINE_CAPACITY = 24;
+
 public: // constructor
   /** @brief Create an empty Block
    */
@@ -68,27 +79,46 @@ public: // constructor
   BlockN(const ConstBufferPtr& buffer,
           const Buffer::const_iterator& begin, const Buffer::const_iterator& end);
 
+  /** @brief Create a Block referring to [@p begin, @p end) of @p block
+   *
+   *  The underlying buffer is shared.  If @p block is inline, the bytes are copied.
+   */
+  BlockN(const BlockN& block, const_iterator begin, const_iterator end);
+
   /** @brief Create a Block from an array with capacity @p length
+   *
+   *  Up to INLINE_CAPACITY bytes are stored inline.
    */
   BlockN(const uint8_t* array, size_t length);
 
   /** @brief Create a Block and allocate buffer with capacity @p capacity
+   *
+   *  Up to INLINE_CAPACITY bytes are stored inline.  The bytes are not initialized.
    */
   BlockN(size_t capacity);
 
   //To do: destructor here
 	
 public: //basic functions
-  /** @brief Allocate a buffer and create a Block from the raw buffer with @p usedsize bytes used
+  /** @brief Allocate a buffer of @p capacity bytes from the SegmentPool and create a Block on it
+   *
+   *  The buffer is placed on the NUMA node of the calling thread and is not initialized.
    */
-  BlockN*
+  static BlockN*
   allocate(size_t capacity);
 
   /** @brief Check if the Block is empty
+   *
+   *  An inline block has a buffer.
    */
   bool
   hasBuffer() const;
 
+  /** @brief Check whether the bytes are stored inside the block
+   */
+  bool
+  isInline() const;
+
   /** @brief Check if the Buffer is empty
    */
   bool
@@ -99,10 +129,10 @@ public: //basic functions
   void
   reset();
 
-  Buffer::const_iterator
+  const_iterator
   begin() const;
 	
-  Buffer::const_iterator
+  const_iterator
   end() const;
 
   const uint8_t*
@@ -121,10 +151,18 @@ public: //basic functions
   next() const;
 
   /** @brief Get underlying buffer
+   *
+   *  An inline block returns a new Buffer holding a copy of its bytes on every call, which
+   *  is not shared with the block.
    */
   shared_ptr<const Buffer>
   getBuffer() const;
 
+  /** @brief Check whether the underlying buffer is referenced by other blocks as well
+   */
+  bool
+  isBufferShared() const;
+
   /** @brief Check whether the position @p position is in current block
    */
   bool
@@ -142,7 +180,7 @@ public: //basic functions
   setNext(BlockN* block);
 
   void
-  setBegin(Buffer::const_iterator newBegin);
+  setBegin(const_iterator newBegin);
 
   void
   setSize(size_t size);
@@ -164,11 +202,13 @@ public: // ConvertibleToConstBuffer
   operator boost::asio::const_buffer() const;
 
 private:
-  shared_ptr<const Buffer> m_buffer;      //points to a segment of underlying memory
+  shared_ptr<const Buffer> m_buffer;       //points to a segment of underlying memory
   BlockN* m_next;                          //points to the next block in the wire
 
-  Buffer::const_iterator m_begin; 
-  Buffer::const_iterator m_end;
+  const_iterator m_begin;                  //unused while inline
+  const_iterator m_end;
+  bool m_isInline;                         //bytes are in m_inline, m_buffer is empty
+  uint8_t m_inline[INLINE_CAPACITY];
 	
   size_t m_capacity;                      //maximum byte size of the buffer
   size_t m_offset;                        //absolute offset in the wire
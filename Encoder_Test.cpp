@@ -21,7 +21,7 @@
  * @author Alexander Afanasyev <http://lasr.cs.ucla.edu/afanasyev/index.html>
  */
 
-#include "encoder_Test.hpp"
+#include "encoder_test.hpp"
 #include "endian.hpp"
 
 namespace ndn {
@@ -29,11 +29,11 @@ namespace encoding {
 
 
 Encoder::Encoder(size_t firstReserve)
-  : m_wire(new Wire(firstReserve))
+  : m_wire(firstReserve)
 {
 }
 
-Encoder::Encodr(const Wire& wire)
+Encoder::Encoder(const Wire& wire)
   : m_wire(wire)
 {
 }
@@ -57,28 +57,7 @@ Encoder::appendByteArray(const uint8_t* array, size_t length)
 size_t
 Encoder::appendVarNumber(uint64_t varNumber)
 {
-  if (varNumber < 253) {
-    appendByte(static_cast<uint8_t>(varNumber));
-    return 1;
-  }
-  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
-    appendByte(253);
-    uint16_t value = htobe16(static_cast<uint16_t>(varNumber));
-    appendByteArray(reinterpret_cast<const uint8_t*>(&value), 2);
-    return 3;
-  }
-  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
-    appendByte(254);
-    uint32_t value = htobe32(static_cast<uint32_t>(varNumber));
-    appendByteArray(reinterpret_cast<const uint8_t*>(&value), 4);
-    return 5;
-  }
-  else {
-    appendByte(255);
-    uint64_t value = htobe64(varNumber);
-    appendByteArray(reinterpret_cast<const uint8_t*>(&value), 8);
-    return 9;
-  }
+  return WireSink(m_wire).appendVarNumber(varNumber);
 }
 
 size_t
@@ -104,19 +83,26 @@ Encoder::appendNonNegativeInteger(uint64_t varNumber)
 size_t
 Encoder::appendByteArrayBlock(uint32_t type, const uint8_t* array, size_t arraySize)
 {
-  size_t totalLength = appendVarNumber(type);
-  totalLength += appendVarNumber(arraySize);
+  WireSink sink(m_wire);
+  size_t totalLength = sink.appendVarNumber(type);
+  totalLength += sink.appendVarNumber(arraySize);
   totalLength += appendByteArray(array, arraySize);
 
   return totalLength;
 }
 
 size_t
-Encoder::appendBlock(const Block& block)
+Encoder::appendBlock(const BlockN& block)
 {
-  size_t length = m_wire.appendBlock(block);
+  size_t length = m_wire.appendSharedBlock(block);
   return length;
 }
 
+size_t
+Encoder::appendWire(const Wire& wire)
+{
+  return m_wire.appendWire(&wire);
+}
+
 }
 }
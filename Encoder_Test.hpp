@@ -27,6 +27,7 @@
 
 #include "common.hpp"
 #include "wire_test.hpp"
+#include "byte-sink.hpp"
 
 namespace ndn {
 namespace encoding {
@@ -43,12 +44,14 @@ public:   // common interface between Encoder and Estimator
    * @brief Create instance of the encoder with the specified reserved sizes
    * @param firstReserve initial the first buffer size to reserve
    */
+  explicit
   Encoder(size_t firstReserve);
 
   /**
    * @brief Create instance of the encoder from an existing @p wire
    */
-  Encodr(const Wire& wire);
+  explicit
+  Encoder(const Wire& wire);
 
   /**
    * @brief Append a byte
@@ -69,6 +72,17 @@ public:   // common interface between Encoder and Estimator
   size_t
   appendVarNumber(uint64_t varNumber);
 
+  /**
+   * @brief Append TLV-TYPE @p TYPE, encoded at compile time, and TLV-LENGTH @p length
+   * @sa ByteSink::appendTlvHeader
+   */
+  template<uint32_t TYPE>
+  size_t
+  appendTlvHeader(uint64_t length)
+  {
+    return WireSink(m_wire).appendTlvHeader<TYPE>(length);
+  }
+
   /**
    * @brief Append non-negative integer @p integer of NDN TLV encoding
    * @sa http://named-data.net/doc/ndn-tlv/
@@ -83,10 +97,19 @@ public:   // common interface between Encoder and Estimator
   appendByteArrayBlock(uint32_t type, const uint8_t* array, size_t arraySize);
 
   /**
-   * @brief Append TLV block @p block
+   * @brief Append the pre-encoded TLV block @p block
+   *
+   * The underlying buffer of @p block is shared, not copied.  Encoding continues in the
+   * spare capacity of the current buffer.
+   */
+  size_t
+  appendBlock(const BlockN& block);
+
+  /**
+   * @brief Append all blocks of the pre-encoded @p wire, sharing their buffers
    */
   size_t
-  appendBlock(const Block& block);
+  appendWire(const Wire& wire);
     
 private:
   Wire m_wire;
@@ -95,9 +118,18 @@ public: // unique interface to the Encoder
   typedef Buffer::iterator iterator;
   typedef Buffer::const_iterator const_iterator;
 
-
+  /**
+   * @brief Get the wire holding the encoded bytes
+   */
+  const Wire&
+  getWire() const
+  {
+    return m_wire;
+  }
 };
 
-}
-}
+} // namespace encoding
+} // namespace ndn
+
+#endif // NDN_ENCODING_ENCODER_TEST_HPP
 
@@ -22,8 +22,14 @@
  */
 
 #include "wire_test.hpp"
-#include "buffer-stream.hpp"
+#include "byte-sink.hpp"
+#include "encoding-counters.hpp"
 #include "tlv_test.hpp"
+#include "fast-hash.hpp"
+#include "segment-table.hpp"
+#include "sha256.hpp"
+
+#include <boost/asio/buffer.hpp>
 
 namespace ndn {
 
@@ -32,13 +38,23 @@ typedef shared_ptr<Wire>                    WirePtr;
 
 
 Wire::Wire()
+  : m_position(0)
+  , m_capacity(0)
+  , m_begin(NULL)
+  , m_current(NULL)
+  , m_end(NULL)
+  , m_count(0)
+  , m_type(0)
+  , m_autoCompactThreshold(0)
+  , m_hasHash(false)
 {
 }
 
 Wire::Wire(size_t capacity)
+  : m_autoCompactThreshold(0)
+  , m_hasHash(false)
 {
-  BlockN block(capacity);
-  m_begin = &block;
+  m_begin = BlockN::allocate(capacity);
   m_end = m_begin;
   m_current = m_begin;
   m_capacity = capacity;
@@ -51,11 +67,144 @@ Wire::Wire(BlockN* block)
   m_current(m_begin),
   m_end(m_begin),
   m_capacity(block->capacity()),
-  m_position(block->size())
+  m_position(block->size()),
+  m_autoCompactThreshold(0),
+  m_hasHash(false)
 {
   m_count = 1;
 }
 
+Wire::Wire(const ConstBufferPtr& buffer, Buffer::const_iterator begin, Buffer::const_iterator end)
+  : m_autoCompactThreshold(0)
+  , m_hasHash(false)
+{
+  m_begin = new BlockN(buffer, begin, end);
+  m_end = m_begin;
+  m_current = m_begin;
+  m_capacity = m_begin->capacity();
+  m_position = m_begin->size();
+  m_count = 1;
+}
+
+Wire::Wire(const Wire& other)
+  : m_position(other.m_position)
+  , m_capacity(other.m_capacity)
+  , m_begin(NULL)
+  , m_current(NULL)
+  , m_end(NULL)
+  , m_iovec(other.m_iovec)
+  , m_count(1)
+  , m_type(other.m_type)
+  , m_autoCompactThreshold(other.m_autoCompactThreshold)
+  , m_hasHash(false)
+  , m_sha256Digest(std::atomic_load(&other.m_sha256Digest))
+  , m_subWires(other.m_subWires)
+{
+  copyBlocks(other);
+  uint64_t hash;
+  if (other.getCachedHash(hash)) {
+    m_hash = hash;
+    m_hasHash = true;
+  }
+}
+
+Wire::Wire(Wire&& other) noexcept
+  : m_position(other.m_position)
+  , m_capacity(other.m_capacity)
+  , m_begin(other.m_begin)
+  , m_current(other.m_current)
+  , m_end(other.m_end)
+  , m_iovec(std::move(other.m_iovec))
+  , m_count(other.m_count)
+  , m_type(other.m_type)
+  , m_autoCompactThreshold(other.m_autoCompactThreshold)
+  , m_hasHash(other.m_hasHash)
+  , m_hash(other.m_hash)
+  , m_sha256Digest(std::move(other.m_sha256Digest))
+  , m_subWires(std::move(other.m_subWires))
+{
+  other.m_begin = other.m_current = other.m_end = NULL;
+  other.m_hasHash = false;
+}
+
+Wire::~Wire()
+{
+  deleteBlocks();
+}
+
+Wire&
+Wire::operator=(const Wire& other)
+{
+  if (this != &other) {
+    Wire copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+Wire&
+Wire::operator=(Wire&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  deleteBlocks();
+  m_position = other.m_position;
+  m_capacity = other.m_capacity;
+  m_begin = other.m_begin;
+  m_current = other.m_current;
+  m_end = other.m_end;
+  m_iovec = std::move(other.m_iovec);
+  m_count = other.m_count;
+  m_type = other.m_type;
+  m_autoCompactThreshold = other.m_autoCompactThreshold;
+  m_hasHash = other.m_hasHash;
+  m_hash = other.m_hash;
+  m_sha256Digest = std::move(other.m_sha256Digest);
+  m_subWires = std::move(other.m_subWires);
+
+  other.m_begin = other.m_current = other.m_end = NULL;
+  other.m_hasHash = false;
+  return *this;
+}
+
+void
+Wire::copyBlocks(const Wire& other)
+{
+  BlockN* previous = NULL;
+  try {
+    for (const BlockN* block = other.m_begin; block; block = block->next()) {
+      BlockN* copy = new BlockN(*block);
+      copy->setNextNull();
+      if (previous)
+        previous->setNext(copy);
+      else
+        m_begin = copy;
+      if (block == other.m_current)
+        m_current = copy;
+      if (block == other.m_end)
+        m_end = copy;
+      previous = copy;
+    }
+  }
+  catch (...) {
+    deleteBlocks();
+    throw;
+  }
+}
+
+void
+Wire::deleteBlocks() noexcept
+{
+  BlockN* block = m_begin;
+  while (block) {
+    BlockN* next = block->next();
+    delete block;
+    block = next;
+  }
+  m_begin = m_current = m_end = NULL;
+}
+
 bool
 Wire::hasWire() const
 {
@@ -125,22 +274,27 @@ Wire::setPositon(size_t position)
 }
 
 BlockN*
-Wire::findPosition(Buffer::const_iterator& begin, size_t position) const
+Wire::findPosition(BlockN::const_iterator& begin, size_t position) const
 {
   if (!hasWire())
     BOOST_THROW_EXCEPTION(Error("Wire is empty"));
 
+  if (position > size())
+    BOOST_THROW_EXCEPTION(Error("Position is beyond the end of the wire"));
+
   BlockN *block = m_begin;
-  if(position <= size()) {
-	// Is the new position within the current memory block?
-    if (m_current->inBlock(position)) {
-      // we're ok, new position is in this buffer, we're done :)
-    } 
-	else {
-      // we need to find the right buffer
-      while (!block->inBlock(position)) {
-        block = block->next();
-      }
+  if (position == size()) {
+    // no block holds the end, it is the end of the last one
+    block = m_end;
+  }
+  else if (m_current->inBlock(position)) {
+    // we're ok, new position is in this buffer, we're done :)
+    block = m_current;
+  }
+  else {
+    // we need to find the right buffer, empty blocks hold no position
+    while (!block->inBlock(position)) {
+      block = block->next();
     }
   }
   size_t relativeOffset = position - block->offset();
@@ -205,8 +359,7 @@ Wire::finalize()
     BlockN *current = m_current->next();
     while (current) {
       BlockN *next = current->next();
-      current->setNextNull();
-      current->deAllocate();     //still some problems here
+      delete current;
       current = next;
     }
     // Set the limit of the current block so buffer->position is the end
@@ -214,7 +367,273 @@ Wire::finalize()
     size_t setSize = m_position - m_current->offset();
     m_current->setSize(setSize);
     m_end = m_current;
+    resetCaches();
+  }
+
+  if (m_autoCompactThreshold > 0 && getSlack() > m_autoCompactThreshold) {
+    compact();
+  }
+}
+
+/** @brief Check whether @p block is worth copying into a right-sized segment
+ */
+static bool
+isCompactable(const BlockN* block)
+{
+  if (block->isInline() || block->isBufferShared())
+    return false;
+
+  return block->size() * 2 < block->getBuffer()->size();
+}
+
+/** @brief Copy the used bytes of blocks [@p first, @p end) into a new buffer of @p size bytes
+ */
+static shared_ptr<Buffer>
+copyRun(const BlockN* first, const BlockN* end, size_t size)
+{
+  shared_ptr<Buffer> buffer = make_shared<Buffer>(size, Buffer::UninitializedTag());
+  Buffer::iterator dest = buffer->begin();
+  for (const BlockN* i = first; i != end; i = i->next()) {
+    dest = std::copy(i->begin(), i->begin() + i->size(), dest);
+  }
+  return buffer;
+}
+
+BlockN*
+Wire::replaceRun(BlockN* previous, BlockN* first, BlockN* end, const ConstBufferPtr& buffer)
+{
+  BlockN* replacement = end;
+  if (buffer) {
+    replacement = new BlockN(buffer);
+    replacement->setOffset(first->offset());
+    replacement->setNext(end);
+    m_capacity += buffer->size();
+  }
+  if (previous)
+    previous->setNext(replacement);
+  else
+    m_begin = replacement;
+
+  bool hasCurrent = false;
+  bool hasEnd = false;
+  BlockN* i = first;
+  while (i != end) {
+    BlockN* next = i->next();
+    hasCurrent = hasCurrent || i == m_current;
+    hasEnd = hasEnd || i == m_end;
+    m_capacity -= i->capacity();
+    delete i;
+    i = next;
+  }
+
+  BlockN* last = replacement ? replacement : previous;
+  if (hasCurrent)
+    m_current = last;
+  if (hasEnd)
+    m_end = last;
+  return last;
+}
+
+size_t
+Wire::compact()
+{
+  if (!hasWire())
+    return 0;
+
+  size_t reclaimed = 0;
+  BlockN* previous = NULL;
+  BlockN* block = m_begin;
+  while (block) {
+    if (!isCompactable(block)) {
+      previous = block;
+      block = block->next();
+      continue;
+    }
+
+    // collect the run of compactable segments starting at this block
+    BlockN* first = block;
+    BlockN* last = block;
+    size_t runSize = 0;
+    size_t runHeld = 0;
+    while (block && isCompactable(block)) {
+      runSize += block->size();
+      runHeld += block->getBuffer()->size();
+      last = block;
+      block = block->next();
+    }
+    if (runSize == 0) {
+      previous = last;
+      continue;
+    }
+
+    previous = replaceRun(previous, first, block, copyRun(first, block, runSize));
+    reclaimed += runHeld - runSize;
+  }
+  return reclaimed;
+}
+
+size_t
+Wire::getSlack() const
+{
+  if (!hasWire())
+    return 0;
+
+  size_t slack = 0;
+  for (BlockN* block = m_begin; block; block = block->next()) {
+    if (!block->isInline() && !block->isBufferShared())
+      slack += block->getBuffer()->size() - block->size();
+  }
+  return slack;
+}
+
+size_t
+Wire::getMemoryUsage() const
+{
+  if (!hasWire())
+    return 0;
+
+  size_t usage = 0;
+  for (BlockN* block = m_begin; block; block = block->next()) {
+    usage += sizeof(BlockN);
+    if (!block->isInline())
+      usage += block->getBuffer()->capacity();
+  }
+  return usage;
+}
+
+void
+Wire::setAutoCompactThreshold(size_t threshold)
+{
+  m_autoCompactThreshold = threshold;
+}
+
+BlockN*
+Wire::splitAt(size_t position)
+{
+  for (BlockN* block = m_begin; block; block = block->next()) {
+    if (!block->inBlock(position))
+      continue;
+
+    size_t relativeOffset = position - block->offset();
+    if (relativeOffset == 0)
+      return block;
+
+    BlockN* tail = new BlockN(*block, block->begin() + relativeOffset,
+                              block->begin() + block->size());
+    tail->setOffset(position);
+    tail->setNext(block->next());
+    m_capacity -= block->capacity() - block->size();
+    block->setCapacity(relativeOffset);
+    block->setSize(relativeOffset);
+    block->setNext(tail);
+    if (m_end == block)
+      m_end = tail;
+    if (m_current == block && m_position >= position)
+      m_current = tail;
+    return tail;
+  }
+  return NULL;
+}
+
+/** @brief Find the value of the Content element of a Data packet in @p wire
+ */
+static bool
+findContent(const Wire& wire, size_t& contentBegin, size_t& contentEnd)
+{
+  size_t begin = 0;
+  size_t end = wire.size();
+  uint32_t type;
+  uint64_t length;
+  if (!tlv::readType(wire, begin, end, type) || type != tlv::Data ||
+      !tlv::readVarNumber(wire, begin, end, length) || length != end - begin)
+    return false;
+
+  while (begin < end) {
+    if (!tlv::readType(wire, begin, end, type) ||
+        !tlv::readVarNumber(wire, begin, end, length) || length > end - begin)
+      return false;
+
+    if (type == tlv::Content) {
+      contentBegin = begin;
+      contentEnd = begin + length;
+      return true;
+    }
+    begin += length;
+  }
+  return false;
+}
+
+size_t
+Wire::freeze(SegmentTable& table, size_t minContentSize)
+{
+  size_t contentBegin = 0;
+  size_t contentEnd = 0;
+  if (!hasWire() || !findContent(*this, contentBegin, contentEnd) ||
+      contentEnd - contentBegin < std::max<size_t>(minContentSize, 1))
+    return 0;
+  size_t contentSize = contentEnd - contentBegin;
+
+  // isolate the Content value in blocks of its own
+  BlockN* contentFirst = splitAt(contentBegin);
+  BlockN* contentLast = splitAt(contentEnd);
+  BlockN* previous = NULL;
+  for (BlockN* block = m_begin; block != contentFirst; block = block->next()) {
+    previous = block;
+  }
+
+  shared_ptr<const Buffer> owner;
+  if (contentFirst->next() == contentLast) {
+    owner = contentFirst->getBuffer();
+  }
+  else {
+    owner = copyRun(contentFirst, contentLast, contentSize);
+  }
+  const uint8_t* contentBytes = contentFirst->next() == contentLast ?
+                                contentFirst->begin() : owner->data();
+  bool isShared = false;
+  shared_ptr<const Buffer> segment = table.intern(contentBytes, contentSize, owner, &isShared);
+  BlockN* content = replaceRun(previous, contentFirst, contentLast, segment);
+
+  // right-size the header and the trailer, so the original segments can be released
+  if (m_begin != content) {
+    replaceRun(NULL, m_begin, content, copyRun(m_begin, content, contentBegin));
+  }
+  if (content->next()) {
+    size_t trailerSize = size() - contentEnd;
+    replaceRun(content, content->next(), NULL,
+               trailerSize > 0 ? copyRun(content->next(), NULL, trailerSize) : nullptr);
+  }
+  return isShared ? contentSize : 0;
+}
+
+bool
+Wire::getDataName(std::vector<uint8_t>& name) const
+{
+  size_t begin = 0;
+  size_t end = size();
+  uint32_t type;
+  uint64_t length;
+  if (!hasWire() || !tlv::readType(*this, begin, end, type) || type != tlv::Data ||
+      !tlv::readVarNumber(*this, begin, end, length) || length != end - begin)
+    return false;
+
+  size_t nameBegin = begin;
+  if (!tlv::readType(*this, begin, end, type) || type != tlv::Name ||
+      !tlv::readVarNumber(*this, begin, end, length) || length > end - begin)
+    return false;
+  size_t nameEnd = begin + length;
+
+  name.clear();
+  name.reserve(nameEnd - nameBegin);
+  size_t offset = 0;
+  for (BlockN* block = m_begin; block && offset < nameEnd; block = block->next()) {
+    size_t first = std::max(nameBegin, offset);
+    size_t last = std::min(nameEnd, offset + block->size());
+    if (first < last)
+      name.insert(name.end(), block->begin() + (first - offset), block->begin() + (last - offset));
+    offset += block->size();
   }
+  return true;
 }
 
 bool
@@ -228,11 +647,12 @@ Wire::getBufferFromIovec() //still some problems here
 {
   if(!hasIovec())
   	BOOST_THROW_EXCEPTION(Error("The iovec is empty")); //if iovec is not constructed, it fails
-  OBufferStream os;
+  BufferSink sink;
   for (io_iterator i = m_iovec.begin(); i != m_iovec.end(); ++i) {
-  os.write(reinterpret_cast<const char*>(i->begin()), i->size());
-}
-  return os.buf();
+    sink.append((*i)->data(), (*i)->size());
+  }
+  NDN_ENCODING_COUNT(WIRE_LINEARIZED_BYTES, sink.size());
+  return sink.buf();
 }
 
 size_t
@@ -247,13 +667,14 @@ Wire::remainingInCurrentBlock()
 void
 Wire::expand(size_t allocationSize)
 {
-  BlockN b;
-  BlockN *block =b.allocate(allocationSize);
+  NDN_ENCODING_COUNT(WIRE_EXPANSIONS, 1);
+  BlockN *block = BlockN::allocate(allocationSize);
   m_capacity += block->capacity();
-  block->setBegin(m_end->begin() + m_end->size());
+  block->setOffset(m_end->offset() + m_end->size());
 	
   m_end->setNext(block);
-  m_end->setCapacity(m_end->size());  //tailor the capacity of the last block into its current size
+  m_capacity -= m_end->capacity() - m_end->size();
+  m_end->setCapacity(m_end->size());  //tailor the capacity of the last block into its current size (compact() reclaims it)
   m_end = block;
 }
 
@@ -301,13 +722,15 @@ Wire::writeUint8(uint8_t value)
   expandIfNeeded();
 	
   size_t relativeOffset = m_position - m_current->offset();
-  Buffer::const_iterator iter = m_current->begin() + relativeOffset + 1;
-  *iter = value;
-  if (relativeOffset > m_current->size()) {
-	m_current->setSize(relativeOffset);
+  // segments of a wire are only written by the wire that allocated them
+  uint8_t* dest = const_cast<uint8_t*>(m_current->begin()) + relativeOffset;
+  *dest = value;
+  if (relativeOffset + 1 > m_current->size()) {
+	m_current->setSize(relativeOffset + 1);
   }
 
   m_position++;
+  resetCaches();
   return 1;
 }
 
@@ -349,9 +772,48 @@ Wire::writeUint64(uint64_t value)
   return 8;
 }
 
+uint8_t*
+Wire::prepare(size_t length)
+{
+  uint8_t* dest = tryPrepare(length);
+  if (dest == NULL)
+    BOOST_THROW_EXCEPTION(Error("Not enough contiguous space in the middle of the wire"));
+
+  return dest;
+}
+
+uint8_t*
+Wire::tryPrepare(size_t length)
+{
+  expandIfNeeded();
+
+  if (remainingInCurrentBlock() < length) {
+    if (m_current->next() != NULL)
+      return NULL;
+
+    expand(std::max<size_t>(2048, length));
+    m_current = m_end;
+  }
+
+  size_t relativeOffset = m_position - m_current->offset();
+  return const_cast<uint8_t*>(m_current->begin()) + relativeOffset;
+}
+
+void
+Wire::commit(size_t length)
+{
+  size_t relativeOffset = m_position - m_current->offset() + length;
+  if (relativeOffset > m_current->size()) {
+    m_current->setSize(relativeOffset);
+  }
+  m_position += length;
+  resetCaches();
+}
+
 size_t 
 Wire::appendArray(const uint8_t* array, size_t length)
 {
+  NDN_ENCODING_COUNT(WIRE_APPEND_BYTES, length);
   expandIfNeeded();
 	
   size_t offset = 0;
@@ -366,7 +828,7 @@ Wire::appendArray(const uint8_t* array, size_t length)
       }
 	
       size_t relativeOffset = m_position - m_current->offset();
-      auto dest = m_current->begin() + relativeOffset;
+      uint8_t* dest = const_cast<uint8_t*>(m_current->begin()) + relativeOffset;
       auto src = array + offset;     //notice !!
       std::copy(src, src + remaining, dest);
 	
@@ -379,6 +841,7 @@ Wire::appendArray(const uint8_t* array, size_t length)
 	  offset += remaining;
     }
   }
+  resetCaches();
   return length;
 }
 
@@ -387,8 +850,8 @@ Wire::appendBlock(BlockN* block)
 {
   finalize();
   // we assume that this is a single block (only when a block is put into a wire it will has next pointer)
-  if (!(block->next()))
-    BOOST_THROW_EXCEPTION(Error("block does not have next pointer until put into a wire"));
+  if (block->next() != NULL)
+    BOOST_THROW_EXCEPTION(Error("block is already linked into a wire"));
 
   m_end->setNext(block);
   m_end = block;
@@ -397,10 +860,126 @@ Wire::appendBlock(BlockN* block)
   m_current = m_end; 
   m_position += m_end->size();
   m_capacity += m_end->capacity();
+  resetCaches();
 
   return m_end->size();
 }
 
+/** @brief Minimum spare capacity of the current block that is kept after an appended shared block
+ *
+ *  A smaller remainder is abandoned, like in reserve().
+ */
+static const size_t MIN_REUSED_SPARE_CAPACITY = 32;
+
+BlockN*
+Wire::detachSpare()
+{
+  finalize();
+  // the current block may be full with empty blocks following it
+  if (m_current != m_end && m_position == m_end->offset())
+    m_current = m_end;
+
+  BlockN* spare = NULL;
+  size_t used = m_position - m_current->offset();
+  if (!m_current->isInline() && m_current->capacity() - used >= MIN_REUSED_SPARE_CAPACITY) {
+    spare = new BlockN(*m_current, m_current->begin() + used,
+                       m_current->begin() + m_current->capacity());
+    spare->setSize(0);
+  }
+  else {
+    m_capacity -= m_current->capacity() - used;
+  }
+  m_current->setCapacity(used);
+  m_current->setSize(used);
+  resetCaches();
+  return spare;
+}
+
+size_t
+Wire::linkReference(const BlockN& block)
+{
+  BlockN* reference = m_end;
+  if (m_end->size() == 0 && m_end->capacity() == 0) {
+    // the last block was emptied by detachSpare(), e.g. a spare of an earlier append
+    *reference = BlockN(block, block.begin(), block.begin() + block.size());
+  }
+  else {
+    reference = new BlockN(block, block.begin(), block.begin() + block.size());
+    m_end->setNext(reference);
+  }
+  reference->setOffset(m_position);
+  m_capacity += reference->size();
+  m_position += reference->size();
+  m_current = m_end = reference;
+  return reference->size();
+}
+
+void
+Wire::attachSpare(BlockN* spare)
+{
+  if (spare == NULL)
+    return;
+
+  spare->setOffset(m_position);
+  m_end->setNext(spare);
+  m_current = m_end = spare;
+}
+
+size_t
+Wire::appendSharedBlock(const BlockN& block)
+{
+  BlockN* spare = detachSpare();
+  size_t length = linkReference(block);
+  attachSpare(spare);
+  return length;
+}
+
+size_t
+Wire::appendWire(const Wire* wire)
+{
+  if (wire == NULL || !wire->hasWire())
+    return 0;
+
+  BlockN* spare = detachSpare();
+  // take the blocks before linking any, so that a wire can be appended to itself
+  std::vector<const BlockN*> blocks;
+  for (const BlockN* block = wire->m_begin; block; block = block->next()) {
+    if (block->size() > 0)
+      blocks.push_back(block);
+  }
+
+  size_t length = 0;
+  for (const BlockN* block : blocks) {
+    length += linkReference(*block);
+  }
+  attachSpare(spare);
+  return length;
+}
+
+size_t
+Wire::prependArray(const uint8_t* array, size_t length)
+{
+  if (length == 0)
+    return 0;
+
+  BlockN* block = new BlockN(array, length);
+  if (m_begin == NULL) {
+    m_current = m_end = block;
+    m_capacity = 0;
+    m_position = 0;
+    m_count = 1;
+  }
+  for (BlockN* i = m_begin; i; i = i->next()) {
+    i->setOffset(i->offset() + length);
+  }
+  block->setNext(m_begin);
+  m_begin = block;
+  m_capacity += length;
+  m_position += length;
+  resetCaches();
+  m_subWires.clear();
+  return length;
+}
 
 uint8_t 
 Wire::readUint8(size_t position) const
@@ -420,20 +999,196 @@ Wire::readUint8(size_t position) const
 shared_ptr<Buffer>
 Wire::getBuffer()
 {
-  OBufferStream os;
-  size_t totalSize = 0;
+  BufferSink sink;
+  sink.reserve(size());
   BlockN *block = m_begin;
   while (block) {
-  	totalSize += block->size();
-    os.write(reinterpret_cast<const char*>(block->bufferValue()), block->size());
+    sink.append(block->bufferValue(), block->size());
     block = block->next();
   }
-  return os.buf();
+  NDN_ENCODING_COUNT(WIRE_LINEARIZED_BYTES, sink.size());
+  return sink.buf();
+}
+
+bool
+Wire::equals(const Wire& other) const
+{
+  if (this == &other)
+    return true;
+  if (!hasWire() || !other.hasWire())
+    return hasWire() == other.hasWire();
+  if (size() != other.size())
+    return false;
+  uint64_t hash;
+  uint64_t otherHash;
+  if (getCachedHash(hash) && other.getCachedHash(otherHash) && hash != otherHash)
+    return false;
+
+  // walk both chains, comparing the overlap of the current blocks on each side
+  const BlockN* a = m_begin;
+  const BlockN* b = other.m_begin;
+  size_t aOffset = 0;
+  size_t bOffset = 0;
+  while (a && b) {
+    size_t length = std::min(a->size() - aOffset, b->size() - bOffset);
+    if (length > 0 && std::memcmp(a->begin() + aOffset, b->begin() + bOffset, length) != 0)
+      return false;
+
+    aOffset += length;
+    bOffset += length;
+    if (aOffset == a->size()) {
+      a = a->next();
+      aOffset = 0;
+    }
+    if (bOffset == b->size()) {
+      b = b->next();
+      bOffset = 0;
+    }
+  }
+  return true;
+}
+
+bool
+Wire::operator==(const Wire& other) const
+{
+  return equals(other);
+}
+
+bool
+Wire::operator!=(const Wire& other) const
+{
+  return !equals(other);
+}
+
+uint64_t
+Wire::hash() const
+{
+  uint64_t value;
+  if (getCachedHash(value))
+    return value;
+
+  FastHash hash;
+  for (const BlockN* block = m_begin; block; block = block->next()) {
+    if (block->size() > 0)
+      hash.update(block->begin(), block->size());
+  }
+  value = hash.digest();
+  // concurrent callers store the same value, the flag publishes it
+  __atomic_store_n(&m_hash, value, __ATOMIC_RELAXED);
+  __atomic_store_n(&m_hasHash, true, __ATOMIC_RELEASE);
+  return value;
+}
+
+bool
+Wire::getCachedHash(uint64_t& value) const
+{
+  if (!__atomic_load_n(&m_hasHash, __ATOMIC_ACQUIRE))
+    return false;
+
+  value = __atomic_load_n(&m_hash, __ATOMIC_RELAXED);
+  return true;
+}
+
+ConstBufferPtr
+Wire::getSha256Digest() const
+{
+  ConstBufferPtr digest = std::atomic_load(&m_sha256Digest);
+  if (digest == nullptr) {
+    digest = computeSha256Digest(0, size());
+    std::atomic_store(&m_sha256Digest, digest);
+  }
+  return digest;
+}
+
+void
+Wire::resetCaches()
+{
+  m_hasHash = false;
+  m_sha256Digest.reset();
+}
+
+ConstBufferPtr
+Wire::computeSha256Digest(size_t offset, size_t length) const
+{
+  if (offset > size() || length > size() - offset)
+    BOOST_THROW_EXCEPTION(Error("Range of the digest is beyond the end of the wire"));
+
+  Sha256 sha256;
+  for (const BlockN* block = m_begin; block && length > 0; block = block->next()) {
+    if (offset >= block->size()) {
+      offset -= block->size();
+      continue;
+    }
+    size_t toHash = std::min(length, block->size() - offset);
+    sha256.update(block->begin() + offset, toHash);
+    offset = 0;
+    length -= toHash;
+  }
+  return sha256.computeDigest();
+}
+
+Wire::const_buffer_iterator::value_type
+Wire::const_buffer_iterator::operator*() const
+{
+  return *m_block;
+}
+
+size_t
+Wire::ConstBuffers::count() const
+{
+  size_t count = 0;
+  for (const BlockN* block = m_first; block; block = block->next()) {
+    count++;
+  }
+  return count;
 }
 
+Wire::const_iterator
+Wire::begin() const
+{
+  return const_iterator(m_begin);
+}
+
+Wire::const_iterator
+Wire::end() const
+{
+  return const_iterator();
+}
+
+Wire::ConstBuffers
+Wire::buffers() const
+{
+  return ConstBuffers(m_begin);
+}
+
+#ifdef NDN_CXX_HAVE_ENCODING_COUNTERS
+/** @brief Count a wire split by parse(), made of the non-empty segments from @p block on
+ */
+static void
+countParsedSegments(const BlockN* block)
+{
+  size_t nSegments = 0;
+  for (; block != nullptr; block = block->next()) {
+    if (block->size() > 0)
+      ++nSegments;
+  }
+  NDN_ENCODING_COUNT(WIRE_PARSED_PACKETS, 1);
+  NDN_ENCODING_COUNT(WIRE_PARSED_SEGMENTS, nSegments);
+  if (nSegments <= 1)
+    NDN_ENCODING_COUNT(WIRE_PARSED_1_SEGMENT, 1);
+  else if (nSegments == 2)
+    NDN_ENCODING_COUNT(WIRE_PARSED_2_SEGMENTS, 1);
+  else if (nSegments <= 4)
+    NDN_ENCODING_COUNT(WIRE_PARSED_3_4_SEGMENTS, 1);
+  else if (nSegments <= 8)
+    NDN_ENCODING_COUNT(WIRE_PARSED_5_8_SEGMENTS, 1);
+}
+#endif
+
 void
 Wire::parse() const
 {
+  NDN_ENCODING_COUNT(WIRE_PARSE_CALLS, 1);
   if (!m_subWires.empty() || size() == 0)	//there have been some wires in the container
     return;
 	
@@ -442,41 +1197,39 @@ Wire::parse() const
 	
   while (begin != end) {
     size_t element_begin = begin;
-	Buffer::const_iterator tmp_begin;
+	BlockN::const_iterator tmp_begin;
 	
 	uint32_t type = tlv::readType(*this, begin, end);
 	uint64_t length = tlv::readVarNumber(*this, begin, end);
 	
 	if (length > static_cast<uint64_t>(end - begin)) {
 	  m_subWires.clear();				//********************
+	  NDN_ENCODING_COUNT(TLV_ERRORS_LENGTH_OVERFLOW, 1);
 	  BOOST_THROW_EXCEPTION(tlv::Error("TLV length exceeds buffer length"));
         }
 	size_t element_end = begin + length;
-	Buffer::const_iterator tmp_end;
-	BlockN* beginBlock = findPosition(tmp_begin, element_begin);
-	BlockN* endBlock = findPosition(tmp_end, element_end);
-	//if subwire's begin and subwire's end are in the same block(underlying buffer is consecutive)
-	if (beginBlock = endBlock) {
-          BlockN* first = new BlockN(beginBlock->getBuffer(), tmp_begin, tmp_end);
-	  Wire wire = Wire(first);
-	  wire.m_type = type;
-	  m_subWires.push_back(wire); 
+	// the subwire refers to the bytes of the element in each block it spans
+	BlockN* block = findPosition(tmp_begin, element_begin);
+	size_t remaining = element_end - element_begin;
+	size_t sliceSize = std::min<size_t>(block->begin() + block->size() - tmp_begin, remaining);
+	Wire wire(new BlockN(*block, tmp_begin, tmp_begin + sliceSize));
+	wire.m_type = type;
+	remaining -= sliceSize;
+	while (remaining > 0) {
+	  block = block->next();
+	  sliceSize = std::min(block->size(), remaining);
+	  if (sliceSize > 0)
+	    wire.appendBlock(new BlockN(*block, block->begin(), block->begin() + sliceSize));
+	  remaining -= sliceSize;
 	}
-	else {
-          BlockN* first = new BlockN(beginBlock->getBuffer(), tmp_begin, tmp_end);
-          Wire wire = Wire(first);
-          wire.m_type = type;
-	  BlockN* block= beginBlock->next();
-	  while(block != endBlock) { 
-	  	wire.appendBlock(BlockN(block->getBuffer(), block->begin(), block->end())); 
-		block = block->next();
-	  }
-	  wire.appendBlock(BlockN(block->getBuffer(), block->begin(), tmp_end()));
-	  m_subWires.push_back(wire);
-        }
+	m_subWires.push_back(std::move(wire));
+	NDN_ENCODING_COUNT(WIRE_SUBWIRES, 1);
 	begin = element_end;
 	// don't do recursive parsing, just the top level
   }
+#ifdef NDN_CXX_HAVE_ENCODING_COUNTERS
+  countParsedSegments(m_begin);
+#endif
 }
 
 const Wire&
@@ -34,11 +34,33 @@ class const_buffer;
 } // namespace boost
 
 namespace ndn {
+
+class SegmentTable;
+
 /** @brief Class representing a series of linked blocks
+ *
+ *  Const member functions may run concurrently on one wire, e.g. one shared by a
+ *  ContentStore; writes need exclusive access.
+ *
+ *  A wire owns its blocks and deletes them when destroyed, which releases their segments once
+ *  no other block refers to them.  A copy gets blocks of its own on the same buffers (inline
+ *  bytes are copied) and its own hash() and getSha256Digest() caches, so after a write through
+ *  one copy the caches of the others are stale: do not write to a wire whose copies are
+ *  still read.
  */
 class Wire
 {
 public:
+  class Error : public tlv::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : tlv::Error(what)
+    {
+    }
+  };
+
   typedef std::vector<shared_ptr<const Buffer>>     io_container;
   typedef io_container::iterator              io_iterator;
   typedef io_container::const_iterator        io_const_iterator;
@@ -57,14 +79,34 @@ public://constructor
   Wire(size_t capacity);
 	
   /** @brief Create a wire with the fisrt block @p block
+   *
+   *  The wire takes ownership of @p block.
    */
   Wire(BlockN* block);
 
   /** @brief Create a wire with the fisrt block whose buffer is @p buffer
    *  @param begin the begin of data in this buffer
-   *  @param begin the end of data in this buffer
+   *  @param end the end of data in this buffer
+   *
+   *  The buffer is shared, not copied, so an ExternalBuffer becomes a wire without a copy.
+   */
+  Wire(const ConstBufferPtr& buffer, Buffer::const_iterator begin, Buffer::const_iterator end);
+
+  /** @brief Create a wire with copies of the blocks of @p other, on the same buffers
+   */
+  Wire(const Wire& other);
+
+  /** @brief Take the blocks of @p other, leaving it without blocks
    */
-  Wire(BufferPtr& buffer, Buffer::const_iterator begin, Buffer::const_iterator end);
+  Wire(Wire&& other) noexcept;
+
+  ~Wire();
+
+  Wire&
+  operator=(const Wire& other);
+
+  Wire&
+  operator=(Wire&& other) noexcept;
   
 public: //wire
   /** @brief Check if the Wire is empty
@@ -99,9 +141,12 @@ public: //wire
 
   /** @brief Find the block and buffer which @p position offset lies, set the iterator to this position
    *  Return the pointer to this block
+   *
+   *  For @p position equal to size(), this is the last block with the iterator at its end.
+   *  @throw Error @p position is beyond the end of the wire
    */
   BlockN*
-  findPosition(Buffer::const_iterator& begin, size_t position) const;
+  findPosition(BlockN::const_iterator& begin, size_t position) const;
 
   uint32_t
   type() const;
@@ -177,6 +222,26 @@ public: //operate the wire
   size_t 
   writeUint64(uint64_t value);
 	
+  /** @brief Return a pointer to @p length contiguous writable bytes at the current position
+   *
+   *  A new block is added when the current one is short, so the returned bytes never span
+   *  two blocks.  The bytes become part of the wire only after commit().
+   *  @throw Error if the current block is short and is not the last block of the wire
+   */
+  uint8_t*
+  prepare(size_t length);
+
+  /** @brief Like prepare(), but return NULL instead of throwing when the current block is
+   *         short and is not the last block of the wire, e.g. after setPositon()
+   */
+  uint8_t*
+  tryPrepare(size_t length);
+
+  /** @brief Advance the current position past @p length bytes written through prepare()
+   */
+  void
+  commit(size_t length);
+
   /** @brief Append an array with @p length bytes to the current position, allocating new block as necessary
    *  Return the size of the appended array
    */
@@ -185,23 +250,49 @@ public: //operate the wire
 	
   /** @brief Append a block to the current position 
    *  This will call finalize and throw buffer after current position
+   *  The wire takes ownership of @p block, unless an exception is thrown.
    *  Return the size of the appended block
+   *  @throw Error @p block is already linked to other blocks
    */
   size_t 
   appendBlock(BlockN* block);
 	
+  /** @brief Append a reference to the used bytes of the pre-encoded @p block
+   *
+   *  The underlying buffer of @p block is shared, not copied, so its bytes must not change
+   *  afterwards.  Spare capacity of the current block is kept as a new block after the
+   *  reference, and writing continues there.  Blocks after the current position are discarded.
+   *  Return the size of the appended block
+   */
+  size_t
+  appendSharedBlock(const BlockN& block);
+
   /** @brief Insert a block to the current position 
    *  This will throw data in current block after current position
    */
   size_t 
   insertBlock(const BlockN* block); //complicated 
 
-  /** @brief Append a wire @p wire to the current position (not decided yet)
-   *  This function will combine two wire together into a longer one
+  /** @brief Append a wire @p wire to the current position
+   *  This function will combine two wire together into a longer one.  Every non-empty block
+   *  of @p wire is appended by shared reference like in appendSharedBlock(), so no bytes are
+   *  copied, and the spare capacity of the current block follows the last one.  @p wire may
+   *  be this wire.
+   *  Return the size of the appended wire
    */
   size_t 
   appendWire(const Wire* wire);
 
+  /** @brief Insert @p length bytes of @p array before the first byte of this wire
+   *
+   *  The bytes go into a new first block, inline when short, so nothing already in the wire
+   *  is moved.  This adds a TLV header once the length of its value is known, e.g. after
+   *  the value has been signed.  The current position stays at the same byte.
+   *  Return the size of the prepended array
+   */
+  size_t
+  prependArray(const uint8_t* array, size_t length);
+
   /** @brief read the `uint8_t` in @p position position 
    */
   uint8_t 
@@ -209,10 +300,214 @@ public: //operate the wire
 
   /** @brief From logical continuous wire create a physical continuous memory buffer
    *  Return the shared pointer of this underlying buffer
+   *
+   *  The buffer comes from BufferSink::buf(), so bytes added later by resize(n) are left
+   *  indeterminate; use resize(n, 0) to zero-fill them.
    */
   shared_ptr<Buffer>
   getBuffer();
 
+public: //compaction
+  /** @brief Merge runs of mostly empty segments into right-sized pooled segments
+   *
+   *  A segment takes part if its buffer is not shared with another block and less than half
+   *  of the buffer is used.  Each run of such segments is copied into one new segment of
+   *  exactly the run's size, and the old buffers are released, including the spare capacity
+   *  of the last segment.  Call it once the wire is encoded, e.g. before caching it.
+   *  Copies of this wire keep the old segments until they are destroyed.
+   *  Return the number of bytes reclaimed
+   */
+  size_t
+  compact();
+
+  /** @brief Return the bytes held by segments of this wire but not used
+   *  Buffers shared with other blocks are not counted
+   */
+  size_t
+  getSlack() const;
+
+  /** @brief Return the bytes of memory held by this wire: its blocks and the whole
+   *         capacity of the segments they refer to
+   *  Buffers shared with other blocks are counted in full
+   */
+  size_t
+  getMemoryUsage() const;
+
+  /** @brief Let finalize() call compact() when getSlack() exceeds @p threshold bytes
+   *  0 disables the automatic compaction, which is the default
+   */
+  void
+  setAutoCompactThreshold(size_t threshold);
+
+public: //storage
+  /** @brief Prepare an encoded Data packet for long-term storage
+   *
+   *  If the Content value has at least @p minContentSize bytes, it is moved into a block of
+   *  its own and interned in @p table, so that identical payloads of stored packets share one
+   *  buffer.  The rest of the packet is copied into right-sized buffers, which releases the
+   *  segments the packet was encoded in.  A wire that is not a Data packet is left unchanged.
+   *  Return the number of bytes now shared with a previously frozen packet.
+   */
+  size_t
+  freeze(SegmentTable& table, size_t minContentSize = 1024);
+
+  /** @brief Copy the Name TLV of the Data packet in this wire into @p name
+   *  Return false if this wire is not a Data packet starting with a Name
+   */
+  bool
+  getDataName(std::vector<uint8_t>& name) const;
+
+public: //comparison
+  /** @brief Check whether this wire holds the same bytes as @p other
+   *
+   *  The two wires may be split into blocks at different boundaries.  Different cached
+   *  hashes decide the comparison without looking at the bytes.
+   */
+  bool
+  equals(const Wire& other) const;
+
+  bool
+  operator==(const Wire& other) const;
+
+  bool
+  operator!=(const Wire& other) const;
+
+  /** @brief Return a non-cryptographic hash of the bytes of this wire
+   *
+   *  The hash does not depend on how the bytes are split into blocks.  It is computed on
+   *  first use and cached until the wire is written; the cache is published atomically.
+   *  @sa FastHash
+   */
+  uint64_t
+  hash() const;
+
+  /** @brief Return the SHA-256 digest of the bytes of this wire, e.g. the
+   *         ImplicitSha256DigestComponent of a Data packet
+   *
+   *  Each block is fed to the digest in place, without linearizing the wire.  The digest is
+   *  computed on first use and cached until the wire is written, so looking up a frozen
+   *  packet by its full name repeatedly hashes it once.  The cache is published with
+   *  std::atomic_store, so concurrent callers may each compute the digest but read a complete
+   *  one.
+   *  @sa Sha256
+   */
+  ConstBufferPtr
+  getSha256Digest() const;
+
+  /** @brief Return the SHA-256 digest of @p length bytes from offset @p offset, not cached
+   *  @throw Error the range is beyond the end of the wire
+   */
+  ConstBufferPtr
+  computeSha256Digest(size_t offset, size_t length) const;
+
+public: //ConstBufferSequence
+  /** @brief Iterator over the used bytes of each block, as boost::asio::const_buffer
+   */
+  class const_buffer_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef boost::asio::const_buffer value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef value_type reference;
+
+    explicit
+    const_buffer_iterator(const BlockN* block = NULL)
+      : m_block(block)
+    {
+    }
+
+    value_type
+    operator*() const;
+
+    const_buffer_iterator&
+    operator++()
+    {
+      m_block = m_block->next();
+      return *this;
+    }
+
+    const_buffer_iterator
+    operator++(int)
+    {
+      const_buffer_iterator copy(*this);
+      ++*this;
+      return copy;
+    }
+
+    bool
+    operator==(const const_buffer_iterator& other) const
+    {
+      return m_block == other.m_block;
+    }
+
+    bool
+    operator!=(const const_buffer_iterator& other) const
+    {
+      return m_block != other.m_block;
+    }
+
+  private:
+    const BlockN* m_block;
+  };
+
+  /** @brief Lightweight view of the blocks of a wire modeling ConstBufferSequence
+   *
+   *  It is cheap to copy, so asio asynchronous operations should be given this view
+   *  rather than the wire.  The wire must stay unchanged until the operation completes.
+   */
+  class ConstBuffers
+  {
+  public:
+    typedef boost::asio::const_buffer value_type;
+    typedef const_buffer_iterator const_iterator;
+
+    explicit
+    ConstBuffers(const BlockN* first)
+      : m_first(first)
+    {
+    }
+
+    const_iterator
+    begin() const
+    {
+      return const_iterator(m_first);
+    }
+
+    const_iterator
+    end() const
+    {
+      return const_iterator();
+    }
+
+    /** @brief Return the number of buffers in the sequence
+     */
+    size_t
+    count() const;
+
+  private:
+    const BlockN* m_first;
+  };
+
+  typedef boost::asio::const_buffer value_type;
+  typedef const_buffer_iterator const_iterator;
+
+  /** @brief Return an iterator to the first buffer, so that the wire models ConstBufferSequence
+   *
+   *  Each block yields one buffer over its used bytes, nothing is copied or allocated.
+   */
+  const_iterator
+  begin() const;
+
+  const_iterator
+  end() const;
+
+  /** @brief Return a view of this wire for gathering writes
+   */
+  ConstBuffers
+  buffers() const;
+
 public: //subwires
   /** @brief Parse this wire into subwires
    *
@@ -247,6 +542,58 @@ public: //subwires
   size_t
   elements_size() const;
 
+private:
+  /** @brief Link copies of the blocks of @p other into this wire, which has no blocks
+   */
+  void
+  copyBlocks(const Wire& other);
+
+  /** @brief Delete all blocks, leaving the wire without blocks
+   */
+  void
+  deleteBlocks() noexcept;
+
+  /** @brief Finalize the wire and cut the spare capacity of the current block off
+   *  Return the spare capacity as an unlinked empty block, or NULL if it is too small to keep
+   */
+  BlockN*
+  detachSpare();
+
+  /** @brief Link a reference to the used bytes of @p block after the last block
+   *  Return the size of @p block
+   */
+  size_t
+  linkReference(const BlockN& block);
+
+  /** @brief Link @p spare returned by detachSpare() after the last block and continue there
+   */
+  void
+  attachSpare(BlockN* spare);
+
+  /** @brief Split the block containing @p position so that a block starts there
+   *  Return that block, or NULL if @p position is not within the wire
+   */
+  BlockN*
+  splitAt(size_t position);
+
+  /** @brief Replace blocks [@p first, @p end) following @p previous by one block on @p buffer,
+   *         or unlink them if @p buffer is NULL
+   *  Return the replacement, or @p previous if the blocks were unlinked
+   */
+  BlockN*
+  replaceRun(BlockN* previous, BlockN* first, BlockN* end, const ConstBufferPtr& buffer);
+
+  /** @brief Read the cached hash() into @p value
+   *  @return whether it is cached
+   */
+  bool
+  getCachedHash(uint64_t& value) const;
+
+  /** @brief Drop the hash() and getSha256Digest() caches after a write
+   */
+  void
+  resetCaches();
+
 private:
   size_t m_position;               //absolute offset in this wire
   size_t m_capacity;               //total maximum byte size of this wire
@@ -257,10 +604,28 @@ private:
   io_container m_iovec;            //buffer sequence
   size_t m_count;                  //reference time(not decided yet) 
   uint32_t m_type;                 //type of this wire
+  size_t m_autoCompactThreshold;   //slack that triggers compact() in finalize(), 0 to disable
+  mutable bool m_hasHash;          //m_hash is valid, accessed atomically
+  mutable uint64_t m_hash;         //cached hash(), reset by writes, accessed atomically
+  mutable ConstBufferPtr m_sha256Digest; //cached getSha256Digest(), via std::atomic_load/store
   mutable element_container m_subWires;
 
 };
 }        
 
+namespace std {
+
+template<>
+struct hash<ndn::Wire>
+{
+  size_t
+  operator()(const ndn::Wire& wire) const
+  {
+    return static_cast<size_t>(wire.hash());
+  }
+};
+
+} // namespace std
+
 #endif // NDN_ENCODING_WIRE_TEST_HPP
 
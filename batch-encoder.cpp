@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "batch-encoder.hpp"
+
+#include <cerrno>
+
+namespace ndn {
+namespace encoding {
+
+BatchEncoder::BatchEncoder(size_t segmentSize)
+  : m_segmentCapacity(segmentSize)
+  , m_segmentSize(0)
+  , m_packetBegin(0)
+  , m_isInPacket(false)
+{
+}
+
+void
+BatchEncoder::beginPacket()
+{
+  if (m_isInPacket)
+    BOOST_THROW_EXCEPTION(Error("The previous packet is not finished"));
+
+  m_packetBegin = m_segmentSize;
+  m_isInPacket = true;
+}
+
+size_t
+BatchEncoder::endPacket()
+{
+  if (!m_isInPacket)
+    BOOST_THROW_EXCEPTION(Error("No packet is started"));
+  m_isInPacket = false;
+
+  size_t length = m_segmentSize - m_packetBegin;
+  if (length > 0) {
+    const shared_ptr<Buffer>& segment = m_segments.back();
+    m_packets.push_back(BlockN(segment, segment->begin() + m_packetBegin,
+                               segment->begin() + m_segmentSize));
+  }
+  return length;
+}
+
+uint8_t*
+BatchEncoder::prepare(size_t length)
+{
+  if (!m_isInPacket)
+    BOOST_THROW_EXCEPTION(Error("No packet is started"));
+
+  if (m_segments.empty() || m_segmentSize + length > m_segments.back()->size()) {
+    // move the packet so far to a new segment, packets are never split
+    size_t packetSize = m_segmentSize - m_packetBegin;
+    shared_ptr<Buffer> segment = make_shared<Buffer>(std::max(m_segmentCapacity, packetSize + length),
+                                                     Buffer::UninitializedTag());
+    if (packetSize > 0) {
+      std::memcpy(segment->data(), m_segments.back()->data() + m_packetBegin, packetSize);
+    }
+    if (!m_segments.empty() && m_packetBegin == 0) {
+      // the last segment holds only this packet
+      m_segments.back() = segment;
+    }
+    else {
+      m_segments.push_back(segment);
+    }
+    m_packetBegin = 0;
+    m_segmentSize = packetSize;
+  }
+  return m_segments.back()->data() + m_segmentSize;
+}
+
+const std::vector<iovec>&
+BatchEncoder::getIovec()
+{
+  m_iov.resize(m_packets.size());
+  for (size_t i = 0; i < m_packets.size(); ++i) {
+    m_iov[i].iov_base = const_cast<uint8_t*>(m_packets[i].begin());
+    m_iov[i].iov_len = m_packets[i].size();
+  }
+  return m_iov;
+}
+
+#ifdef __linux__
+std::vector<mmsghdr>&
+BatchEncoder::getMessages()
+{
+  getIovec();
+  m_messages.resize(m_iov.size());
+  for (size_t i = 0; i < m_iov.size(); ++i) {
+    std::memset(&m_messages[i], 0, sizeof(m_messages[i]));
+    m_messages[i].msg_hdr.msg_iov = &m_iov[i];
+    m_messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  return m_messages;
+}
+
+size_t
+BatchEncoder::send(int fd)
+{
+  std::vector<mmsghdr>& messages = getMessages();
+  size_t nSent = 0;
+  while (nSent < messages.size()) {
+    int n = ::sendmmsg(fd, messages.data() + nSent, messages.size() - nSent, 0);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (nSent > 0)
+        break;
+      BOOST_THROW_EXCEPTION(Error("sendmmsg failed: " + std::string(std::strerror(errno))));
+    }
+    nSent += n;
+  }
+  return nSent;
+}
+#endif // __linux__
+
+void
+BatchEncoder::clear()
+{
+  m_packets.clear();
+  m_iov.clear();
+#ifdef __linux__
+  m_messages.clear();
+#endif // __linux__
+  m_segments.clear();
+  m_segmentSize = 0;
+  m_packetBegin = 0;
+  m_isInPacket = false;
+}
+
+} // namespace encoding
+} // namespace ndn
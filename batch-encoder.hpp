@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_BATCH_ENCODER_HPP
+#define NDN_ENCODING_BATCH_ENCODER_HPP
+
+#include "byte-sink.hpp"
+#include "segment-pool.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace ndn {
+namespace encoding {
+
+/**
+ * @brief Encoder of many packets back-to-back into one arena of pooled segments
+ *
+ * Each packet is written between beginPacket() and endPacket() through the ByteSink
+ * interface, and always lies contiguously in one segment.  A packet that does not fit the
+ * rest of the current segment is moved to a new one.  Every packet is available as a BlockN
+ * sharing the segment, and the whole batch as an iovec array, or as a mmsghdr array for a
+ * single sendmmsg on a connected socket.
+ *
+ * The arena is released as a unit by clear(), once the batch is sent and no packet view
+ * is kept elsewhere.
+ *
+ * Usage example:
+ * @code
+ *      BatchEncoder batch;
+ *      for (const Name& name : names) {
+ *        batch.beginPacket();
+ *        ... // batch.appendVarNumber(), batch.append()
+ *        batch.endPacket();
+ *      }
+ *      batch.send(fd);
+ *      batch.clear();
+ * @endcode
+ */
+class BatchEncoder : public ByteSink<BatchEncoder>, noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * @brief Create a batch encoder allocating arena segments of @p segmentSize bytes
+   *
+   * The default is the largest pooled segment, which holds any packet up to
+   * MAX_NDN_PACKET_SIZE.
+   */
+  explicit
+  BatchEncoder(size_t segmentSize = SegmentPool::MAX_POOLED_SIZE);
+
+  /**
+   * @brief Start encoding a new packet
+   */
+  void
+  beginPacket();
+
+  /**
+   * @brief Finish the packet started by beginPacket()
+   * @return size of the packet
+   */
+  size_t
+  endPacket();
+
+  /**
+   * @brief Return @p length contiguous writable bytes after the current packet
+   */
+  uint8_t*
+  prepare(size_t length);
+
+  /**
+   * @brief Add @p length bytes written through prepare() to the current packet
+   */
+  void
+  commit(size_t length)
+  {
+    m_segmentSize += length;
+  }
+
+  /**
+   * @brief Return the number of finished packets
+   */
+  size_t
+  size() const
+  {
+    return m_packets.size();
+  }
+
+  /**
+   * @brief Return the finished packets, each sharing its arena segment
+   */
+  const std::vector<BlockN>&
+  getPackets() const
+  {
+    return m_packets;
+  }
+
+  /**
+   * @brief Return the number of arena segments
+   */
+  size_t
+  getSegmentCount() const
+  {
+    return m_segments.size();
+  }
+
+  /**
+   * @brief Return one iovec per finished packet
+   */
+  const std::vector<iovec>&
+  getIovec();
+
+#ifdef __linux__
+  /**
+   * @brief Return one mmsghdr per finished packet, without destination addresses
+   */
+  std::vector<mmsghdr>&
+  getMessages();
+
+  /**
+   * @brief Send all finished packets on connected datagram socket @p fd with sendmmsg
+   *
+   * sendmmsg is called again until every packet is sent or an error occurs.
+   * @return number of packets sent
+   * @throw Error sendmmsg failed before any packet was sent
+   */
+  size_t
+  send(int fd);
+#endif // __linux__
+
+  /**
+   * @brief Drop all packets and release the arena
+   */
+  void
+  clear();
+
+private:
+  size_t m_segmentCapacity;
+  std::vector<shared_ptr<Buffer>> m_segments;
+  size_t m_segmentSize;   ///< bytes used in the last segment
+  size_t m_packetBegin;   ///< offset of the current packet in the last segment
+  bool m_isInPacket;
+
+  std::vector<BlockN> m_packets;
+  std::vector<iovec> m_iov;
+#ifdef __linux__
+  std::vector<mmsghdr> m_messages;
+#endif // __linux__
+};
+
+} // namespace encoding
+} // namespace ndn
+
+#endif // NDN_ENCODING_BATCH_ENCODER_HPP
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/batch-encoder.hpp"
+
+#include "boost-test.hpp"
+
+#include <sys/socket.h>
+
+namespace ndn {
+namespace tests {
+
+using encoding::BatchEncoder;
+
+BOOST_AUTO_TEST_SUITE(EncodingBatchEncoder)
+
+static void
+encodeInterest(BatchEncoder& batch, uint8_t number, size_t nameSize)
+{
+  std::vector<uint8_t> name(nameSize, number);
+  batch.beginPacket();
+  batch.appendVarNumber(tlv::Interest);
+  batch.appendVarNumber(2 + name.size());
+  batch.appendVarNumber(tlv::Name);
+  batch.appendVarNumber(name.size());
+  batch.append(name.data(), name.size());
+  batch.endPacket();
+}
+
+BOOST_AUTO_TEST_CASE(BackToBack)
+{
+  BatchEncoder batch(1024);
+  for (int i = 0; i < 100; ++i) {
+    encodeInterest(batch, static_cast<uint8_t>(i), 60);
+  }
+  BOOST_CHECK_EQUAL(batch.size(), 100);
+  // 16 packets of 64 bytes fit in one segment
+  BOOST_CHECK_EQUAL(batch.getSegmentCount(), 7);
+
+  const std::vector<BlockN>& packets = batch.getPackets();
+  for (size_t i = 0; i < packets.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(packets[i].size(), 64);
+    BOOST_CHECK_EQUAL(packets[i].begin()[0], tlv::Interest);
+    BOOST_CHECK_EQUAL(packets[i].begin()[63], i);
+  }
+  BOOST_CHECK(packets[1].begin() == packets[0].end());
+  BOOST_CHECK(packets[15].getBuffer() == packets[0].getBuffer());
+  BOOST_CHECK(packets[16].getBuffer() != packets[15].getBuffer());
+
+  const std::vector<iovec>& iov = batch.getIovec();
+  BOOST_REQUIRE_EQUAL(iov.size(), 100);
+  BOOST_CHECK_EQUAL(iov[42].iov_base, packets[42].begin());
+  BOOST_CHECK_EQUAL(iov[42].iov_len, 64);
+
+  batch.clear();
+  BOOST_CHECK_EQUAL(batch.size(), 0);
+  BOOST_CHECK_EQUAL(batch.getSegmentCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(LargerThanSegment)
+{
+  BatchEncoder batch(128);
+  encodeInterest(batch, 1, 60);
+  encodeInterest(batch, 2, 300);
+  encodeInterest(batch, 3, 10);
+  BOOST_REQUIRE_EQUAL(batch.size(), 3);
+  BOOST_CHECK_EQUAL(batch.getPackets()[1].size(), 308);
+  BOOST_CHECK_EQUAL(batch.getPackets()[1].begin()[307], 2);
+  BOOST_CHECK_EQUAL(batch.getPackets()[2].begin()[13], 3);
+}
+
+BOOST_AUTO_TEST_CASE(PacketOutlivesArena)
+{
+  BatchEncoder batch;
+  encodeInterest(batch, 7, 20);
+  BlockN packet = batch.getPackets()[0];
+  batch.clear();
+  BOOST_CHECK_EQUAL(packet.size(), 24);
+  BOOST_CHECK_EQUAL(packet.begin()[23], 7);
+}
+
+BOOST_AUTO_TEST_CASE(SendMmsg)
+{
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+  BatchEncoder batch;
+  for (int i = 0; i < 8; ++i) {
+    encodeInterest(batch, static_cast<uint8_t>(i), 10 + i);
+  }
+  BOOST_CHECK_EQUAL(batch.getMessages().size(), 8);
+  BOOST_CHECK_EQUAL(batch.send(fds[0]), 8);
+
+  for (int i = 0; i < 8; ++i) {
+    uint8_t packet[64];
+    BOOST_CHECK_EQUAL(::recv(fds[1], packet, sizeof(packet), 0), 14 + i);
+    BOOST_CHECK_EQUAL(packet[13 + i], i);
+  }
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/block_test.hpp"
+
+#include "boost-test.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingBlockN)
+
+/** @brief Check whether the bytes of @p block are stored in the BlockN object itself
+ */
+static bool
+isInsideBlock(const BlockN& block)
+{
+  const uint8_t* object = reinterpret_cast<const uint8_t*>(&block);
+  return block.begin() >= object && block.end() <= object + sizeof(BlockN);
+}
+
+BOOST_AUTO_TEST_CASE(InlineFromArray)
+{
+  static const uint8_t bytes[] = {0x07, 0x06, 0x08, 0x04, 0x74, 0x65, 0x73, 0x74};
+  BlockN block(bytes, sizeof(bytes));
+  BOOST_CHECK(block.isInline());
+  BOOST_CHECK(block.hasBuffer());
+  BOOST_CHECK(!block.isBufferShared());
+  BOOST_CHECK(isInsideBlock(block));
+  BOOST_CHECK_EQUAL(block.size(), sizeof(bytes));
+  BOOST_CHECK_EQUAL(block.capacity(), sizeof(bytes));
+  BOOST_CHECK_EQUAL_COLLECTIONS(block.begin(), block.end(), bytes, bytes + sizeof(bytes));
+
+  uint8_t large[BlockN::INLINE_CAPACITY + 1] = {};
+  BlockN largeBlock(large, sizeof(large));
+  BOOST_CHECK(!largeBlock.isInline());
+  BOOST_CHECK(!isInsideBlock(largeBlock));
+
+  BlockN boundary(large, BlockN::INLINE_CAPACITY);
+  BOOST_CHECK(boundary.isInline());
+}
+
+BOOST_AUTO_TEST_CASE(InlineWithCapacity)
+{
+  BlockN block(BlockN::INLINE_CAPACITY);
+  BOOST_CHECK(block.isInline());
+  BOOST_CHECK(isInsideBlock(block));
+  BOOST_CHECK_EQUAL(block.capacity(), BlockN::INLINE_CAPACITY);
+
+  BlockN largeBlock(BlockN::INLINE_CAPACITY + 1);
+  BOOST_CHECK(!largeBlock.isInline());
+  BOOST_CHECK_EQUAL(largeBlock.capacity(), BlockN::INLINE_CAPACITY + 1);
+}
+
+BOOST_AUTO_TEST_CASE(GetBufferOfInline)
+{
+  static const uint8_t bytes[] = {0x15, 0x03, 0x61, 0x62, 0x63};
+  const BlockN block(bytes, sizeof(bytes));
+  BOOST_REQUIRE(block.isInline());
+
+  // the bytes are copied into a new buffer, the block is left as it is
+  shared_ptr<const Buffer> buffer = block.getBuffer();
+  BOOST_CHECK(block.isInline());
+  BOOST_CHECK(isInsideBlock(block));
+  BOOST_CHECK(!block.isBufferShared());
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), bytes, bytes + sizeof(bytes));
+  BOOST_CHECK(block.getBuffer() != buffer);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentGetBuffer)
+{
+  static const uint8_t bytes[] = {0x15, 0x03, 0x61, 0x62, 0x63};
+  const BlockN block(bytes, sizeof(bytes));
+
+  // Boost.Test assertions are not thread-safe, so the threads only count mismatches
+  std::atomic<size_t> nMismatches(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&block, &nMismatches] {
+      for (int j = 0; j < 1000; ++j) {
+        shared_ptr<const Buffer> buffer = block.getBuffer();
+        if (!std::equal(buffer->begin(), buffer->end(), bytes) || buffer->size() != sizeof(bytes))
+          ++nMismatches;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK_EQUAL(nMismatches, 0);
+  BOOST_CHECK(block.isInline());
+}
+
+BOOST_AUTO_TEST_CASE(SubBlockOfInline)
+{
+  static const uint8_t bytes[] = {0x07, 0x06, 0x08, 0x04, 0x74, 0x65, 0x73, 0x74};
+  BlockN block(bytes, sizeof(bytes));
+  BOOST_REQUIRE(block.isInline());
+
+  BlockN sub(block, block.begin() + 2, block.end());
+  BOOST_CHECK(sub.isInline());
+  BOOST_CHECK(isInsideBlock(sub));
+  BOOST_CHECK_EQUAL(sub.size(), sizeof(bytes) - 2);
+  BOOST_CHECK_EQUAL(sub.offset(), 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(sub.begin(), sub.end(), bytes + 2, bytes + sizeof(bytes));
+
+  // the sub-block owns a copy, so it outlives the source
+  BlockN* source = new BlockN(bytes, sizeof(bytes));
+  BlockN copy(*source, source->begin() + 4, source->begin() + 6);
+  delete source;
+  BOOST_CHECK_EQUAL(copy.size(), 2);
+  BOOST_CHECK_EQUAL(copy.begin()[0], 0x74);
+  BOOST_CHECK_EQUAL(copy.begin()[1], 0x65);
+}
+
+BOOST_AUTO_TEST_CASE(SubBlockOfBuffer)
+{
+  shared_ptr<Buffer> buffer = make_shared<Buffer>(100);
+  for (size_t i = 0; i < buffer->size(); ++i) {
+    (*buffer)[i] = static_cast<uint8_t>(i);
+  }
+  BlockN block(buffer);
+  BlockN sub(block, block.begin() + 10, block.begin() + 20);
+  BOOST_CHECK(!sub.isInline());
+  BOOST_CHECK(sub.isBufferShared());
+  BOOST_CHECK_EQUAL(sub.begin(), buffer->data() + 10);
+  BOOST_CHECK_EQUAL(sub.size(), 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // EncodingBlockN
+
+} // namespace tests
+} // namespace ndn
@@ -50,7 +50,7 @@ public:
   std::streamsize
   write(const char_type* s, std::streamsize n)
   {
-    std::copy(s, s+n, std::back_inserter(m_container));
+    m_container.insert(m_container.end(), s, s + n);
     return n;
   }
 
@@ -40,13 +40,31 @@ Buffer::Buffer()
 }
 
 Buffer::Buffer(size_t size)
-  : std::vector<uint8_t>(size, 0)
+  : Base(size, 0)
 {
 }
 
+Buffer::Buffer(size_t size, UninitializedTag)
+  : Base(allocator_type(allocator_type::DefaultInitTag()))
+{
+  resize(size);
+}
+
 Buffer::Buffer(const void* buf, size_t length)
-  : std::vector<uint8_t>(reinterpret_cast<const uint8_t*>(buf),
-                         reinterpret_cast<const uint8_t*>(buf) + length)
+  : Base(reinterpret_cast<const uint8_t*>(buf),
+         reinterpret_cast<const uint8_t*>(buf) + length)
+{
+}
+
+Buffer::Buffer(size_t size, const allocator_type& allocator)
+  : Base(allocator)
+{
+  reserve(size);
+  resize(size);
+}
+
+ExternalBuffer::ExternalBuffer(const uint8_t* memory, size_t size, const ReleaseCallback& release)
+  : Buffer(size, allocator_type(make_shared<AdoptedMemory>(memory, size, release)))
 {
 }
 
@@ -25,6 +25,7 @@
 #define NDN_ENCODING_BUFFER_HPP
 
 #include "../common.hpp"
+#include "segment-pool.hpp"
 
 #include <vector>
 
@@ -40,9 +41,20 @@ typedef shared_ptr<Buffer> BufferPtr;
  * In most respect, Buffer class is equivalent to std::vector<uint8_t> and is in fact
  * uses it as a base class.  In addition to that, it provides buf() and buf<T>() helper
  * method for easier access to the underlying data (buf<T>() casts pointer to the requested class)
+ *
+ * The bytes are obtained from SegmentPool through SegmentAllocator.
  */
-class Buffer : public std::vector<uint8_t>
+class Buffer : public std::vector<uint8_t, SegmentAllocator<uint8_t>>
 {
+public:
+  typedef std::vector<uint8_t, SegmentAllocator<uint8_t>> Base;
+
+  /** @brief Tag selecting the constructor that leaves the bytes uninitialized
+   */
+  struct UninitializedTag
+  {
+  };
+
 public:
   /** @brief Creates an empty buffer
    */
@@ -50,10 +62,20 @@ public:
 
   /** @brief Creates a buffer with pre-allocated size
    *  @param size size of the buffer to be allocated
+   *
+   *  The bytes are zero-filled.
    */
   explicit
   Buffer(size_t size);
 
+  /** @brief Creates a buffer with pre-allocated size without initializing the bytes
+   *  @param size size of the buffer to be allocated
+   *
+   *  Use it when every byte will be written before it is read, e.g. for encoding segments.
+   *  Growing the buffer with resize() does not initialize the new bytes either.
+   */
+  Buffer(size_t size, UninitializedTag);
+
   /** @brief Create a buffer by copying contents from a buffer
    *  @param buf const pointer to buffer
    *  @param length length of the buffer to copy
@@ -67,7 +89,7 @@ public:
    */
   template <class InputIterator>
   Buffer(InputIterator first, InputIterator last)
-    : std::vector<uint8_t>(first, last)
+    : Base(first, last)
   {
   }
 
@@ -126,6 +148,33 @@ public:
   {
     return reinterpret_cast<const T*>(&front());
   }
+
+protected:
+  /** @brief Creates a buffer of @p size uninitialized bytes obtained from @p allocator
+   */
+  Buffer(size_t size, const allocator_type& allocator);
+};
+
+/**
+ * @brief Buffer wrapping memory owned outside the library, without copying it
+ *
+ * The memory (a receive ring slot, an mmap'd region, a shared-memory slab) must stay valid
+ * until @p release is invoked, which happens once, when the buffer is destroyed.  Since it is a
+ * Buffer, an ExternalBuffer can be passed wherever ConstBufferPtr is accepted, e.g. to BlockN
+ * and Wire.  The memory must not be written through the buffer unless it is writable, and
+ * growing the buffer moves its contents into pooled memory and releases the external memory.
+ *
+ * Create it with make_shared, as Buffer has no virtual destructor.
+ */
+class ExternalBuffer : public Buffer
+{
+public:
+  typedef AdoptedMemory::ReleaseCallback ReleaseCallback;
+
+  /** @brief Wrap @p size bytes at @p memory
+   *  @param release invoked when the memory is no longer referenced, may be empty
+   */
+  ExternalBuffer(const uint8_t* memory, size_t size, const ReleaseCallback& release);
 };
 
 } // namespace ndn
@@ -0,0 +1,323 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_BYTE_SINK_HPP
+#define NDN_ENCODING_BYTE_SINK_HPP
+
+#include "buffer.hpp"
+#include "endian.hpp"
+#include "tlv_test.hpp"
+#include "wire_test.hpp"
+
+#include <cstring>
+
+namespace ndn {
+
+/**
+ * @brief Base of the byte sinks used to serialize TLV without iostreams
+ *
+ * A sink provides contiguous space through `uint8_t* prepare(size_t n)` and accepts the
+ * written bytes through `void commit(size_t n)`.  Everything else is built on these two
+ * calls and resolved at compile time, so an append is a bound check and a memcpy.
+ *
+ * Usage example:
+ * @code
+ *      BufferSink sink;
+ *      sink.appendVarNumber(tlv::Name);
+ *      sink.appendVarNumber(value.size());
+ *      sink.append(value.data(), value.size());
+ *      shared_ptr<Buffer> buf = sink.buf();
+ * @endcode
+ */
+template<class Derived>
+class ByteSink
+{
+public:
+  /**
+   * @brief Append @p length bytes of @p array
+   * @return number of bytes appended
+   */
+  size_t
+  append(const uint8_t* array, size_t length)
+  {
+    // an empty Buffer may hand out null data, which memcpy must not be given
+    if (length == 0)
+      return 0;
+
+    std::memcpy(derived().prepare(length), array, length);
+    derived().commit(length);
+    return length;
+  }
+
+  /**
+   * @brief Append a single byte
+   */
+  size_t
+  appendByte(uint8_t value)
+  {
+    *derived().prepare(1) = value;
+    derived().commit(1);
+    return 1;
+  }
+
+  /**
+   * @brief Append VAR-NUMBER in NDN-TLV encoding
+   * @return number of bytes appended
+   */
+  size_t
+  appendVarNumber(uint64_t varNumber)
+  {
+    size_t length = tlv::sizeOfVarNumber(varNumber);
+    tlv::writeVarNumber(derived().prepare(length), varNumber);
+    derived().commit(length);
+    return length;
+  }
+
+  /**
+   * @brief Append nonNegativeInteger in NDN-TLV encoding
+   * @return number of bytes appended
+   */
+  size_t
+  appendNonNegativeInteger(uint64_t value)
+  {
+    size_t length = tlv::sizeOfNonNegativeInteger(value);
+    tlv::writeNonNegativeInteger(derived().prepare(length), value);
+    derived().commit(length);
+    return length;
+  }
+
+  /**
+   * @brief Append TLV-TYPE @p TYPE and TLV-LENGTH @p length
+   *
+   * The octets of @p TYPE are computed at compile time.  When both the type and the length
+   * are below 253, the header is written with a single 16-bit store.
+   * @return number of bytes appended
+   */
+  template<uint32_t TYPE>
+  size_t
+  appendTlvHeader(uint64_t length)
+  {
+    static_assert(TYPE > 0, "TLV-TYPE 0 is reserved");
+    constexpr size_t typeSize = tlv::sizeOfVarNumber(TYPE);
+
+    if (typeSize == 1 && length < 253) {
+      uint16_t header = htobe16(static_cast<uint16_t>(TYPE << 8 | length));
+      std::memcpy(derived().prepare(2), &header, 2);
+      derived().commit(2);
+      return 2;
+    }
+
+    size_t size = typeSize + tlv::sizeOfVarNumber(length);
+    uint8_t* pos = derived().prepare(size);
+    if (typeSize == 1) {
+      *pos = static_cast<uint8_t>(TYPE);
+    }
+    else if (typeSize == 3) {
+      pos[0] = 253;
+      pos[1] = static_cast<uint8_t>(TYPE >> 8);
+      pos[2] = static_cast<uint8_t>(TYPE);
+    }
+    else {
+      pos[0] = 254;
+      pos[1] = static_cast<uint8_t>(TYPE >> 24);
+      pos[2] = static_cast<uint8_t>(TYPE >> 16);
+      pos[3] = static_cast<uint8_t>(TYPE >> 8);
+      pos[4] = static_cast<uint8_t>(TYPE);
+    }
+    tlv::writeVarNumber(pos + typeSize, length);
+    derived().commit(size);
+    return size;
+  }
+
+private:
+  Derived&
+  derived()
+  {
+    return static_cast<Derived&>(*this);
+  }
+};
+
+/**
+ * @brief Byte sink writing into a caller-provided contiguous span
+ *
+ * The caller must make sure the span is large enough; this is only checked in debug builds.
+ */
+class SpanSink : public ByteSink<SpanSink>
+{
+public:
+  SpanSink(uint8_t* begin, uint8_t* end)
+    : m_begin(begin)
+    , m_pos(begin)
+    , m_end(end)
+  {
+  }
+
+  uint8_t*
+  prepare(size_t length)
+  {
+    BOOST_ASSERT(m_pos + length <= m_end);
+    return m_pos;
+  }
+
+  void
+  commit(size_t length)
+  {
+    m_pos += length;
+  }
+
+  /**
+   * @brief Return number of bytes written so far
+   */
+  size_t
+  size() const
+  {
+    return m_pos - m_begin;
+  }
+
+private:
+  uint8_t* m_begin;
+  uint8_t* m_pos;
+  uint8_t* m_end;
+};
+
+/**
+ * @brief Byte sink appending to a growing Buffer, the replacement of OBufferStream
+ *
+ * Space is grown geometrically and is not initialized before it is written.
+ */
+class BufferSink : public ByteSink<BufferSink>
+{
+public:
+  BufferSink()
+    : m_buffer(make_shared<Buffer>(0, Buffer::UninitializedTag()))
+    , m_size(0)
+  {
+  }
+
+  /**
+   * @brief Make room for at least @p length more bytes
+   */
+  void
+  reserve(size_t length)
+  {
+    if (m_buffer->size() < m_size + length) {
+      m_buffer->resize(std::max(m_size + length, 2 * m_buffer->size()));
+    }
+  }
+
+  uint8_t*
+  prepare(size_t length)
+  {
+    reserve(length);
+    return m_buffer->data() + m_size;
+  }
+
+  void
+  commit(size_t length)
+  {
+    m_size += length;
+  }
+
+  /**
+   * @brief Return number of bytes written so far
+   */
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+  /**
+   * @brief Return the underlying buffer, trimmed to the written bytes
+   *
+   * The buffer keeps the allocator of Buffer(size_t, Buffer::UninitializedTag), so growing it
+   * later with resize(n) leaves the new bytes indeterminate; use resize(n, 0) to zero-fill them.
+   */
+  shared_ptr<Buffer>
+  buf()
+  {
+    m_buffer->resize(m_size);
+    return m_buffer;
+  }
+
+private:
+  BufferPtr m_buffer;
+  size_t m_size;
+};
+
+/**
+ * @brief Byte sink appending to a Wire at its current position
+ *
+ * prepare() keeps a field contiguous by starting a new segment when the current one is short.
+ * When the position was moved back into a block that is not the last one, no segment can be
+ * inserted there, so a short field is staged in the sink and spread over the following
+ * blocks on commit(), like Wire::writeUint8() does.
+ */
+class WireSink : public ByteSink<WireSink>
+{
+public:
+  explicit
+  WireSink(Wire& wire)
+    : m_wire(wire)
+    , m_isSpilled(false)
+  {
+  }
+
+  uint8_t*
+  prepare(size_t length)
+  {
+    uint8_t* dest = m_wire.tryPrepare(length);
+    m_isSpilled = dest == NULL && length <= sizeof(m_spill);
+    if (m_isSpilled)
+      return m_spill;
+
+    return dest != NULL ? dest : m_wire.prepare(length);
+  }
+
+  void
+  commit(size_t length)
+  {
+    if (m_isSpilled) {
+      m_isSpilled = false;
+      m_wire.appendArray(m_spill, length);
+      return;
+    }
+    m_wire.commit(length);
+  }
+
+  /**
+   * @brief Append @p length bytes of @p array, spreading them over segments as needed
+   */
+  size_t
+  append(const uint8_t* array, size_t length)
+  {
+    return m_wire.appendArray(array, length);
+  }
+
+private:
+  Wire& m_wire;
+  bool m_isSpilled;
+  uint8_t m_spill[18]; ///< staging for a field of up to a TLV-TYPE and a TLV-LENGTH
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_BYTE_SINK_HPP
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/byte-sink.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <algorithm>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingByteSink)
+
+BOOST_AUTO_TEST_CASE(WriteToPointer)
+{
+  uint8_t buf[9];
+  BOOST_CHECK_EQUAL(tlv::writeVarNumber(buf, 252) - buf, 1);
+  BOOST_CHECK_EQUAL(buf[0], 252);
+  BOOST_CHECK_EQUAL(tlv::writeVarNumber(buf, 253) - buf, 3);
+  BOOST_CHECK_EQUAL(buf[0], 253);
+  BOOST_CHECK_EQUAL(buf[1], 0x00);
+  BOOST_CHECK_EQUAL(buf[2], 0xFD);
+  BOOST_CHECK_EQUAL(tlv::writeVarNumber(buf, 65536) - buf, 5);
+  BOOST_CHECK_EQUAL(buf[0], 254);
+  BOOST_CHECK_EQUAL(buf[2], 0x01);
+  BOOST_CHECK_EQUAL(tlv::writeVarNumber(buf, 4294967296LL) - buf, 9);
+  BOOST_CHECK_EQUAL(buf[0], 255);
+  BOOST_CHECK_EQUAL(buf[4], 0x01);
+
+  BOOST_CHECK_EQUAL(tlv::writeNonNegativeInteger(buf, 1) - buf, 1);
+  BOOST_CHECK_EQUAL(tlv::writeNonNegativeInteger(buf, 0x1234) - buf, 2);
+  BOOST_CHECK_EQUAL(buf[0], 0x12);
+  BOOST_CHECK_EQUAL(buf[1], 0x34);
+  BOOST_CHECK_EQUAL(tlv::writeNonNegativeInteger(buf, 0x12345678) - buf, 4);
+  BOOST_CHECK_EQUAL(buf[3], 0x78);
+  BOOST_CHECK_EQUAL(tlv::writeNonNegativeInteger(buf, 0x123456789ALL) - buf, 8);
+  BOOST_CHECK_EQUAL(buf[7], 0x9A);
+}
+
+BOOST_AUTO_TEST_CASE(Sizes)
+{
+  static_assert(tlv::sizeOfVarNumber(tlv::Name) == 1, "");
+  static_assert(tlv::sizeOfVarNumber(tlv::AppPrivateBlock2) == 3, "");
+
+  const uint64_t values[] = {0, 1, 252, 253, 255, 256, 65535, 65536,
+                             4294967295ULL, 4294967296ULL, 18446744073709551615ULL};
+  const size_t varNumberSizes[] = {1, 1, 1, 3, 3, 3, 3, 5, 5, 9, 9};
+  const size_t nonNegativeIntegerSizes[] = {1, 1, 1, 2, 2, 2, 2, 4, 4, 8, 8};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+    BOOST_CHECK_EQUAL(tlv::sizeOfVarNumber(values[i]), varNumberSizes[i]);
+    BOOST_CHECK_EQUAL(tlv::sizeOfNonNegativeInteger(values[i]), nonNegativeIntegerSizes[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TlvHeader)
+{
+  uint8_t buf[16];
+  SpanSink sink(buf, buf + sizeof(buf));
+  BOOST_CHECK_EQUAL(sink.appendTlvHeader<tlv::Name>(5), 2);
+  BOOST_CHECK_EQUAL(sink.appendTlvHeader<tlv::Content>(300), 4);
+  BOOST_CHECK_EQUAL(sink.appendTlvHeader<tlv::AppPrivateBlock2>(1), 4);
+  BOOST_CHECK_EQUAL(sink.appendTlvHeader<70000>(2), 6);
+
+  const uint8_t expected[] = {0x07, 0x05,
+                              0x15, 0xFD, 0x01, 0x2C,
+                              0xFD, 0x7F, 0xFF, 0x01,
+                              0xFE, 0x00, 0x01, 0x11, 0x70, 0x02};
+  BOOST_CHECK_EQUAL_COLLECTIONS(buf, buf + sink.size(), expected, expected + sizeof(expected));
+}
+
+BOOST_AUTO_TEST_CASE(Span)
+{
+  uint8_t buf[6];
+  SpanSink sink(buf, buf + sizeof(buf));
+  BOOST_CHECK_EQUAL(sink.appendVarNumber(8), 1);
+  BOOST_CHECK_EQUAL(sink.appendVarNumber(3), 1);
+  const uint8_t value[] = {'n', 'd', 'n'};
+  BOOST_CHECK_EQUAL(sink.append(value, sizeof(value)), 3);
+  BOOST_CHECK_EQUAL(sink.appendByte(0xFF), 1);
+  BOOST_CHECK_EQUAL(sink.size(), 6);
+
+  const uint8_t expected[] = {0x08, 0x03, 'n', 'd', 'n', 0xFF};
+  BOOST_CHECK_EQUAL_COLLECTIONS(buf, buf + sizeof(buf), expected, expected + sizeof(expected));
+}
+
+BOOST_AUTO_TEST_CASE(GrowingBuffer)
+{
+  BufferSink sink;
+  std::vector<uint8_t> expected;
+  for (size_t i = 0; i < 1000; ++i) {
+    sink.appendNonNegativeInteger(0x1234);
+    expected.push_back(0x12);
+    expected.push_back(0x34);
+  }
+  BOOST_CHECK_EQUAL(sink.size(), 2000);
+
+  shared_ptr<Buffer> buf = sink.buf();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buf->begin(), buf->end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(ResizeReturnedBuffer)
+{
+  BufferSink sink;
+  sink.appendNonNegativeInteger(0x1234);
+  shared_ptr<Buffer> buf = sink.buf();
+
+  // the buffer keeps the uninitialized allocation mode of the sink
+  BOOST_CHECK(buf->get_allocator().isDefaultInit());
+
+  // an explicit value zero-fills the grown bytes
+  buf->resize(64, 0);
+  BOOST_CHECK_EQUAL((*buf)[0], 0x12);
+  BOOST_CHECK_EQUAL((*buf)[1], 0x34);
+  BOOST_CHECK(std::all_of(buf->begin() + 2, buf->end(), [] (uint8_t b) { return b == 0; }));
+
+  // a copy value-initializes again
+  Buffer copy(*buf);
+  BOOST_CHECK(!copy.get_allocator().isDefaultInit());
+}
+
+BOOST_AUTO_TEST_CASE(EmptyAppend)
+{
+  Buffer empty;
+  BufferSink sink;
+  BOOST_CHECK_EQUAL(sink.append(empty.data(), empty.size()), 0);
+  BOOST_CHECK_EQUAL(sink.size(), 0);
+
+  uint8_t buf[1];
+  SpanSink span(buf, buf);
+  BOOST_CHECK_EQUAL(span.append(empty.data(), empty.size()), 0);
+
+  Wire wire(16);
+  WireSink wireSink(wire);
+  BOOST_CHECK_EQUAL(wireSink.append(empty.data(), empty.size()), 0);
+  BOOST_CHECK_EQUAL(wire.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(WirePrepareCommit)
+{
+  Wire wire(64);
+  uint8_t* dest = wire.prepare(4);
+  std::fill(dest, dest + 4, 0xAA);
+  BOOST_CHECK_EQUAL(wire.size(), 0);
+  wire.commit(4);
+  BOOST_CHECK_EQUAL(wire.position(), 4);
+  BOOST_CHECK_EQUAL(wire.size(), 4);
+  BOOST_CHECK_EQUAL(wire.readUint8(3), 0xAA);
+
+  // a field that does not fit in the segment starts a new one
+  BOOST_CHECK_EQUAL(wire.prepare(100) - wire.prepare(1), 0);
+  wire.commit(100);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 2);
+  BOOST_CHECK_EQUAL(wire.size(), 104);
+}
+
+BOOST_AUTO_TEST_CASE(WireAcrossSegments)
+{
+  Wire wire(10);
+  WireSink sink(wire);
+  const uint8_t header[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  BOOST_CHECK_EQUAL(sink.append(header, sizeof(header)), 8);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 1);
+
+  // the 9-byte VAR-NUMBER does not fit in the 2 bytes left, so it goes to a new segment whole
+  BOOST_CHECK_EQUAL(sink.appendVarNumber(4294967296LL), 9);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 2);
+  BOOST_CHECK_EQUAL(wire.size(), 17);
+  Wire::const_iterator second = ++wire.begin();
+  BOOST_CHECK_EQUAL((*second).size(), 9);
+  BOOST_CHECK_EQUAL(static_cast<const uint8_t*>((*second).data())[0], 255);
+
+  // arrays are spread over as many segments as needed
+  std::vector<uint8_t> value(5000);
+  for (size_t i = 0; i < value.size(); ++i) {
+    value[i] = static_cast<uint8_t>(i);
+  }
+  BOOST_CHECK_EQUAL(sink.appendTlvHeader<tlv::Content>(value.size()), 4);
+  BOOST_CHECK_EQUAL(sink.append(value.data(), value.size()), 5000);
+  BOOST_CHECK_GT(wire.countBlock(), 3);
+  BOOST_CHECK_EQUAL(wire.size(), 17 + 4 + 5000);
+
+  std::vector<uint8_t> expected(header, header + sizeof(header));
+  const uint8_t varNumber[] = {0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00};
+  expected.insert(expected.end(), varNumber, varNumber + sizeof(varNumber));
+  const uint8_t contentHeader[] = {0x15, 0xFD, 0x13, 0x88};
+  expected.insert(expected.end(), contentHeader, contentHeader + sizeof(contentHeader));
+  expected.insert(expected.end(), value.begin(), value.end());
+  shared_ptr<Buffer> buf = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buf->begin(), buf->end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(WireRewoundIntoInnerBlock)
+{
+  Wire wire(12);
+  WireSink sink(wire);
+  std::vector<uint8_t> zeros(40);
+  sink.append(zeros.data(), zeros.size());
+  BOOST_REQUIRE_GT(wire.countBlock(), 1);
+
+  // 2 bytes are left in the first block, which is not the last one
+  wire.setPositon(10);
+  BOOST_CHECK_THROW(wire.prepare(9), Wire::Error);
+  BOOST_CHECK(wire.tryPrepare(9) == nullptr);
+  BOOST_CHECK_EQUAL(sink.appendVarNumber(4294967296LL), 9);
+  BOOST_CHECK_EQUAL(wire.position(), 19);
+  BOOST_CHECK_EQUAL(sink.appendTlvHeader<tlv::Content>(1000), 4);
+  BOOST_CHECK_EQUAL(sink.appendNonNegativeInteger(0x1234), 2);
+  BOOST_CHECK_EQUAL(wire.position(), 25);
+  BOOST_CHECK_EQUAL(wire.size(), 40);
+
+  std::vector<uint8_t> expected(zeros);
+  const uint8_t fields[] = {0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+                            0x15, 0xFD, 0x03, 0xE8, 0x12, 0x34};
+  std::copy(fields, fields + sizeof(fields), expected.begin() + 10);
+  shared_ptr<Buffer> buf = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buf->begin(), buf->end(), expected.begin(), expected.end());
+
+  // a field that fits in the inner block is written in place
+  wire.setPositon(0);
+  BOOST_CHECK_EQUAL(sink.appendVarNumber(7), 1);
+  BOOST_CHECK_EQUAL(wire.readUint8(0), 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
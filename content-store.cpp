@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "content-store.hpp"
+#include "fast-hash.hpp"
+
+namespace ndn {
+
+/** @brief Count-min sketch of 4 rows of saturating counters, halved every
+ *         10 * width increments so that old popularity fades
+ */
+class ContentStore::FrequencySketch : noncopyable
+{
+public:
+  explicit
+  FrequencySketch(size_t width)
+    : m_counters(N_ROWS * width)
+    , m_mask(width - 1)
+    , m_nIncrements(0)
+    , m_sampleSize(10 * width)
+  {
+  }
+
+  void
+  increment(uint64_t hash)
+  {
+    for (size_t row = 0; row < N_ROWS; ++row) {
+      uint8_t& counter = m_counters[getIndex(hash, row)];
+      if (counter < MAX_COUNT)
+        ++counter;
+    }
+
+    if (++m_nIncrements == m_sampleSize) {
+      for (uint8_t& counter : m_counters) {
+        counter >>= 1;
+      }
+      m_nIncrements = 0;
+    }
+  }
+
+  uint8_t
+  estimate(uint64_t hash) const
+  {
+    uint8_t frequency = MAX_COUNT;
+    for (size_t row = 0; row < N_ROWS; ++row) {
+      frequency = std::min(frequency, m_counters[getIndex(hash, row)]);
+    }
+    return frequency;
+  }
+
+private:
+  size_t
+  getIndex(uint64_t hash, size_t row) const
+  {
+    // double hashing, the second hash is odd so the rows use distinct counters
+    uint64_t step = ((hash >> 32) * UINT64_C(0x9E3779B97F4A7C15)) | 1;
+    return row * (m_mask + 1) + ((hash + row * step) & m_mask);
+  }
+
+private:
+  static const size_t N_ROWS = 4;
+  static const uint8_t MAX_COUNT = 15;
+
+  std::vector<uint8_t> m_counters;
+  size_t m_mask;
+  size_t m_nIncrements;
+  size_t m_sampleSize;
+};
+
+ContentStore::ContentStore(size_t capacity)
+  : m_capacity(capacity)
+  , m_nHits(0)
+  , m_nMisses(0)
+  , m_nInsertions(0)
+  , m_nEvictions(0)
+  , m_nRejections(0)
+{
+  for (size_t segment = 0; segment < N_SEGMENTS; ++segment) {
+    m_bytes[segment] = 0;
+  }
+  computeBudgets();
+}
+
+ContentStore::~ContentStore() = default;
+
+void
+ContentStore::computeBudgets()
+{
+  m_budgets[SEGMENT_WINDOW] = m_capacity / 100;
+  size_t mainBudget = m_capacity - m_budgets[SEGMENT_WINDOW];
+  m_budgets[SEGMENT_PROTECTED] = mainBudget / 5 * 4;
+  m_budgets[SEGMENT_PROBATION] = mainBudget - m_budgets[SEGMENT_PROTECTED];
+
+  // one counter per 2 KB of capacity, which is a few per packet
+  size_t width = 1024;
+  while (width < m_capacity / 2048)
+    width <<= 1;
+  m_sketch.reset(new FrequencySketch(width));
+}
+
+void
+ContentStore::insert(const shared_ptr<const Wire>& data)
+{
+  std::vector<uint8_t> name;
+  if (data == nullptr || !data->getDataName(name))
+    BOOST_THROW_EXCEPTION(Error("Not a Data packet with a Name"));
+
+  std::string key(name.begin(), name.end());
+  uint64_t hash = FastHash::compute(name.data(), name.size());
+  m_sketch->increment(hash);
+  ++m_nInsertions;
+
+  auto found = m_entries.find(key);
+  if (found != m_entries.end())
+    remove(found->second);
+
+  size_t charge = data->getMemoryUsage() + sizeof(Entry) + key.size();
+  if (charge > m_capacity)
+    return;
+
+  EntryList& window = m_lists[SEGMENT_WINDOW];
+  window.push_front(Entry{key, data, charge, hash, SEGMENT_WINDOW});
+  m_bytes[SEGMENT_WINDOW] += charge;
+  m_entries.insert(std::make_pair(key, window.begin()));
+  evictWindow();
+}
+
+shared_ptr<const Wire>
+ContentStore::find(const uint8_t* name, size_t size)
+{
+  // misses are counted too, so a packet requested often is admitted once it is inserted
+  m_sketch->increment(FastHash::compute(name, size));
+
+  auto found = m_entries.find(std::string(reinterpret_cast<const char*>(name), size));
+  if (found == m_entries.end()) {
+    ++m_nMisses;
+    return nullptr;
+  }
+  ++m_nHits;
+
+  EntryList::iterator entry = found->second;
+  if (entry->segment == SEGMENT_WINDOW) {
+    moveTo(entry, SEGMENT_WINDOW);
+  }
+  else {
+    moveTo(entry, SEGMENT_PROTECTED);
+    while (m_bytes[SEGMENT_PROTECTED] > m_budgets[SEGMENT_PROTECTED]) {
+      moveTo(std::prev(m_lists[SEGMENT_PROTECTED].end()), SEGMENT_PROBATION);
+    }
+  }
+  return entry->data;
+}
+
+bool
+ContentStore::erase(const uint8_t* name, size_t size)
+{
+  auto found = m_entries.find(std::string(reinterpret_cast<const char*>(name), size));
+  if (found == m_entries.end())
+    return false;
+
+  remove(found->second);
+  return true;
+}
+
+void
+ContentStore::setCapacity(size_t capacity)
+{
+  m_capacity = capacity;
+  computeBudgets();
+  evictWindow();
+  evictMain();
+}
+
+void
+ContentStore::moveTo(EntryList::iterator entry, Segment segment)
+{
+  m_bytes[entry->segment] -= entry->charge;
+  m_lists[segment].splice(m_lists[segment].begin(), m_lists[entry->segment], entry);
+  entry->segment = segment;
+  m_bytes[segment] += entry->charge;
+}
+
+void
+ContentStore::remove(EntryList::iterator entry)
+{
+  m_bytes[entry->segment] -= entry->charge;
+  m_entries.erase(entry->name);
+  m_lists[entry->segment].erase(entry);
+}
+
+void
+ContentStore::evictWindow()
+{
+  while (m_bytes[SEGMENT_WINDOW] > m_budgets[SEGMENT_WINDOW]) {
+    admit(std::prev(m_lists[SEGMENT_WINDOW].end()));
+  }
+}
+
+void
+ContentStore::admit(EntryList::iterator candidate)
+{
+  size_t mainBudget = m_budgets[SEGMENT_PROBATION] + m_budgets[SEGMENT_PROTECTED];
+  size_t mainBytes = m_bytes[SEGMENT_PROBATION] + m_bytes[SEGMENT_PROTECTED];
+  size_t needed = mainBytes + candidate->charge > mainBudget ?
+                  mainBytes + candidate->charge - mainBudget : 0;
+
+  // the candidate must be more popular than every packet it displaces, least recent first
+  uint8_t frequency = m_sketch->estimate(candidate->hash);
+  std::vector<EntryList::iterator> victims;
+  size_t freed = 0;
+  bool isBeaten = false;
+  for (Segment segment : {SEGMENT_PROBATION, SEGMENT_PROTECTED}) {
+    for (auto victim = m_lists[segment].rbegin();
+         victim != m_lists[segment].rend() && freed < needed && !isBeaten; ++victim) {
+      isBeaten = m_sketch->estimate(victim->hash) >= frequency;
+      if (!isBeaten) {
+        victims.push_back(std::prev(victim.base()));
+        freed += victim->charge;
+      }
+    }
+  }
+
+  if (freed < needed) {
+    remove(candidate);
+    ++m_nRejections;
+    return;
+  }
+
+  for (EntryList::iterator victim : victims) {
+    remove(victim);
+  }
+  m_nEvictions += victims.size();
+  moveTo(candidate, SEGMENT_PROBATION);
+}
+
+void
+ContentStore::evictMain()
+{
+  while (m_bytes[SEGMENT_PROTECTED] > m_budgets[SEGMENT_PROTECTED]) {
+    moveTo(std::prev(m_lists[SEGMENT_PROTECTED].end()), SEGMENT_PROBATION);
+  }
+  while (m_bytes[SEGMENT_PROBATION] + m_bytes[SEGMENT_PROTECTED] >
+         m_budgets[SEGMENT_PROBATION] + m_budgets[SEGMENT_PROTECTED]) {
+    remove(std::prev(m_lists[SEGMENT_PROBATION].end()));
+    ++m_nEvictions;
+  }
+}
+
+ContentStore::Statistics
+ContentStore::getStatistics() const
+{
+  Statistics stats;
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nInsertions = m_nInsertions;
+  stats.nEvictions = m_nEvictions;
+  stats.nRejections = m_nRejections;
+  stats.nEntries = m_entries.size();
+  stats.nBytes = m_bytes[SEGMENT_WINDOW] + m_bytes[SEGMENT_PROBATION] + m_bytes[SEGMENT_PROTECTED];
+  return stats;
+}
+
+} // namespace ndn
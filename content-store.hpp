@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_CONTENT_STORE_HPP
+#define NDN_ENCODING_CONTENT_STORE_HPP
+
+#include "wire_test.hpp"
+
+#include <list>
+#include <unordered_map>
+
+namespace ndn {
+
+/** @brief In-memory cache of encoded Data packets, keyed by Name, within a byte budget
+ *
+ *  A packet is charged with Wire::getMemoryUsage(), the capacity of the segments it holds
+ *  rather than its size, plus the bookkeeping of its entry, so the budget bounds the memory
+ *  actually kept alive.
+ *
+ *  Eviction follows W-TinyLFU: a new packet enters a small LRU window (1% of the budget).  A
+ *  packet leaving the window is admitted to the main segmented LRU only if it was requested
+ *  more often than the packets it would evict, as estimated by a count-min sketch of all
+ *  insertions and lookups that is halved periodically.  Main packets hit again move from the
+ *  probation segment to the protected segment (80% of the main budget).  A burst of packets
+ *  seen once, such as a large segmented download, therefore stays in the window and probation
+ *  and does not flush frequently requested packets.
+ *
+ *  find() returns the stored Wire itself, so it can be sent without copying.
+ *  The store is not thread-safe.
+ */
+class ContentStore : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /** @brief Snapshot of store counters
+   */
+  struct Statistics
+  {
+    uint64_t nHits;
+    uint64_t nMisses;
+    uint64_t nInsertions;
+    uint64_t nEvictions;  ///< packets evicted from the main segments
+    uint64_t nRejections; ///< packets leaving the window that were not admitted
+    size_t nEntries;
+    size_t nBytes;        ///< memory charged to stored packets
+  };
+
+  /** @brief Create a store of at most @p capacity bytes
+   */
+  explicit
+  ContentStore(size_t capacity);
+
+  ~ContentStore();
+
+  /** @brief Insert the Data packet @p data, replacing a stored packet with the same Name
+   *
+   *  The wire is kept as is and must not be modified afterwards.  A packet larger than the
+   *  capacity is not stored.
+   *  @throw Error @p data is not a Data packet
+   */
+  void
+  insert(const shared_ptr<const Wire>& data);
+
+  /** @brief Return the stored packet whose Name TLV is the @p size bytes at @p name,
+   *         or nullptr
+   */
+  shared_ptr<const Wire>
+  find(const uint8_t* name, size_t size);
+
+  /** @brief Erase the stored packet whose Name TLV is the @p size bytes at @p name
+   *  @return whether there was such a packet
+   */
+  bool
+  erase(const uint8_t* name, size_t size);
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+  /** @brief Change the capacity, evicting packets if needed
+   */
+  void
+  setCapacity(size_t capacity);
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  Statistics
+  getStatistics() const;
+
+private:
+  enum Segment {
+    SEGMENT_WINDOW,
+    SEGMENT_PROBATION,
+    SEGMENT_PROTECTED,
+    N_SEGMENTS
+  };
+
+  struct Entry
+  {
+    std::string name;
+    shared_ptr<const Wire> data;
+    size_t charge;
+    uint64_t hash;
+    Segment segment;
+  };
+
+  typedef std::list<Entry> EntryList; // most recently used first
+
+  class FrequencySketch;
+
+  void
+  moveTo(EntryList::iterator entry, Segment segment);
+
+  void
+  remove(EntryList::iterator entry);
+
+  /** @brief Move packets from the window to the main segments while the window is over budget
+   */
+  void
+  evictWindow();
+
+  /** @brief Admit @p candidate to probation if it beats the main packets it would evict
+   */
+  void
+  admit(EntryList::iterator candidate);
+
+  void
+  evictMain();
+
+  void
+  computeBudgets();
+
+private:
+  size_t m_capacity;
+  size_t m_budgets[N_SEGMENTS];
+  size_t m_bytes[N_SEGMENTS];
+  EntryList m_lists[N_SEGMENTS];
+  std::unordered_map<std::string, EntryList::iterator> m_entries;
+  unique_ptr<FrequencySketch> m_sketch;
+
+  uint64_t m_nHits;
+  uint64_t m_nMisses;
+  uint64_t m_nInsertions;
+  uint64_t m_nEvictions;
+  uint64_t m_nRejections;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_CONTENT_STORE_HPP
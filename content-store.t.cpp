@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/content-store.hpp"
+#include "encoding/segment-pool.hpp"
+
+#include "boost-test.hpp"
+#include "make-data.hpp"
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingContentStore)
+
+/** @brief Make a Data packet in a single block, as a forwarder would receive it
+ */
+static shared_ptr<Wire>
+makeSharedData(uint32_t seq, size_t contentSize = 1000)
+{
+  return make_shared<Wire>(makeData(seq, contentSize, 0, contentSize + 64));
+}
+
+static shared_ptr<const Wire>
+find(ContentStore& cs, uint32_t seq)
+{
+  std::vector<uint8_t> name = makeName(seq);
+  return cs.find(name.data(), name.size());
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindErase)
+{
+  ContentStore cs(1024 * 1024);
+  shared_ptr<Wire> data = makeSharedData(1);
+  cs.insert(data);
+  cs.insert(makeSharedData(2));
+
+  // the stored wire itself is returned
+  BOOST_CHECK(find(cs, 1) == data);
+  BOOST_CHECK(find(cs, 3) == nullptr);
+
+  shared_ptr<Wire> replacement = makeSharedData(1, 500);
+  cs.insert(replacement);
+  BOOST_CHECK(find(cs, 1) == replacement);
+  BOOST_CHECK_EQUAL(cs.size(), 2);
+
+  std::vector<uint8_t> name = makeName(2);
+  BOOST_CHECK(cs.erase(name.data(), name.size()));
+  BOOST_CHECK(!cs.erase(name.data(), name.size()));
+  BOOST_CHECK(find(cs, 2) == nullptr);
+
+  ContentStore::Statistics stats = cs.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nHits, 2);
+  BOOST_CHECK_EQUAL(stats.nMisses, 2);
+  BOOST_CHECK_EQUAL(stats.nInsertions, 3);
+  BOOST_CHECK_EQUAL(stats.nEntries, 1);
+  BOOST_CHECK_GE(stats.nBytes, replacement->getMemoryUsage());
+
+  auto interest = make_shared<Wire>(64);
+  const uint8_t bytes[] = {0x05, 0x03, 0x07, 0x01, 0x08};
+  interest->appendArray(bytes, sizeof(bytes));
+  BOOST_CHECK_THROW(cs.insert(interest), ContentStore::Error);
+}
+
+BOOST_AUTO_TEST_CASE(ByteBudget)
+{
+  const size_t capacity = 64 * 1024;
+  ContentStore cs(capacity);
+  size_t chargePerPacket = makeSharedData(0)->getMemoryUsage();
+  BOOST_CHECK_GT(chargePerPacket, makeSharedData(0)->size());
+
+  for (uint32_t seq = 0; seq < 500; ++seq) {
+    cs.insert(makeSharedData(seq));
+    find(cs, seq);
+    BOOST_CHECK_LE(cs.getStatistics().nBytes, capacity);
+  }
+  BOOST_CHECK_LE(cs.size(), capacity / chargePerPacket);
+  BOOST_CHECK_GT(cs.getStatistics().nEvictions + cs.getStatistics().nRejections, 0);
+
+  cs.setCapacity(capacity / 4);
+  BOOST_CHECK_LE(cs.getStatistics().nBytes, capacity / 4);
+
+  // larger than the whole store
+  cs.insert(makeSharedData(1000, 30000));
+  BOOST_CHECK(find(cs, 1000) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(EvictionReleasesSegments)
+{
+  SegmentPool::Statistics before = SegmentPool::get().getStatistics();
+  size_t nReleases = 0;
+  {
+    ContentStore cs(32 * 1024);
+
+    // a packet received into memory owned outside the library
+    std::vector<uint8_t> packet;
+    {
+      shared_ptr<Buffer> bytes = makeData(1, 1000).getBuffer();
+      packet.assign(bytes->begin(), bytes->end());
+    }
+    auto buffer = make_shared<ExternalBuffer>(packet.data(), packet.size(),
+                                              [&nReleases] { ++nReleases; });
+    cs.insert(make_shared<Wire>(buffer, buffer->begin(), buffer->end()));
+    buffer.reset();
+    BOOST_CHECK_EQUAL(nReleases, 0);
+
+    // packets requested before they arrive are more popular and displace it
+    for (uint32_t seq = 2; seq < 200; ++seq) {
+      find(cs, seq);
+      cs.insert(makeSharedData(seq));
+    }
+    BOOST_CHECK(find(cs, 1) == nullptr);
+    BOOST_CHECK_GT(cs.getStatistics().nEvictions, 0);
+    BOOST_CHECK_EQUAL(nReleases, 1);
+  }
+
+  // the pooled segments of dropped packets went back to the pool, the rest with the store
+  SegmentPool::Statistics after = SegmentPool::get().getStatistics();
+  BOOST_CHECK_EQUAL(after.nAllocations - before.nAllocations,
+                    after.nDeallocations - before.nDeallocations);
+}
+
+BOOST_AUTO_TEST_CASE(ScanResistance)
+{
+  ContentStore cs(100 * 1024);
+  for (uint32_t round = 0; round < 5; ++round) {
+    for (uint32_t seq = 0; seq < 40; ++seq) {
+      if (find(cs, seq) == nullptr)
+        cs.insert(makeSharedData(seq));
+    }
+  }
+
+  // a segmented download requesting each packet once
+  for (uint32_t seq = 1000; seq < 3000; ++seq) {
+    if (find(cs, seq) == nullptr)
+      cs.insert(makeSharedData(seq));
+  }
+
+  size_t nHot = 0;
+  for (uint32_t seq = 0; seq < 40; ++seq) {
+    nHot += find(cs, seq) != nullptr;
+  }
+  BOOST_CHECK_GE(nHot, 38);
+  BOOST_CHECK_GT(cs.getStatistics().nRejections, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
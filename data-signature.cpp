@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "data-signature.hpp"
+#include "fast-hash.hpp"
+#include "tlv_test.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <openssl/evp.h>
+
+namespace ndn {
+
+/** @brief Call @p function with each piece of the bytes [@p offset, @p offset + @p length)
+ *         of @p wire that lies in one block
+ */
+template<typename Function>
+static void
+forEachPiece(const Wire& wire, size_t offset, size_t length, const Function& function)
+{
+  for (Wire::const_iterator i = wire.begin(); i != wire.end() && length > 0; ++i) {
+    size_t size = (*i).size();
+    if (offset >= size) {
+      offset -= size;
+      continue;
+    }
+    size_t pieceSize = std::min(length, size - offset);
+    function(static_cast<const uint8_t*>((*i).data()) + offset, pieceSize);
+    offset = 0;
+    length -= pieceSize;
+  }
+}
+
+static std::vector<uint8_t>
+copyRange(const Wire& wire, size_t offset, size_t length)
+{
+  std::vector<uint8_t> bytes;
+  bytes.reserve(length);
+  forEachPiece(wire, offset, length, [&bytes] (const uint8_t* data, size_t size) {
+    bytes.insert(bytes.end(), data, data + size);
+  });
+  return bytes;
+}
+
+/** @brief Read the TLV header at @p begin, within @p end, and move @p begin to its value
+ */
+static void
+readHeader(const Wire& wire, size_t& begin, size_t end, uint32_t& type, uint64_t& length)
+{
+  if (!tlv::readType(wire, begin, end, type) || !tlv::readVarNumber(wire, begin, end, length) ||
+      length > end - begin)
+    BOOST_THROW_EXCEPTION(DataSignature::Error("Malformed TLV in the Data packet"));
+}
+
+DataSignature::DataSignature(const Wire& data)
+  : m_type(0)
+  , m_signedOffset(0)
+  , m_signedSize(0)
+  , m_keyId(0)
+{
+  size_t begin = 0;
+  size_t end = data.size();
+  uint32_t type = 0;
+  uint64_t length = 0;
+  readHeader(data, begin, end, type, length);
+  if (type != tlv::Data)
+    BOOST_THROW_EXCEPTION(Error("Not a Data packet"));
+  end = begin + length;
+  m_signedOffset = begin;
+
+  bool hasSignatureInfo = false;
+  while (begin < end) {
+    readHeader(data, begin, end, type, length);
+    size_t valueEnd = begin + length;
+
+    if (type == tlv::SignatureInfo) {
+      bool hasType = false;
+      for (size_t position = begin; position < valueEnd; position += length) {
+        size_t fieldOffset = position;
+        readHeader(data, position, valueEnd, type, length);
+        if (type == tlv::SignatureType) {
+          if (length > 8)
+            BOOST_THROW_EXCEPTION(Error("SignatureType is too long"));
+          for (size_t i = 0; i < length; ++i) {
+            m_type = m_type << 8 | data.readUint8(position + i);
+          }
+          hasType = true;
+        }
+        else if (type == tlv::KeyLocator) {
+          m_keyLocator = copyRange(data, fieldOffset, position + length - fieldOffset);
+        }
+      }
+      if (!hasType)
+        BOOST_THROW_EXCEPTION(Error("SignatureInfo has no SignatureType"));
+      m_keyId = FastHash::compute(m_keyLocator.data(), m_keyLocator.size());
+      m_signedSize = valueEnd - m_signedOffset;
+      hasSignatureInfo = true;
+    }
+    else if (type == tlv::SignatureValue) {
+      if (!hasSignatureInfo)
+        BOOST_THROW_EXCEPTION(Error("SignatureValue is not preceded by SignatureInfo"));
+      m_value = copyRange(data, begin, length);
+      return;
+    }
+    begin = valueEnd;
+  }
+  BOOST_THROW_EXCEPTION(Error("Data packet is not signed"));
+}
+
+bool
+DataSignature::verify(const Wire& data, evp_pkey_st* key) const
+{
+  switch (m_type) {
+  case tlv::DigestSha256: {
+    ConstBufferPtr digest = data.computeSha256Digest(m_signedOffset, m_signedSize);
+    return m_value.size() == digest->size() &&
+           std::equal(m_value.begin(), m_value.end(), digest->begin());
+  }
+  case tlv::SignatureSha256WithRsa:
+  case tlv::SignatureSha256WithEcdsa: {
+    int keyType = m_type == tlv::SignatureSha256WithRsa ? EVP_PKEY_RSA : EVP_PKEY_EC;
+    if (key == nullptr || EVP_PKEY_base_id(key) != keyType)
+      return false;
+
+    EVP_MD_CTX* context = EVP_MD_CTX_new();
+    if (context == nullptr)
+      return false;
+    bool isValid = EVP_DigestVerifyInit(context, nullptr, EVP_sha256(), nullptr, key) == 1;
+    forEachPiece(data, m_signedOffset, m_signedSize, [&] (const uint8_t* piece, size_t size) {
+      isValid = isValid && EVP_DigestVerifyUpdate(context, piece, size) == 1;
+    });
+    isValid = isValid && EVP_DigestVerifyFinal(context, m_value.data(), m_value.size()) == 1;
+    EVP_MD_CTX_free(context);
+    return isValid;
+  }
+  default:
+    return false;
+  }
+}
+
+} // namespace ndn
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_DATA_SIGNATURE_HPP
+#define NDN_ENCODING_DATA_SIGNATURE_HPP
+
+#include "wire_test.hpp"
+
+struct evp_pkey_st;
+
+namespace ndn {
+
+/** @brief Signature fields of a Data packet, located in its Wire without copying
+ *
+ *  The signed portion, Name through SignatureInfo, is recorded as a range of offsets, so
+ *  verify() feeds its segments straight to the digest.  Only the KeyLocator and the
+ *  SignatureValue, a few hundred bytes at most, are copied out.
+ */
+class DataSignature
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : tlv::Error(what)
+    {
+    }
+  };
+
+  /** @brief Locate the signature fields of the Data packet @p data
+   *  @throw Error @p data is not a Data packet with SignatureInfo and SignatureValue
+   */
+  explicit
+  DataSignature(const Wire& data);
+
+  /** @brief Return the SignatureType
+   */
+  uint64_t
+  getType() const
+  {
+    return m_type;
+  }
+
+  /** @brief Return the offset of the signed portion in the wire
+   */
+  size_t
+  getSignedOffset() const
+  {
+    return m_signedOffset;
+  }
+
+  /** @brief Return the size of the signed portion
+   */
+  size_t
+  getSignedSize() const
+  {
+    return m_signedSize;
+  }
+
+  /** @brief Return the KeyLocator TLV, empty if the SignatureInfo has none
+   */
+  const std::vector<uint8_t>&
+  getKeyLocator() const
+  {
+    return m_keyLocator;
+  }
+
+  /** @brief Return a hash identifying the KeyLocator, the key of the signature
+   */
+  uint64_t
+  getKeyId() const
+  {
+    return m_keyId;
+  }
+
+  /** @brief Return the TLV-VALUE of the SignatureValue
+   */
+  const std::vector<uint8_t>&
+  getValue() const
+  {
+    return m_value;
+  }
+
+  /** @brief Check the signature of @p data, the wire this was located in
+   *  @param key public key of a SignatureSha256WithRsa or SignatureSha256WithEcdsa signature,
+   *             ignored for DigestSha256
+   *  @return whether the signature is valid, false also for an unsupported SignatureType or
+   *          a key of the wrong type
+   */
+  bool
+  verify(const Wire& data, evp_pkey_st* key) const;
+
+private:
+  uint64_t m_type;
+  size_t m_signedOffset;
+  size_t m_signedSize;
+  std::vector<uint8_t> m_keyLocator;
+  uint64_t m_keyId;
+  std::vector<uint8_t> m_value;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_DATA_SIGNATURE_HPP
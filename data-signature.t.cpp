@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/data-signature.hpp"
+#include "encoding/fast-hash.hpp"
+
+#include "boost-test.hpp"
+#include "make-signed-data.hpp"
+
+#include <boost/asio/buffer.hpp>
+
+namespace ndn {
+namespace tests {
+
+/** @brief Encode a Data packet named /data with a 300-byte Content
+ */
+static unique_ptr<Wire>
+makeData(Signer& signer, const Wire* keyName = nullptr)
+{
+  return makeSignedData(signer, {0x07, 0x06, 0x08, 0x04, 'd', 'a', 't', 'a'},
+                        std::vector<uint8_t>(300, 0x5A), keyName);
+}
+
+static std::vector<uint8_t>
+getBytes(const Wire& wire)
+{
+  std::vector<uint8_t> bytes;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>((*i).data());
+    bytes.insert(bytes.end(), data, data + (*i).size());
+  }
+  return bytes;
+}
+
+static unique_ptr<Wire>
+makeWire(const std::vector<uint8_t>& bytes)
+{
+  unique_ptr<Wire> wire = make_unique<Wire>(bytes.size());
+  wire->appendArray(bytes.data(), bytes.size());
+  return wire;
+}
+
+BOOST_AUTO_TEST_SUITE(EncodingDataSignature)
+
+BOOST_AUTO_TEST_CASE(DigestSha256)
+{
+  DigestSha256Signer signer;
+  unique_ptr<Wire> data = makeData(signer);
+  DataSignature signature(*data);
+  BOOST_CHECK_EQUAL(signature.getType(), tlv::DigestSha256);
+  BOOST_CHECK(signature.getKeyLocator().empty());
+  BOOST_CHECK_EQUAL(signature.getKeyId(), FastHash::compute(nullptr, 0));
+
+  // the Data TLV-LENGTH takes 3 octets, the SignatureValue follows the signed portion
+  BOOST_CHECK_EQUAL(signature.getSignedOffset(), 4);
+  BOOST_CHECK_EQUAL(signature.getSignedOffset() + signature.getSignedSize() + 2 +
+                    Sha256::DIGEST_SIZE, data->size());
+  ConstBufferPtr digest = data->computeSha256Digest(signature.getSignedOffset(),
+                                                    signature.getSignedSize());
+  BOOST_CHECK_EQUAL_COLLECTIONS(signature.getValue().begin(), signature.getValue().end(),
+                                digest->begin(), digest->end());
+  BOOST_CHECK(signature.verify(*data, nullptr));
+
+  std::vector<uint8_t> bytes = getBytes(*data);
+  bytes[100] ^= 1;
+  unique_ptr<Wire> tampered = makeWire(bytes);
+  BOOST_CHECK(!DataSignature(*tampered).verify(*tampered, nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(PrivateKey)
+{
+  const uint8_t keyNameBytes[] = {0x07, 0x05, 0x08, 0x03, 'k', 'e', 'y'};
+  Wire keyName(16);
+  keyName.appendArray(keyNameBytes, sizeof(keyNameBytes));
+  std::vector<uint8_t> keyLocator = {0x1C, sizeof(keyNameBytes)};
+  keyLocator.insert(keyLocator.end(), keyNameBytes, keyNameBytes + sizeof(keyNameBytes));
+
+  shared_ptr<EVP_PKEY> rsaKey = generateKey(EVP_PKEY_RSA);
+  shared_ptr<EVP_PKEY> ecKey = generateKey(EVP_PKEY_EC);
+  shared_ptr<EVP_PKEY> otherEcKey = generateKey(EVP_PKEY_EC);
+
+  for (EVP_PKEY* key : {rsaKey.get(), ecKey.get()}) {
+    PrivateKeySigner signer(key);
+    unique_ptr<Wire> data = makeData(signer, &keyName);
+    DataSignature signature(*data);
+    BOOST_CHECK_EQUAL(signature.getType(), signer.getType());
+    BOOST_CHECK_EQUAL_COLLECTIONS(signature.getKeyLocator().begin(),
+                                  signature.getKeyLocator().end(),
+                                  keyLocator.begin(), keyLocator.end());
+    BOOST_CHECK_EQUAL(signature.getKeyId(),
+                      FastHash::compute(keyLocator.data(), keyLocator.size()));
+
+    BOOST_CHECK(signature.verify(*data, key));
+    BOOST_CHECK(!signature.verify(*data, nullptr));
+    BOOST_CHECK(!signature.verify(*data, key == rsaKey.get() ? ecKey.get() : rsaKey.get()));
+    BOOST_CHECK(!signature.verify(*data, otherEcKey.get()));
+
+    std::vector<uint8_t> bytes = getBytes(*data);
+    bytes[10] ^= 1;
+    unique_ptr<Wire> tampered = makeWire(bytes);
+    BOOST_CHECK(!DataSignature(*tampered).verify(*tampered, key));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  DigestSha256Signer signer;
+  std::vector<uint8_t> bytes = getBytes(*makeData(signer));
+
+  // not a Data packet
+  std::vector<uint8_t> interest = bytes;
+  interest[0] = 0x05;
+  unique_ptr<Wire> interestWire = makeWire(interest);
+  BOOST_CHECK_THROW(DataSignature{*interestWire}, DataSignature::Error);
+
+  // truncated
+  unique_ptr<Wire> truncated = makeWire(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1));
+  BOOST_CHECK_THROW(DataSignature{*truncated}, DataSignature::Error);
+
+  // no SignatureValue
+  unique_ptr<Wire> noValue = makeWire({0x06, 0x0A, 0x07, 0x03, 0x08, 0x01, 'a',
+                                       0x16, 0x03, 0x1B, 0x01, 0x00});
+  BOOST_CHECK_THROW(DataSignature{*noValue}, DataSignature::Error);
+
+  // SignatureInfo without SignatureType
+  unique_ptr<Wire> noType = makeWire({0x06, 0x08, 0x07, 0x00, 0x16, 0x00, 0x17, 0x02, 0x00, 0x00});
+  BOOST_CHECK_THROW(DataSignature{*noType}, DataSignature::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
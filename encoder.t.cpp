@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/encoder_test.hpp"
+
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace tests {
+
+using encoding::Encoder;
+
+BOOST_AUTO_TEST_SUITE(EncodingEncoder)
+
+/** @brief Return the encoded bytes of @p encoder
+ */
+static std::vector<uint8_t>
+getBytes(const Encoder& encoder)
+{
+  Wire wire(encoder.getWire());
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  return std::vector<uint8_t>(buffer->begin(), buffer->end());
+}
+
+/** @brief Return the address of the byte at @p position of the wire of @p encoder
+ */
+static const uint8_t*
+getByteAddress(const Encoder& encoder, size_t position)
+{
+  BlockN::const_iterator begin;
+  encoder.getWire().findPosition(begin, position);
+  return begin;
+}
+
+BOOST_AUTO_TEST_CASE(VarNumber)
+{
+  Encoder encoder(64);
+  BOOST_CHECK_EQUAL(encoder.appendVarNumber(252), 1);
+  BOOST_CHECK_EQUAL(encoder.appendVarNumber(253), 3);
+  BOOST_CHECK_EQUAL(encoder.appendVarNumber(65536), 5);
+  BOOST_CHECK_EQUAL(encoder.appendVarNumber(4294967296LL), 9);
+
+  const uint8_t expected[] = {0xFC,
+                              0xFD, 0x00, 0xFD,
+                              0xFE, 0x00, 0x01, 0x00, 0x00,
+                              0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00};
+  std::vector<uint8_t> actual = getBytes(encoder);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(),
+                                expected, expected + sizeof(expected));
+}
+
+BOOST_AUTO_TEST_CASE(VarNumberAcrossSegments)
+{
+  // the 9-byte VAR-NUMBER does not fit in the 2 bytes left, so it goes to a new segment whole
+  Encoder encoder(10);
+  const uint8_t header[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  encoder.appendByteArray(header, sizeof(header));
+  BOOST_CHECK_EQUAL(encoder.appendVarNumber(4294967296LL), 9);
+  BOOST_CHECK_EQUAL(encoder.getWire().size(), 17);
+  BOOST_CHECK_EQUAL(getByteAddress(encoder, 8)[0], 0xFF);
+  BOOST_CHECK_EQUAL(getByteAddress(encoder, 16) - getByteAddress(encoder, 8), 8);
+}
+
+BOOST_AUTO_TEST_CASE(TlvHeader)
+{
+  Encoder encoder(64);
+  BOOST_CHECK_EQUAL(encoder.appendTlvHeader<tlv::Content>(1000), 4);
+  BOOST_CHECK_EQUAL(encoder.appendTlvHeader<tlv::Content>(10), 2);
+  BOOST_CHECK_EQUAL(encoder.appendByteArrayBlock(tlv::Content, nullptr, 0), 2);
+  BOOST_CHECK_EQUAL(encoder.appendNonNegativeInteger(0x1234), 2);
+
+  const uint8_t expected[] = {0x15, 0xFD, 0x03, 0xE8, 0x15, 0x0A, 0x15, 0x00, 0x12, 0x34};
+  std::vector<uint8_t> actual = getBytes(encoder);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(),
+                                expected, expected + sizeof(expected));
+}
+
+BOOST_AUTO_TEST_CASE(AppendBlock)
+{
+  std::vector<uint8_t> bytes(100);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+  BlockN block(bytes.data(), bytes.size());
+
+  Encoder encoder(1000);
+  encoder.appendByte(0xAA);
+  const uint8_t* segment = getByteAddress(encoder, 0);
+  BOOST_CHECK_EQUAL(encoder.appendBlock(block), 100);
+  encoder.appendByte(0xBB);
+
+  // the block is referenced, not copied, and encoding continues in the first segment
+  BOOST_CHECK_EQUAL(getByteAddress(encoder, 1), block.begin());
+  BOOST_CHECK_EQUAL(getByteAddress(encoder, 101), segment + 1);
+
+  std::vector<uint8_t> expected(1, 0xAA);
+  expected.insert(expected.end(), bytes.begin(), bytes.end());
+  expected.push_back(0xBB);
+  std::vector<uint8_t> actual = getBytes(encoder);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(AppendWire)
+{
+  const uint8_t first[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  const uint8_t second[] = {17, 18, 19, 20};
+  Wire wire(16);
+  wire.appendArray(first, sizeof(first));
+  wire.appendArray(second, sizeof(second));
+  BOOST_REQUIRE_EQUAL(wire.countBlock(), 2);
+
+  Encoder encoder(64);
+  encoder.appendByte(0);
+  BOOST_CHECK_EQUAL(encoder.appendWire(wire), 20);
+  BOOST_CHECK_EQUAL(encoder.getWire().size(), 21);
+  BlockN::const_iterator begin;
+  wire.findPosition(begin, 0);
+  BOOST_CHECK_EQUAL(getByteAddress(encoder, 1), begin);
+
+  std::vector<uint8_t> expected(1, 0);
+  expected.insert(expected.end(), first, first + sizeof(first));
+  expected.insert(expected.end(), second, second + sizeof(second));
+  std::vector<uint8_t> actual = getBytes(encoder);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(FromWire)
+{
+  const uint8_t bytes[] = {1, 2, 3};
+  Wire wire(64);
+  wire.appendArray(bytes, sizeof(bytes));
+
+  Encoder encoder(wire);
+  encoder.appendByte(4);
+  const uint8_t expected[] = {1, 2, 3, 4};
+  std::vector<uint8_t> actual = getBytes(encoder);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(),
+                                expected, expected + sizeof(expected));
+  BOOST_CHECK_EQUAL(wire.size(), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // EncodingEncoder
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding-counters.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ndn {
+
+thread_local EncodingCounters::ThreadBlock* EncodingCounters::s_threadBlock = nullptr;
+
+EncodingCounters::ThreadBlock::ThreadBlock()
+{
+  for (std::atomic<uint64_t>& value : values) {
+    value.store(0, std::memory_order_relaxed);
+  }
+}
+
+namespace {
+
+/** @brief Blocks of the live threads and totals of the exited ones
+ */
+struct Registry
+{
+  Registry()
+  {
+    std::fill(std::begin(exitedTotals), std::end(exitedTotals), 0);
+  }
+
+  std::mutex mutex;
+  std::vector<const std::atomic<uint64_t>*> blocks;
+  uint64_t exitedTotals[EncodingCounters::N_COUNTERS];
+};
+
+Registry&
+getRegistry()
+{
+  // never destroyed, as threads may exit after static destruction
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+} // namespace
+
+/** @brief Thread-local owner of the block of a thread, folding it into the totals at exit
+ */
+class EncodingCounters::ThreadBlockOwner : noncopyable
+{
+public:
+  ThreadBlockOwner()
+  {
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.blocks.push_back(block.values);
+  }
+
+  ~ThreadBlockOwner()
+  {
+    Registry& registry = getRegistry();
+    {
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      for (size_t i = 0; i < N_COUNTERS; ++i) {
+        registry.exitedTotals[i] += block.values[i].load(std::memory_order_relaxed);
+      }
+      registry.blocks.erase(std::find(registry.blocks.begin(), registry.blocks.end(),
+                                      block.values));
+    }
+    // events counted by later thread_local destructors are dropped
+    static ThreadBlock discarded;
+    s_threadBlock = &discarded;
+  }
+
+public:
+  ThreadBlock block;
+};
+
+EncodingCounters::ThreadBlock*
+EncodingCounters::registerThread()
+{
+  thread_local ThreadBlockOwner owner;
+  s_threadBlock = &owner.block;
+  return s_threadBlock;
+}
+
+EncodingCounters::Snapshot
+EncodingCounters::getSnapshot()
+{
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Snapshot snapshot;
+  std::copy(std::begin(registry.exitedTotals), std::end(registry.exitedTotals),
+            snapshot.values);
+  for (const std::atomic<uint64_t>* values : registry.blocks) {
+    for (size_t i = 0; i < N_COUNTERS; ++i) {
+      snapshot.values[i] += values[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+const char*
+EncodingCounters::getName(Counter counter)
+{
+  static const char* const NAMES[N_COUNTERS] = {
+    "wire_expansions",
+    "wire_append_copied_bytes",
+    "wire_linearized_bytes",
+    "wire_parse_calls",
+    "wire_parsed_packets",
+    "wire_parsed_segments",
+    "wire_parsed_1_segment",
+    "wire_parsed_2_segments",
+    "wire_parsed_3_4_segments",
+    "wire_parsed_5_8_segments",
+    "wire_subwires",
+    "tlv_errors_truncated",
+    "tlv_errors_length_overflow",
+    "tlv_errors_type_overflow",
+    "tlv_errors_invalid_integer",
+  };
+  return NAMES[counter];
+}
+
+std::string
+EncodingCounters::formatPrometheus(const Snapshot& snapshot)
+{
+  static const char* const HELP[N_COUNTERS] = {
+    "Blocks appended to wires by Wire::expand()",
+    "Bytes copied into wires by Wire::appendArray()",
+    "Bytes copied to linearize wires",
+    "Calls of Wire::parse()",
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    "Subwires allocated by Wire::parse()",
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+  };
+
+  std::ostringstream os;
+  for (size_t i = 0; i < N_COUNTERS; ++i) {
+    if (HELP[i] == nullptr)
+      continue;
+    std::string name = "ndn_" + std::string(getName(static_cast<Counter>(i))) + "_total";
+    os << "# HELP " << name << ' ' << HELP[i] << '\n'
+       << "# TYPE " << name << " counter\n"
+       << name << ' ' << snapshot.values[i] << '\n';
+  }
+
+  // buckets are cumulative in Prometheus
+  os << "# HELP ndn_wire_segments_per_packet Segments of the wires split by Wire::parse()\n"
+     << "# TYPE ndn_wire_segments_per_packet histogram\n";
+  static const char* const BOUNDS[] = {"1", "2", "4", "8"};
+  uint64_t nPackets = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    nPackets += snapshot.values[WIRE_PARSED_1_SEGMENT + i];
+    os << "ndn_wire_segments_per_packet_bucket{le=\"" << BOUNDS[i] << "\"} " << nPackets << '\n';
+  }
+  os << "ndn_wire_segments_per_packet_bucket{le=\"+Inf\"} " << snapshot[WIRE_PARSED_PACKETS]
+     << '\n'
+     << "ndn_wire_segments_per_packet_sum " << snapshot[WIRE_PARSED_SEGMENTS] << '\n'
+     << "ndn_wire_segments_per_packet_count " << snapshot[WIRE_PARSED_PACKETS] << '\n';
+
+  os << "# HELP ndn_tlv_errors_total Malformed TLV encountered, by kind\n"
+     << "# TYPE ndn_tlv_errors_total counter\n";
+  static const char* const KINDS[] = {"truncated", "length_overflow", "type_overflow",
+                                      "invalid_integer"};
+  for (size_t i = 0; i < 4; ++i) {
+    os << "ndn_tlv_errors_total{kind=\"" << KINDS[i] << "\"} "
+       << snapshot.values[TLV_ERRORS_TRUNCATED + i] << '\n';
+  }
+  return os.str();
+}
+
+/** @brief Write all @p size bytes at @p data to @p fd
+ *  @return false on error, with errno set
+ */
+static bool
+writeAll(int fd, const char* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t nWritten = ::write(fd, data, size);
+    if (nWritten < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += nWritten;
+    size -= nWritten;
+  }
+  return true;
+}
+
+void
+EncodingCounters::writePrometheusFile(const std::string& path)
+{
+  std::string text = formatPrometheus(getSnapshot());
+  std::string temporaryPath = path + ".tmp";
+
+  int fd = ::open(temporaryPath.data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot create " + temporaryPath + ": " +
+                                std::string(std::strerror(errno))));
+  bool isWritten = writeAll(fd, text.data(), text.size());
+  int error = errno;
+  ::close(fd);
+  if (!isWritten || std::rename(temporaryPath.data(), path.data()) < 0) {
+    error = isWritten ? errno : error;
+    ::unlink(temporaryPath.data());
+    BOOST_THROW_EXCEPTION(Error("Cannot write " + path + ": " + std::string(std::strerror(error))));
+  }
+}
+
+void
+EncodingCounters::writePrometheusSocket(const std::string& path)
+{
+  sockaddr_un address = {};
+  if (path.size() >= sizeof(address.sun_path))
+    BOOST_THROW_EXCEPTION(Error("Socket path is too long: " + path));
+  address.sun_family = AF_UNIX;
+  std::copy(path.begin(), path.end(), address.sun_path);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot create socket: " + std::string(std::strerror(errno))));
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+    int error = errno;
+    ::close(fd);
+    BOOST_THROW_EXCEPTION(Error("Cannot connect to " + path + ": " +
+                                std::string(std::strerror(error))));
+  }
+
+  std::string text = formatPrometheus(getSnapshot());
+  // MSG_NOSIGNAL: a collector closing early must not raise SIGPIPE
+  const char* data = text.data();
+  size_t size = text.size();
+  while (size > 0) {
+    ssize_t nSent = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (nSent < 0) {
+      if (errno == EINTR)
+        continue;
+      int error = errno;
+      ::close(fd);
+      BOOST_THROW_EXCEPTION(Error("Cannot send to " + path + ": " +
+                                  std::string(std::strerror(error))));
+    }
+    data += nSent;
+    size -= nSent;
+  }
+  ::close(fd);
+}
+
+} // namespace ndn
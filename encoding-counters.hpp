@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_ENCODING_COUNTERS_HPP
+#define NDN_ENCODING_ENCODING_COUNTERS_HPP
+
+#include "../common.hpp"
+
+#include <atomic>
+
+/** @brief Count @p n events of EncodingCounters::@p counter on the calling thread
+ *
+ *  This expands to nothing unless the library is built with NDN_CXX_HAVE_ENCODING_COUNTERS.
+ */
+#ifdef NDN_CXX_HAVE_ENCODING_COUNTERS
+#define NDN_ENCODING_COUNT(counter, n) \
+  ::ndn::EncodingCounters::increment(::ndn::EncodingCounters::counter, (n))
+#else
+#define NDN_ENCODING_COUNT(counter, n) do {} while (false)
+#endif
+
+namespace ndn {
+
+/** @brief Process-wide counters of the Wire and TLV hot paths
+ *
+ *  Every thread counts into a block of its own, aligned and padded to cache lines so that no
+ *  two threads ever write the same line; an increment is a plain load and store on that
+ *  block, without a locked instruction.  getSnapshot() sums the blocks of the live threads and
+ *  the totals of the threads that exited.
+ *
+ *  Unless the library is built with NDN_CXX_HAVE_ENCODING_COUNTERS, NDN_ENCODING_COUNT() is
+ *  compiled out and all counters stay at zero; the snapshot and export functions remain
+ *  available, so that callers need no conditional code.
+ */
+class EncodingCounters : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  enum Counter {
+    WIRE_EXPANSIONS,             ///< Wire::expand() calls
+    WIRE_APPEND_BYTES,           ///< bytes copied by Wire::appendArray()
+    WIRE_LINEARIZED_BYTES,       ///< bytes copied by Wire::getBuffer() and getBufferFromIovec()
+    WIRE_PARSE_CALLS,            ///< Wire::parse() calls
+    WIRE_PARSED_PACKETS,         ///< Wire::parse() calls that split a wire into subwires
+    WIRE_PARSED_SEGMENTS,        ///< segments of the wires split by Wire::parse()
+    WIRE_PARSED_1_SEGMENT,       ///< wires of 1 segment split by Wire::parse()
+    WIRE_PARSED_2_SEGMENTS,      ///< wires of 2 segments
+    WIRE_PARSED_3_4_SEGMENTS,    ///< wires of 3 or 4 segments
+    WIRE_PARSED_5_8_SEGMENTS,    ///< wires of 5 to 8 segments
+    WIRE_SUBWIRES,               ///< subwires allocated by Wire::parse()
+    TLV_ERRORS_TRUNCATED,        ///< TLV fields cut short by the end of the input
+    TLV_ERRORS_LENGTH_OVERFLOW,  ///< TLV-LENGTH beyond the end of the input
+    TLV_ERRORS_TYPE_OVERFLOW,    ///< TLV-TYPE above 2^32-1
+    TLV_ERRORS_INVALID_INTEGER,  ///< NonNegativeInteger of a length other than 1, 2, 4 or 8
+    N_COUNTERS
+  };
+
+  /** @brief Values of all counters at one point in time
+   */
+  struct Snapshot
+  {
+    uint64_t
+    operator[](Counter counter) const
+    {
+      return values[counter];
+    }
+
+    uint64_t values[N_COUNTERS];
+  };
+
+  /** @brief Check whether the library counts events
+   */
+  static constexpr bool
+  isEnabled()
+  {
+#ifdef NDN_CXX_HAVE_ENCODING_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /** @brief Count @p n events of @p counter on the calling thread
+   *  @sa NDN_ENCODING_COUNT
+   */
+  static void
+  increment(Counter counter, uint64_t n = 1)
+  {
+    ThreadBlock* block = s_threadBlock;
+    if (block == nullptr)
+      block = registerThread();
+    std::atomic<uint64_t>& value = block->values[counter];
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  /** @brief Sum the counters of all threads
+   */
+  static Snapshot
+  getSnapshot();
+
+  /** @brief Return the name of @p counter, such as "wire_expansions"
+   */
+  static const char*
+  getName(Counter counter);
+
+  /** @brief Format @p snapshot in the Prometheus text exposition format
+   *
+   *  Each Wire counter is exported as the Prometheus counter ndn_<name>_total, except that the
+   *  WIRE_PARSED_* counters form the histogram ndn_wire_segments_per_packet.  TLV errors are
+   *  exported as ndn_tlv_errors_total with a kind label.
+   */
+  static std::string
+  formatPrometheus(const Snapshot& snapshot);
+
+  /** @brief Write the current counters to the file @p path in the Prometheus text format
+   *
+   *  The file is written next to @p path and renamed over it, so a collector never reads it
+   *  half written, as the node_exporter textfile collector requires.
+   *  @throw Error the file cannot be written
+   */
+  static void
+  writePrometheusFile(const std::string& path);
+
+  /** @brief Send the current counters in the Prometheus text format to the Unix stream
+   *         socket at @p path, then close the connection
+   *  @throw Error the socket cannot be reached
+   */
+  static void
+  writePrometheusSocket(const std::string& path);
+
+private:
+  struct alignas(64) ThreadBlock
+  {
+    ThreadBlock();
+
+    std::atomic<uint64_t> values[N_COUNTERS];
+  };
+
+  class ThreadBlockOwner;
+
+  /** @brief Create and register the block of the calling thread
+   */
+  static ThreadBlock*
+  registerThread();
+
+private:
+  static thread_local ThreadBlock* s_threadBlock;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_ENCODING_COUNTERS_HPP
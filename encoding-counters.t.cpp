@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/encoding-counters.hpp"
+#include "encoding/tlv_test.hpp"
+#include "encoding/wire_test.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+static uint64_t
+getDelta(const EncodingCounters::Snapshot& before, const EncodingCounters::Snapshot& after,
+         EncodingCounters::Counter counter)
+{
+  return after[counter] - before[counter];
+}
+
+static bool
+contains(const std::string& text, const std::string& line)
+{
+  return text.find(line + '\n') != std::string::npos;
+}
+
+BOOST_AUTO_TEST_SUITE(EncodingEncodingCounters)
+
+BOOST_AUTO_TEST_CASE(WireEvents)
+{
+  EncodingCounters::Snapshot before = EncodingCounters::getSnapshot();
+
+  Wire empty(16);
+  empty.parse();
+
+  std::vector<uint8_t> value(3000, 0xAA);
+  Wire large(16);
+  large.appendArray(value.data(), value.size());
+  large.getBuffer();
+
+  const uint8_t tooLong[] = {0x08, 0x05, 0x01};
+  Wire malformed(16);
+  malformed.appendArray(tooLong, sizeof(tooLong));
+  BOOST_CHECK_THROW(malformed.parse(), tlv::Error);
+
+  const uint8_t truncated[] = {0xFD, 0x01};
+  const uint8_t* begin = truncated;
+  BOOST_CHECK_THROW(tlv::readVarNumber(begin, truncated + sizeof(truncated)), tlv::Error);
+
+  EncodingCounters::Snapshot after = EncodingCounters::getSnapshot();
+  if (!EncodingCounters::isEnabled()) {
+    BOOST_CHECK_EQUAL_COLLECTIONS(before.values, before.values + EncodingCounters::N_COUNTERS,
+                                  after.values, after.values + EncodingCounters::N_COUNTERS);
+    return;
+  }
+
+  size_t appended = value.size() + sizeof(tooLong);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_APPEND_BYTES), appended);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_EXPANSIONS), 2);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_LINEARIZED_BYTES),
+                    value.size());
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSE_CALLS), 2);
+  // the malformed wire is not split
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_PACKETS), 0);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_SEGMENTS), 0);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_SUBWIRES), 0);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::TLV_ERRORS_LENGTH_OVERFLOW), 1);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::TLV_ERRORS_TRUNCATED), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ParsedSegments)
+{
+  // three elements over three segments, the second one spanning all of them
+  const uint8_t first[] = {0x08, 0x02, 'a', 'b', 0x08, 0x06, 'c', 'd'};
+  const uint8_t second[] = {'e', 'f', 'g'};
+  const uint8_t third[] = {'h', 0x07, 0x01, 'z'};
+  Wire wire(new BlockN(first, sizeof(first)));
+  wire.appendBlock(new BlockN(second, sizeof(second)));
+  wire.appendBlock(new BlockN(third, sizeof(third)));
+
+  EncodingCounters::Snapshot before = EncodingCounters::getSnapshot();
+  wire.parse();
+  wire.parse();
+  EncodingCounters::Snapshot after = EncodingCounters::getSnapshot();
+  BOOST_CHECK_EQUAL(wire.elements().size(), 3);
+  if (!EncodingCounters::isEnabled())
+    return;
+
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSE_CALLS), 2);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_PACKETS), 1);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_SEGMENTS), 3);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_1_SEGMENT), 0);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_2_SEGMENTS), 0);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_PARSED_3_4_SEGMENTS), 1);
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::WIRE_SUBWIRES), 3);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadsAggregate)
+{
+  EncodingCounters::Snapshot before = EncodingCounters::getSnapshot();
+
+  // counts of exited threads are kept, counts of live threads are read in place
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([] {
+      for (int j = 0; j < 1000; ++j) {
+        EncodingCounters::increment(EncodingCounters::TLV_ERRORS_TYPE_OVERFLOW);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EncodingCounters::increment(EncodingCounters::TLV_ERRORS_TYPE_OVERFLOW, 5);
+
+  EncodingCounters::Snapshot after = EncodingCounters::getSnapshot();
+  BOOST_CHECK_EQUAL(getDelta(before, after, EncodingCounters::TLV_ERRORS_TYPE_OVERFLOW), 4005);
+}
+
+BOOST_AUTO_TEST_CASE(PrometheusFormat)
+{
+  EncodingCounters::Snapshot snapshot = {};
+  snapshot.values[EncodingCounters::WIRE_EXPANSIONS] = 7;
+  snapshot.values[EncodingCounters::WIRE_PARSED_PACKETS] = 10;
+  snapshot.values[EncodingCounters::WIRE_PARSED_SEGMENTS] = 31;
+  snapshot.values[EncodingCounters::WIRE_PARSED_1_SEGMENT] = 4;
+  snapshot.values[EncodingCounters::WIRE_PARSED_2_SEGMENTS] = 3;
+  snapshot.values[EncodingCounters::WIRE_PARSED_5_8_SEGMENTS] = 2;
+  snapshot.values[EncodingCounters::TLV_ERRORS_LENGTH_OVERFLOW] = 9;
+
+  std::string text = EncodingCounters::formatPrometheus(snapshot);
+  BOOST_CHECK(contains(text, "# TYPE ndn_wire_expansions_total counter"));
+  BOOST_CHECK(contains(text, "ndn_wire_expansions_total 7"));
+  BOOST_CHECK(contains(text, "ndn_wire_subwires_total 0"));
+  BOOST_CHECK(contains(text, "# TYPE ndn_wire_segments_per_packet histogram"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_bucket{le=\"1\"} 4"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_bucket{le=\"2\"} 7"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_bucket{le=\"4\"} 7"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_bucket{le=\"8\"} 9"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_bucket{le=\"+Inf\"} 10"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_sum 31"));
+  BOOST_CHECK(contains(text, "ndn_wire_segments_per_packet_count 10"));
+  BOOST_CHECK(contains(text, "ndn_tlv_errors_total{kind=\"length_overflow\"} 9"));
+  BOOST_CHECK(contains(text, "ndn_tlv_errors_total{kind=\"truncated\"} 0"));
+  BOOST_CHECK_EQUAL(text.find("ndn_wire_parsed"), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(PrometheusFile)
+{
+  boost::filesystem::path directory = boost::filesystem::temp_directory_path() /
+                                      boost::filesystem::unique_path();
+  boost::filesystem::create_directory(directory);
+  std::string path = (directory / "ndn.prom").string();
+
+  EncodingCounters::writePrometheusFile(path);
+  EncodingCounters::writePrometheusFile(path);
+  std::ifstream is(path);
+  std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  BOOST_CHECK(contains(text, "# TYPE ndn_wire_expansions_total counter"));
+  BOOST_CHECK(!boost::filesystem::exists(path + ".tmp"));
+
+  BOOST_CHECK_THROW(EncodingCounters::writePrometheusFile((directory / "none" / "x").string()),
+                    EncodingCounters::Error);
+  boost::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(PrometheusSocket)
+{
+  std::string path = (boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path()).string();
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  std::copy(path.begin(), path.end(), address.sun_path);
+
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  BOOST_REQUIRE_GE(listener, 0);
+  BOOST_REQUIRE_EQUAL(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+  BOOST_REQUIRE_EQUAL(::listen(listener, 1), 0);
+
+  std::string received;
+  std::thread collector([listener, &received] {
+    int fd = ::accept(listener, nullptr, nullptr);
+    char buffer[4096];
+    ssize_t nRead;
+    while ((nRead = ::read(fd, buffer, sizeof(buffer))) > 0) {
+      received.append(buffer, nRead);
+    }
+    ::close(fd);
+  });
+
+  EncodingCounters::writePrometheusSocket(path);
+  collector.join();
+  ::close(listener);
+  ::unlink(path.data());
+  BOOST_CHECK(contains(received, "# TYPE ndn_wire_segments_per_packet histogram"));
+
+  BOOST_CHECK_THROW(EncodingCounters::writePrometheusSocket(path), EncodingCounters::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "fast-hash.hpp"
+#include "endian.hpp"
+
+namespace ndn {
+
+static const uint64_t PRIME1 = UINT64_C(0x9E3779B185EBCA87);
+static const uint64_t PRIME2 = UINT64_C(0xC2B2AE3D27D4EB4F);
+static const uint64_t PRIME3 = UINT64_C(0x165667B19E3779F9);
+static const uint64_t PRIME4 = UINT64_C(0x85EBCA77C2B2AE63);
+static const uint64_t PRIME5 = UINT64_C(0x27D4EB2F165667C5);
+
+static inline uint64_t
+rotateLeft(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t
+readUint64(const uint8_t* p)
+{
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return le64toh(value);
+}
+
+static inline uint32_t
+readUint32(const uint8_t* p)
+{
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return le32toh(value);
+}
+
+static inline uint64_t
+mixLane(uint64_t lane, uint64_t input)
+{
+  lane += input * PRIME2;
+  lane = rotateLeft(lane, 31);
+  return lane * PRIME1;
+}
+
+static inline uint64_t
+mergeRound(uint64_t hash, uint64_t lane)
+{
+  hash ^= mixLane(0, lane);
+  return hash * PRIME1 + PRIME4;
+}
+
+static inline void
+consumeStripe(uint64_t* lanes, const uint8_t* stripe)
+{
+  lanes[0] = mixLane(lanes[0], readUint64(stripe));
+  lanes[1] = mixLane(lanes[1], readUint64(stripe + 8));
+  lanes[2] = mixLane(lanes[2], readUint64(stripe + 16));
+  lanes[3] = mixLane(lanes[3], readUint64(stripe + 24));
+}
+
+FastHash::FastHash(uint64_t seed)
+  : m_seed(seed)
+  , m_totalLength(0)
+  , m_stripeSize(0)
+{
+  m_lanes[0] = seed + PRIME1 + PRIME2;
+  m_lanes[1] = seed + PRIME2;
+  m_lanes[2] = seed;
+  m_lanes[3] = seed - PRIME1;
+}
+
+void
+FastHash::update(const uint8_t* data, size_t length)
+{
+  m_totalLength += length;
+
+  if (m_stripeSize + length < sizeof(m_stripe)) {
+    std::copy(data, data + length, m_stripe + m_stripeSize);
+    m_stripeSize += length;
+    return;
+  }
+
+  const uint8_t* end = data + length;
+  if (m_stripeSize > 0) {
+    size_t fill = sizeof(m_stripe) - m_stripeSize;
+    std::copy(data, data + fill, m_stripe + m_stripeSize);
+    consumeStripe(m_lanes, m_stripe);
+    data += fill;
+    m_stripeSize = 0;
+  }
+
+  for (; end - data >= 32; data += 32) {
+    consumeStripe(m_lanes, data);
+  }
+
+  std::copy(data, end, m_stripe);
+  m_stripeSize = end - data;
+}
+
+uint64_t
+FastHash::digest() const
+{
+  uint64_t hash;
+  if (m_totalLength >= sizeof(m_stripe)) {
+    hash = rotateLeft(m_lanes[0], 1) + rotateLeft(m_lanes[1], 7) +
+           rotateLeft(m_lanes[2], 12) + rotateLeft(m_lanes[3], 18);
+    hash = mergeRound(hash, m_lanes[0]);
+    hash = mergeRound(hash, m_lanes[1]);
+    hash = mergeRound(hash, m_lanes[2]);
+    hash = mergeRound(hash, m_lanes[3]);
+  }
+  else {
+    hash = m_seed + PRIME5;
+  }
+  hash += m_totalLength;
+
+  const uint8_t* p = m_stripe;
+  const uint8_t* end = m_stripe + m_stripeSize;
+  for (; end - p >= 8; p += 8) {
+    hash ^= mixLane(0, readUint64(p));
+    hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+  }
+  if (end - p >= 4) {
+    hash ^= readUint32(p) * PRIME1;
+    hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash ^= *p * PRIME5;
+    hash = rotateLeft(hash, 11) * PRIME1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+uint64_t
+FastHash::compute(const uint8_t* data, size_t length, uint64_t seed)
+{
+  FastHash hash(seed);
+  hash.update(data, length);
+  return hash.digest();
+}
+
+} // namespace ndn
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_FAST_HASH_HPP
+#define NDN_ENCODING_FAST_HASH_HPP
+
+#include "../common.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Streaming non-cryptographic 64-bit hash (the XXH64 algorithm)
+ *
+ * The digest depends only on the concatenation of the bytes passed to update(), not on how
+ * they are split, so it can be computed over the segments of a Wire.  Four independent
+ * lanes are processed per 32-byte stripe, which keeps the multipliers busy in parallel.
+ *
+ * @warning It is not suitable where an adversary can choose colliding inputs.
+ */
+class FastHash
+{
+public:
+  explicit
+  FastHash(uint64_t seed = 0);
+
+  /**
+   * @brief Add @p length bytes at @p data to the hashed input
+   */
+  void
+  update(const uint8_t* data, size_t length);
+
+  /**
+   * @brief Return the hash of all bytes added so far
+   */
+  uint64_t
+  digest() const;
+
+  /**
+   * @brief Return the hash of @p length bytes at @p data
+   */
+  static uint64_t
+  compute(const uint8_t* data, size_t length, uint64_t seed = 0);
+
+private:
+  uint64_t m_lanes[4];
+  uint64_t m_seed;
+  uint64_t m_totalLength;
+  uint8_t m_stripe[32];   ///< bytes not yet forming a full stripe
+  size_t m_stripeSize;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_FAST_HASH_HPP
@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/fast-hash.hpp"
+
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingFastHash)
+
+BOOST_AUTO_TEST_CASE(KnownDigests)
+{
+  const std::string input = "Nobody inspects the spammish repetition";
+  BOOST_CHECK_EQUAL(FastHash::compute(nullptr, 0), UINT64_C(0xEF46DB3751D8E999));
+  BOOST_CHECK_EQUAL(FastHash::compute(reinterpret_cast<const uint8_t*>("abc"), 3),
+                    UINT64_C(0x44BC2CF5AD770999));
+  BOOST_CHECK_EQUAL(FastHash::compute(reinterpret_cast<const uint8_t*>(input.data()), input.size()),
+                    UINT64_C(0xFBCEA83C8A378BF1));
+}
+
+BOOST_AUTO_TEST_CASE(SplitInput)
+{
+  uint8_t input[1000];
+  for (size_t i = 0; i < sizeof(input); ++i) {
+    input[i] = static_cast<uint8_t>(i * 7);
+  }
+  uint64_t expected = FastHash::compute(input, sizeof(input));
+
+  for (size_t split = 0; split < sizeof(input); split += 37) {
+    FastHash hash;
+    hash.update(input, split);
+    hash.update(input + split, 0);
+    hash.update(input + split, sizeof(input) - split);
+    BOOST_CHECK_EQUAL(hash.digest(), expected);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+/** @file
+ *  Benchmark of Fib lookups over a synthetic table of one million prefixes.
+ *
+ *  It is a Boost.Test case like the unit tests but is not part of them: build it into a
+ *  separate test program with optimization, e.g.
+ *
+ *      g++ -std=c++11 -O2 -DNDEBUG -I<source root> fib-bench.cpp fib.cpp name-prefix-hashes.cpp
+ *          <the other encoding sources> -lboost_unit_test_framework -lpthread
+ *
+ *  and run it with `--run_test=FibLookup`.  The timings go to standard output.
+ */
+
+#include "encoding/fib.hpp"
+
+#include "boost-test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+/** @brief Synthetic routing table of hierarchical prefixes, as /site/org/unit/...
+ *
+ *  Components near the root are few and shared by many prefixes, deeper ones are many.
+ */
+class SyntheticRoutes
+{
+public:
+  SyntheticRoutes(size_t nPrefixes, uint32_t seed)
+    : m_random(seed)
+  {
+    while (m_routes.size() < nPrefixes) {
+      std::vector<uint8_t> prefix = makeName(1 + m_random() % 6, 0);
+      m_routes.emplace(std::string(prefix.begin(), prefix.end()), m_routes.size());
+    }
+  }
+
+  /** @brief Make a Name TLV of @p nComponents components, with @p nExtra more of them
+   *         beyond any prefix in the table
+   */
+  std::vector<uint8_t>
+  makeName(size_t nComponents, size_t nExtra)
+  {
+    static const size_t fanOut[] = {16, 256, 4096, 65536, 1 << 20, 1 << 24};
+    std::vector<uint8_t> value;
+    for (size_t i = 0; i < nComponents + nExtra; ++i) {
+      std::string component = i < nComponents ?
+                              "c" + std::to_string(m_random() % fanOut[std::min<size_t>(i, 5)]) :
+                              "seg=" + std::to_string(m_random());
+      value.push_back(0x08);
+      value.push_back(static_cast<uint8_t>(component.size()));
+      value.insert(value.end(), component.begin(), component.end());
+    }
+    std::vector<uint8_t> name = {0x07, 0xFD,
+                                 static_cast<uint8_t>(value.size() >> 8),
+                                 static_cast<uint8_t>(value.size())};
+    name.insert(name.end(), value.begin(), value.end());
+    return name;
+  }
+
+  const std::unordered_map<std::string, uint64_t>&
+  getRoutes() const
+  {
+    return m_routes;
+  }
+
+private:
+  std::mt19937 m_random;
+  std::unordered_map<std::string, uint64_t> m_routes;
+};
+
+BOOST_AUTO_TEST_CASE(FibLookup)
+{
+  const size_t N_PREFIXES = 1000000;
+  const size_t N_NAMES = 100000;
+  const size_t N_ROUNDS = 20;
+  const size_t BATCH_SIZE = 256; // lookups per acquired snapshot
+
+  SyntheticRoutes routes(N_PREFIXES, 1);
+  auto startBuild = std::chrono::steady_clock::now();
+  Fib fib;
+  for (const auto& route : routes.getRoutes()) {
+    const uint8_t* prefix = reinterpret_cast<const uint8_t*>(route.first.data());
+    fib.insert(prefix, route.first.size(), route.second);
+  }
+  fib.commit();
+  std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - startBuild;
+  shared_ptr<const Fib::Snapshot> snapshot = fib.getSnapshot();
+  std::cout << "FIB of " << snapshot->size() << " prefixes, " << snapshot->getTableSize()
+            << " keys, built in " << buildTime.count() << " s" << std::endl;
+
+  std::vector<std::vector<uint8_t>> names;
+  for (size_t i = 0; i < N_NAMES; ++i) {
+    names.push_back(routes.makeName(1 + i % 6, 1 + i % 3));
+  }
+
+  // like a forwarding thread, a reader picks up the current snapshot for every batch
+  auto runReader = [&names, BATCH_SIZE] (const Fib& fib, size_t nRounds, size_t& nMatches) {
+    uint64_t nextHop = 0;
+    for (size_t round = 0; round < nRounds; ++round) {
+      for (size_t begin = 0; begin < names.size(); begin += BATCH_SIZE) {
+        shared_ptr<const Fib::Snapshot> snapshot = fib.getSnapshot();
+        size_t end = std::min(begin + BATCH_SIZE, names.size());
+        for (size_t i = begin; i < end; ++i) {
+          nMatches += snapshot->lookup(names[i].data(), names[i].size(), nextHop);
+        }
+      }
+    }
+  };
+
+  size_t nMatches = 0;
+  auto start = std::chrono::steady_clock::now();
+  runReader(fib, N_ROUNDS, nMatches);
+  std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+  std::cout << "1 reader: " << time.count() / (N_NAMES * N_ROUNDS) << " ns/lookup, "
+            << nMatches * 100.0 / (N_NAMES * N_ROUNDS) << "% matched" << std::endl;
+
+  size_t nReaders = std::max(2u, std::thread::hardware_concurrency());
+  std::vector<size_t> nReaderMatches(nReaders);
+  std::vector<std::thread> readers;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < nReaders; ++i) {
+    readers.emplace_back(runReader, std::cref(fib), N_ROUNDS, std::ref(nReaderMatches[i]));
+  }
+  // a rare writer, republishing the table until the readers are done
+  std::atomic<bool> isDone(false);
+  size_t nCommits = 0;
+  std::thread writer([&] {
+    while (!isDone) {
+      std::vector<uint8_t> prefix = routes.makeName(3, 0);
+      fib.insert(prefix.data(), prefix.size(), N_PREFIXES + nCommits);
+      fib.commit();
+      ++nCommits;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  });
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  time = std::chrono::steady_clock::now() - start;
+  isDone = true;
+  writer.join();
+  std::cout << nReaders << " readers: " << time.count() / (N_NAMES * N_ROUNDS)
+            << " ns per lookup of each reader, " << time.count() / (N_NAMES * N_ROUNDS * nReaders)
+            << " ns/lookup aggregate, " << nCommits << " commits" << std::endl;
+}
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "fib.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ndn {
+
+const uint32_t Fib::Snapshot::NO_ROUTE;
+
+Fib::Fib()
+  : m_snapshot(make_shared<Snapshot>(m_routes))
+{
+}
+
+Fib::~Fib() = default;
+
+void
+Fib::insert(const uint8_t* prefix, size_t size, uint64_t nextHop)
+{
+  NamePrefixHashes hashes;
+  hashes.compute(prefix, prefix + size);
+  if (hashes.getPrefixOffset(hashes.size()) != size)
+    BOOST_THROW_EXCEPTION(Error("Trailing bytes after the Name"));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_routes[std::string(reinterpret_cast<const char*>(prefix), size)] = nextHop;
+}
+
+bool
+Fib::erase(const uint8_t* prefix, size_t size)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_routes.erase(std::string(reinterpret_cast<const char*>(prefix), size)) > 0;
+}
+
+void
+Fib::commit()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  shared_ptr<const Snapshot> snapshot = make_shared<Snapshot>(m_routes);
+  std::atomic_store(&m_snapshot, snapshot);
+}
+
+shared_ptr<const Fib::Snapshot>
+Fib::getSnapshot() const
+{
+  return std::atomic_load(&m_snapshot);
+}
+
+bool
+Fib::lookup(const uint8_t* name, size_t size, uint64_t& nextHop) const
+{
+  return getSnapshot()->lookup(name, size, nextHop);
+}
+
+bool
+Fib::lookup(const Wire& wire, size_t offset, uint64_t& nextHop) const
+{
+  return getSnapshot()->lookup(wire, offset, nextHop);
+}
+
+Fib::Snapshot::Snapshot(const std::unordered_map<std::string, uint64_t>& routes)
+  : m_mask(0)
+  , m_nKeys(0)
+{
+  size_t nSlots = 16;
+  while (nSlots < routes.size() * 4)
+    nSlots <<= 1;
+  m_slots.resize(nSlots);
+  m_mask = nSlots - 1;
+  m_routes.reserve(routes.size());
+
+  // every prefix, keyed by its hash and number of components
+  NamePrefixHashes hashes;
+  for (const auto& route : routes) {
+    const uint8_t* name = reinterpret_cast<const uint8_t*>(route.first.data());
+    hashes.compute(name, name + route.first.size());
+    size_t nComponents = hashes.size();
+    size_t valueOffset = hashes.getPrefixOffset(0);
+    size_t keySize = hashes.getPrefixOffset(nComponents) - valueOffset;
+
+    uint32_t keyOffset = m_keys.size();
+    m_keys.insert(m_keys.end(), name + valueOffset, name + valueOffset + keySize);
+    add(hashes[nComponents], nComponents, keyOffset, keySize)->bestMatch = m_routes.size();
+    m_routes.push_back(Route{route.second, keyOffset, static_cast<uint32_t>(nComponents)});
+    m_lengths.push_back(nComponents);
+  }
+  std::sort(m_lengths.begin(), m_lengths.end());
+  m_lengths.erase(std::unique(m_lengths.begin(), m_lengths.end()), m_lengths.end());
+
+  // markers where the binary search for a prefix must continue with longer lengths
+  size_t routeIndex = 0;
+  for (const auto& route : routes) {
+    const uint8_t* name = reinterpret_cast<const uint8_t*>(route.first.data());
+    hashes.compute(name, name + route.first.size());
+    const Route& current = m_routes[routeIndex++];
+    const uint8_t* key = m_keys.data() + current.keyOffset;
+    size_t valueOffset = hashes.getPrefixOffset(0);
+
+    size_t low = 0;
+    size_t high = m_lengths.size();
+    while (low < high) {
+      size_t middle = (low + high) / 2;
+      size_t length = m_lengths[middle];
+      if (length == current.nComponents)
+        break;
+      if (length > current.nComponents) {
+        high = middle;
+        continue;
+      }
+      low = middle + 1;
+
+      size_t markerSize = hashes.getPrefixOffset(length) - valueOffset;
+      if (find(hashes[length], length, key, markerSize) != nullptr)
+        continue;
+
+      // the marker carries the longest route that is a prefix of it
+      uint32_t bestMatch = NO_ROUTE;
+      for (size_t i = middle; i-- > 0 && bestMatch == NO_ROUTE; ) {
+        size_t shorter = m_lengths[i];
+        const Slot* slot = find(hashes[shorter], shorter, key,
+                                hashes.getPrefixOffset(shorter) - valueOffset);
+        if (slot != nullptr && slot->bestMatch != NO_ROUTE &&
+            m_routes[slot->bestMatch].nComponents == shorter)
+          bestMatch = slot->bestMatch;
+      }
+      add(hashes[length], length, current.keyOffset, markerSize)->bestMatch = bestMatch;
+    }
+  }
+}
+
+bool
+Fib::Snapshot::lookup(const uint8_t* name, size_t size, uint64_t& nextHop,
+                      size_t* nComponents) const
+{
+  // reused by every lookup of the thread, so that lookups do not allocate
+  thread_local NamePrefixHashes hashes;
+  hashes.compute(name, name + size);
+  const uint8_t* value = name + hashes.getPrefixOffset(0);
+  size_t valueOffset = hashes.getPrefixOffset(0);
+
+  uint32_t bestMatch = NO_ROUTE;
+  size_t low = 0;
+  size_t high = m_lengths.size();
+  while (low < high) {
+    size_t middle = (low + high) / 2;
+    size_t length = m_lengths[middle];
+    if (length > hashes.size()) {
+      high = middle;
+      continue;
+    }
+
+    const Slot* slot = find(hashes[length], length, value,
+                            hashes.getPrefixOffset(length) - valueOffset);
+    if (slot != nullptr) {
+      if (slot->bestMatch != NO_ROUTE)
+        bestMatch = slot->bestMatch;
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  if (bestMatch == NO_ROUTE)
+    return false;
+
+  nextHop = m_routes[bestMatch].nextHop;
+  if (nComponents != nullptr)
+    *nComponents = m_routes[bestMatch].nComponents;
+  return true;
+}
+
+bool
+Fib::Snapshot::lookup(const Wire& wire, size_t offset, uint64_t& nextHop,
+                      size_t* nComponents) const
+{
+  size_t begin = offset;
+  size_t end = wire.size();
+  uint32_t type = 0;
+  uint64_t length = 0;
+  if (offset >= wire.size() || !tlv::readType(wire, begin, end, type) || type != tlv::Name ||
+      !tlv::readVarNumber(wire, begin, end, length) || length > end - begin)
+    BOOST_THROW_EXCEPTION(Error("Not a Name"));
+  size_t size = begin + length - offset;
+
+  BlockN::const_iterator position;
+  const BlockN* block = wire.findPosition(position, offset);
+  if (size <= static_cast<size_t>(block->begin() + block->size() - position))
+    return lookup(position, size, nextHop, nComponents);
+
+  thread_local std::vector<uint8_t> name;
+  name.resize(size);
+  uint8_t* output = name.data();
+  size_t remaining = size;
+  while (true) {
+    size_t available = std::min<size_t>(remaining, block->begin() + block->size() - position);
+    std::memcpy(output, position, available);
+    output += available;
+    remaining -= available;
+    if (remaining == 0)
+      break;
+    block = block->next();
+    position = block->begin();
+  }
+  return lookup(name.data(), size, nextHop, nComponents);
+}
+
+const Fib::Snapshot::Slot*
+Fib::Snapshot::find(uint64_t hash, size_t nComponents, const uint8_t* key, size_t keySize) const
+{
+  hash = hash != 0 ? hash : 1;
+  for (size_t i = hash & m_mask; ; i = (i + 1) & m_mask) {
+    const Slot& slot = m_slots[i];
+    if (slot.hash == 0)
+      return nullptr;
+    if (slot.hash == hash && slot.nComponents == nComponents && slot.keySize == keySize &&
+        (keySize == 0 || std::memcmp(m_keys.data() + slot.keyOffset, key, keySize) == 0))
+      return &slot;
+  }
+}
+
+Fib::Snapshot::Slot*
+Fib::Snapshot::add(uint64_t hash, size_t nComponents, uint32_t keyOffset, size_t keySize)
+{
+  const Slot* existing = find(hash, nComponents, m_keys.data() + keyOffset, keySize);
+  if (existing != nullptr)
+    return const_cast<Slot*>(existing);
+
+  if ((m_nKeys + 1) * 2 > m_slots.size())
+    grow();
+
+  hash = hash != 0 ? hash : 1;
+  size_t i = hash & m_mask;
+  while (m_slots[i].hash != 0)
+    i = (i + 1) & m_mask;
+
+  Slot& slot = m_slots[i];
+  slot.hash = hash;
+  slot.keyOffset = keyOffset;
+  slot.keySize = keySize;
+  slot.nComponents = nComponents;
+  slot.bestMatch = NO_ROUTE;
+  slot.reserved = 0;
+  ++m_nKeys;
+  return &slot;
+}
+
+void
+Fib::Snapshot::grow()
+{
+  std::vector<Slot> slots(m_slots.size() * 2);
+  m_mask = slots.size() - 1;
+  for (const Slot& slot : m_slots) {
+    if (slot.hash == 0)
+      continue;
+    size_t i = slot.hash & m_mask;
+    while (slots[i].hash != 0)
+      i = (i + 1) & m_mask;
+    slots[i] = slot;
+  }
+  m_slots.swap(slots);
+}
+
+} // namespace ndn
@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_FIB_HPP
+#define NDN_ENCODING_FIB_HPP
+
+#include "name-prefix-hashes.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace ndn {
+
+/** @brief Forwarding table doing longest prefix match directly on encoded Names
+ *
+ *  Lookups run on an immutable Snapshot.  Changes made with insert() and erase() are
+ *  collected and published by commit(), which builds a new snapshot and swaps it in
+ *  atomically; readers holding the previous snapshot keep using it until they release it.
+ *  Any number of threads can look up concurrently with one writer.  Lookups on a snapshot
+ *  take no lock, but acquiring one does (see getSnapshot()).
+ *
+ *  A snapshot stores every prefix in an open-addressing table keyed by the hash of the prefix
+ *  (see NamePrefixHashes) and its number of components.  A lookup hashes all prefixes of the
+ *  Name in one pass and then binary-searches the distinct prefix lengths in the table: a probe
+ *  that hits a prefix, or a marker left on the search path of a longer prefix, continues with
+ *  longer lengths, otherwise with shorter ones.  Every marker records the longest prefix it
+ *  extends, so a lookup takes O(log L) probes for L distinct prefix lengths.  Each probe
+ *  confirms its match against the stored prefix bytes, so hash collisions never yield a wrong
+ *  next hop.
+ */
+class Fib : noncopyable
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : tlv::Error(what)
+    {
+    }
+  };
+
+  class Snapshot;
+
+  Fib();
+
+  ~Fib();
+
+  /** @brief Route the Name TLV prefix [@p prefix, @p prefix + @p size) to @p nextHop,
+   *         effective at the next commit()
+   *  @throw tlv::Error the bytes are not a Name
+   */
+  void
+  insert(const uint8_t* prefix, size_t size, uint64_t nextHop);
+
+  /** @brief Remove the route of the Name TLV prefix [@p prefix, @p prefix + @p size),
+   *         effective at the next commit()
+   *  @return whether there was such a route
+   */
+  bool
+  erase(const uint8_t* prefix, size_t size);
+
+  /** @brief Build a snapshot of all routes and publish it to readers
+   */
+  void
+  commit();
+
+  /** @brief Return the current snapshot
+   *
+   *  The snapshot is read with std::atomic_load, which libstdc++ implements with a mutex
+   *  from a process-wide pool held around the reference count increment, so concurrent
+   *  readers and commit() briefly contend here.  A reader doing many lookups should hold a
+   *  snapshot for a batch of them rather than call lookup() on the Fib, which acquires it
+   *  every time.
+   */
+  shared_ptr<const Snapshot>
+  getSnapshot() const;
+
+  /** @brief Find the longest committed prefix of the Name TLV [@p name, @p name + @p size)
+   *  @param[out] nextHop its next hop
+   *  @return whether a prefix matches
+   *  @throw tlv::Error the bytes are not a Name
+   */
+  bool
+  lookup(const uint8_t* name, size_t size, uint64_t& nextHop) const;
+
+  /** @brief Find the longest committed prefix of the Name TLV at offset @p offset of @p wire
+   */
+  bool
+  lookup(const Wire& wire, size_t offset, uint64_t& nextHop) const;
+
+private:
+  mutable std::mutex m_mutex; // serializes writers
+  std::unordered_map<std::string, uint64_t> m_routes;
+  shared_ptr<const Snapshot> m_snapshot;
+};
+
+/** @brief Immutable state of the Fib at a commit
+ */
+class Fib::Snapshot : noncopyable
+{
+public:
+  /** @brief Build the table of @p routes, Name TLV to next hop
+   */
+  explicit
+  Snapshot(const std::unordered_map<std::string, uint64_t>& routes);
+
+  /** @brief Find the longest prefix of the Name TLV [@p name, @p name + @p size)
+   *  @param[out] nextHop its next hop
+   *  @param[out] nComponents if not null, its number of components
+   *  @return whether a prefix matches
+   *  @throw tlv::Error the bytes are not a Name
+   */
+  bool
+  lookup(const uint8_t* name, size_t size, uint64_t& nextHop, size_t* nComponents = nullptr) const;
+
+  /** @brief Find the longest prefix of the Name TLV at offset @p offset of @p wire
+   *
+   *  A Name within one block is matched in place, one split across blocks is copied first.
+   */
+  bool
+  lookup(const Wire& wire, size_t offset, uint64_t& nextHop, size_t* nComponents = nullptr) const;
+
+  /** @brief Return the number of routes
+   */
+  size_t
+  size() const
+  {
+    return m_routes.size();
+  }
+
+  /** @brief Return the number of table slots, prefixes and markers
+   */
+  size_t
+  getTableSize() const
+  {
+    return m_nKeys;
+  }
+
+private:
+  struct Route
+  {
+    uint64_t nextHop;
+    uint32_t keyOffset;
+    uint32_t nComponents;
+  };
+
+  struct Slot
+  {
+    uint64_t hash;         ///< 0 if the slot is empty
+    uint32_t keyOffset;    ///< components of the prefix, in m_keys
+    uint16_t keySize;
+    uint16_t nComponents;
+    uint32_t bestMatch;    ///< route of the longest prefix of this key, or NO_ROUTE
+    uint32_t reserved;
+  };
+
+  static const uint32_t NO_ROUTE = 0xFFFFFFFF;
+
+  const Slot*
+  find(uint64_t hash, size_t nComponents, const uint8_t* key, size_t keySize) const;
+
+  /** @brief Add a key of @p nComponents components, the first @p keySize bytes at
+   *         @p keyOffset in m_keys, unless it is in the table already
+   */
+  Slot*
+  add(uint64_t hash, size_t nComponents, uint32_t keyOffset, size_t keySize);
+
+  void
+  grow();
+
+private:
+  std::vector<Route> m_routes;
+  std::vector<uint8_t> m_keys;        // components of all prefixes, without the Name header
+  std::vector<uint16_t> m_lengths;    // distinct numbers of components, ascending
+  std::vector<Slot> m_slots;
+  size_t m_mask;
+  size_t m_nKeys;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_FIB_HPP
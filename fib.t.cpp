@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/fib.hpp"
+
+#include "boost-test.hpp"
+
+#include <random>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingFib)
+
+static std::vector<uint8_t>
+makeName(const std::vector<std::string>& components)
+{
+  std::vector<uint8_t> value;
+  for (const std::string& component : components) {
+    value.push_back(0x08);
+    value.push_back(static_cast<uint8_t>(component.size()));
+    value.insert(value.end(), component.begin(), component.end());
+  }
+  std::vector<uint8_t> name = {0x07, static_cast<uint8_t>(value.size())};
+  name.insert(name.end(), value.begin(), value.end());
+  return name;
+}
+
+static void
+insert(Fib& fib, const std::vector<std::string>& prefix, uint64_t nextHop)
+{
+  std::vector<uint8_t> name = makeName(prefix);
+  fib.insert(name.data(), name.size(), nextHop);
+}
+
+static uint64_t
+lookup(const Fib& fib, const std::vector<std::string>& components)
+{
+  std::vector<uint8_t> name = makeName(components);
+  uint64_t nextHop = 0;
+  return fib.lookup(name.data(), name.size(), nextHop) ? nextHop : 0;
+}
+
+BOOST_AUTO_TEST_CASE(LongestPrefixMatch)
+{
+  Fib fib;
+  insert(fib, {}, 1);
+  insert(fib, {"a"}, 2);
+  insert(fib, {"a", "b", "c"}, 3);
+  insert(fib, {"x", "y"}, 4);
+  BOOST_CHECK_EQUAL(lookup(fib, {"a"}), 0); // not committed
+  fib.commit();
+
+  BOOST_CHECK_EQUAL(lookup(fib, {"a"}), 2);
+  BOOST_CHECK_EQUAL(lookup(fib, {"a", "b"}), 2);
+  BOOST_CHECK_EQUAL(lookup(fib, {"a", "b", "c", "d"}), 3);
+  BOOST_CHECK_EQUAL(lookup(fib, {"x"}), 1);
+  BOOST_CHECK_EQUAL(lookup(fib, {"x", "y", "z"}), 4);
+  BOOST_CHECK_EQUAL(lookup(fib, {}), 1);
+
+  std::vector<uint8_t> root = makeName({});
+  BOOST_CHECK(fib.erase(root.data(), root.size()));
+  BOOST_CHECK(!fib.erase(root.data(), root.size()));
+  fib.commit();
+  BOOST_CHECK_EQUAL(lookup(fib, {"x"}), 0);
+  BOOST_CHECK_EQUAL(fib.getSnapshot()->size(), 3);
+
+  size_t nComponents = 0;
+  uint64_t nextHop = 0;
+  std::vector<uint8_t> name = makeName({"a", "b", "c", "d"});
+  BOOST_CHECK(fib.getSnapshot()->lookup(name.data(), name.size(), nextHop, &nComponents));
+  BOOST_CHECK_EQUAL(nComponents, 3);
+
+  const uint8_t notName[] = {0x08, 0x01, 'a'};
+  BOOST_CHECK_THROW(fib.insert(notName, sizeof(notName), 5), tlv::Error);
+  BOOST_CHECK_THROW(fib.lookup(notName, sizeof(notName), nextHop), tlv::Error);
+}
+
+BOOST_AUTO_TEST_CASE(MatchesLinearSearch)
+{
+  std::mt19937 random(1);
+  auto makeComponents = [&random] (size_t maxComponents) {
+    std::vector<std::string> components(random() % (maxComponents + 1));
+    for (std::string& component : components) {
+      component = std::string(1, static_cast<char>('a' + random() % 3));
+    }
+    return components;
+  };
+
+  Fib fib;
+  std::map<std::vector<std::string>, uint64_t> routes;
+  for (uint64_t i = 1; i <= 500; ++i) {
+    std::vector<std::string> prefix = makeComponents(7);
+    insert(fib, prefix, i);
+    routes[prefix] = i;
+  }
+  fib.commit();
+
+  for (size_t i = 0; i < 5000; ++i) {
+    std::vector<std::string> name = makeComponents(10);
+    uint64_t expected = 0;
+    for (size_t length = name.size() + 1; length-- > 0 && expected == 0; ) {
+      auto route = routes.find(std::vector<std::string>(name.begin(), name.begin() + length));
+      if (route != routes.end())
+        expected = route->second;
+    }
+    BOOST_REQUIRE_EQUAL(lookup(fib, name), expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WireLookup)
+{
+  Fib fib;
+  insert(fib, {"ndn", "edu"}, 7);
+  fib.commit();
+
+  std::vector<uint8_t> name = makeName({"ndn", "edu", "ucla", "ping"});
+  const uint8_t header[] = {0x05, static_cast<uint8_t>(name.size())};
+  for (size_t split = 1; split < name.size(); ++split) {
+    Wire wire(sizeof(header) + split);
+    wire.appendArray(header, sizeof(header));
+    wire.appendArray(name.data(), split);
+    wire.appendSharedBlock(BlockN(name.data() + split, name.size() - split));
+
+    uint64_t nextHop = 0;
+    BOOST_CHECK(fib.lookup(wire, sizeof(header), nextHop));
+    BOOST_CHECK_EQUAL(nextHop, 7);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentReaders)
+{
+  Fib fib;
+  insert(fib, {"a"}, 1);
+  fib.commit();
+
+  std::atomic<bool> isDone(false);
+  std::atomic<size_t> nWrong(0);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!isDone) {
+        uint64_t nextHop = lookup(fib, {"a", "b", "c"});
+        if (nextHop != 1 && nextHop != 2)
+          ++nWrong;
+      }
+    });
+  }
+
+  for (uint64_t round = 0; round < 200; ++round) {
+    insert(fib, {"a", "b"}, 2);
+    fib.commit();
+    std::vector<uint8_t> prefix = makeName({"a", "b"});
+    fib.erase(prefix.data(), prefix.size());
+    fib.commit();
+  }
+  isDone = true;
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  BOOST_CHECK_EQUAL(nWrong, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "io-uring-engine.hpp"
+
+#ifdef NDN_CXX_HAVE_IO_URING
+
+#include "segment-pool.hpp"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+namespace ndn {
+
+struct IoUringEngine::Operation
+{
+  SendCallback sendCallback;
+  ReceiveCallback receiveCallback;
+  unique_ptr<BlockN> block;          // receive buffer, nullptr for a send
+  int result;
+  msghdr message;
+  std::vector<iovec> iov;
+};
+
+static int
+ioUringSetup(unsigned entries, io_uring_params* params)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int
+ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags,
+                                    nullptr, 0));
+}
+
+static int
+ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned nArgs)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nArgs));
+}
+
+template<class T>
+static T*
+ringField(void* ring, uint32_t offset)
+{
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+bool
+IoUringEngine::isSupported()
+{
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  int fd = ioUringSetup(1, &params);
+  if (fd < 0)
+    return false;
+
+  ::close(fd);
+  return true;
+}
+
+IoUringEngine::IoUringEngine(unsigned queueDepth)
+  : m_sqRing(MAP_FAILED)
+  , m_cqRing(MAP_FAILED)
+  , m_sqes(MAP_FAILED)
+  , m_nQueued(0)
+  , m_nInFlight(0)
+{
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  m_ringFd = ioUringSetup(queueDepth, &params);
+  if (m_ringFd < 0)
+    BOOST_THROW_EXCEPTION(Error("io_uring_setup failed: " + std::string(std::strerror(errno))));
+  m_queueDepth = params.sq_entries;
+
+  m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool isSingleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (isSingleMmap) {
+    m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+  }
+
+  m_sqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ringFd, IORING_OFF_SQ_RING);
+  if (isSingleMmap) {
+    m_cqRing = m_sqRing;
+  }
+  else if (m_sqRing != MAP_FAILED) {
+    m_cqRing = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ringFd, IORING_OFF_CQ_RING);
+  }
+  if (m_cqRing != MAP_FAILED) {
+    m_sqes = ::mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+  }
+  if (m_sqes == MAP_FAILED) {
+    int error = errno;
+    unmapRing();
+    BOOST_THROW_EXCEPTION(Error("Cannot map io_uring: " + std::string(std::strerror(error))));
+  }
+
+  m_sqHead = ringField<unsigned>(m_sqRing, params.sq_off.head);
+  m_sqTail = ringField<unsigned>(m_sqRing, params.sq_off.tail);
+  m_sqLocalTail = *m_sqTail;
+  m_sqMask = *ringField<unsigned>(m_sqRing, params.sq_off.ring_mask);
+  m_sqArray = ringField<unsigned>(m_sqRing, params.sq_off.array);
+  m_cqHead = ringField<unsigned>(m_cqRing, params.cq_off.head);
+  m_cqTail = ringField<unsigned>(m_cqRing, params.cq_off.tail);
+  m_cqMask = *ringField<unsigned>(m_cqRing, params.cq_off.ring_mask);
+  m_cqes = ringField<io_uring_cqe>(m_cqRing, params.cq_off.cqes);
+}
+
+IoUringEngine::~IoUringEngine()
+{
+  try {
+    cancelAll();
+  }
+  catch (const Error&) {
+    // the ring is torn down anyway, the kernel cancels what is left
+  }
+  for (Operation* op : m_operations) {
+    delete op;
+  }
+  unmapRing();
+}
+
+void
+IoUringEngine::cancelAll()
+{
+  for (Operation* op : m_operations) {
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(getSubmissionEntry());
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = reinterpret_cast<uintptr_t>(op);
+    sqe->user_data = 0;
+  }
+  submit();
+
+  // a receive buffer may be written until its operation completes
+  std::vector<unique_ptr<Operation>> completions;
+  while (m_nInFlight > 0) {
+    enter(m_nQueued, 1);
+    reap(completions);
+    completions.clear();
+  }
+}
+
+void
+IoUringEngine::unmapRing()
+{
+  if (m_sqes != MAP_FAILED)
+    ::munmap(m_sqes, m_queueDepth * sizeof(io_uring_sqe));
+  if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+    ::munmap(m_cqRing, m_cqRingSize);
+  if (m_sqRing != MAP_FAILED)
+    ::munmap(m_sqRing, m_sqRingSize);
+  ::close(m_ringFd);
+}
+
+size_t
+IoUringEngine::registerSegmentPool()
+{
+  if (!m_fixedBuffers.empty()) {
+    ioUringRegister(m_ringFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    m_fixedBuffers.clear();
+  }
+
+  std::vector<void*> chunks = SegmentPool::get().getChunks();
+  if (chunks.empty())
+    return 0;
+  // buf_index of a submission entry is 16 bits wide
+  if (chunks.size() > std::numeric_limits<uint16_t>::max())
+    chunks.resize(std::numeric_limits<uint16_t>::max());
+
+  std::vector<iovec> iov(chunks.size());
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    iov[i].iov_base = chunks[i];
+    iov[i].iov_len = SegmentPool::CHUNK_SIZE;
+  }
+  if (ioUringRegister(m_ringFd, IORING_REGISTER_BUFFERS, iov.data(), iov.size()) < 0)
+    return 0;
+
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    m_fixedBuffers[chunks[i]] = static_cast<uint16_t>(i);
+  }
+  return chunks.size();
+}
+
+void*
+IoUringEngine::getSubmissionEntry()
+{
+  if (m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) == m_queueDepth) {
+    submit();
+    if (m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) == m_queueDepth)
+      BOOST_THROW_EXCEPTION(Error("io_uring submission queue is full"));
+  }
+
+  unsigned index = m_sqLocalTail & m_sqMask;
+  io_uring_sqe* sqe = static_cast<io_uring_sqe*>(m_sqes) + index;
+  std::memset(sqe, 0, sizeof(*sqe));
+  m_sqArray[index] = index;
+  // the entry is filled by the caller, the kernel sees it once submit() publishes the tail
+  ++m_sqLocalTail;
+  ++m_nQueued;
+  ++m_nInFlight;
+  return sqe;
+}
+
+void
+IoUringEngine::asyncSend(int fd, const Wire& wire, const SendCallback& callback)
+{
+  unique_ptr<Operation> op(new Operation);
+  op->sendCallback = callback;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    iovec iov;
+    iov.iov_base = const_cast<void*>((*i).data());
+    iov.iov_len = (*i).size();
+    op->iov.push_back(iov);
+  }
+  std::memset(&op->message, 0, sizeof(op->message));
+  op->message.msg_iov = op->iov.data();
+  op->message.msg_iovlen = op->iov.size();
+
+  io_uring_sqe* sqe = static_cast<io_uring_sqe*>(getSubmissionEntry());
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(&op->message);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = reinterpret_cast<uintptr_t>(op.get());
+  m_operations.insert(op.release());
+}
+
+void
+IoUringEngine::asyncReceive(int fd, size_t maxSize, const ReceiveCallback& callback)
+{
+  unique_ptr<Operation> op(new Operation);
+  op->receiveCallback = callback;
+  io_uring_sqe* sqe = static_cast<io_uring_sqe*>(getSubmissionEntry());
+  op->block.reset(BlockN::allocate(maxSize));
+  uint8_t* dest = const_cast<uint8_t*>(op->block->begin());
+
+  auto fixedBuffer = m_fixedBuffers.find(SegmentPool::getChunkOf(dest));
+  if (maxSize <= SegmentPool::MAX_POOLED_SIZE && fixedBuffer != m_fixedBuffers.end()) {
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->buf_index = fixedBuffer->second;
+  }
+  else {
+    sqe->opcode = IORING_OP_RECV;
+  }
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(dest);
+  sqe->len = static_cast<uint32_t>(maxSize);
+  sqe->user_data = reinterpret_cast<uintptr_t>(op.get());
+  m_operations.insert(op.release());
+}
+
+void
+IoUringEngine::enter(unsigned toSubmit, unsigned minComplete)
+{
+  unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+  int nSubmitted = ioUringEnter(m_ringFd, toSubmit, minComplete, flags);
+  if (nSubmitted < 0) {
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+      return;
+    BOOST_THROW_EXCEPTION(Error("io_uring_enter failed: " + std::string(std::strerror(errno))));
+  }
+  m_nQueued -= std::min<unsigned>(m_nQueued, nSubmitted);
+}
+
+size_t
+IoUringEngine::submit()
+{
+  if (m_nQueued == 0)
+    return 0;
+
+  unsigned nQueued = m_nQueued;
+  __atomic_store_n(m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+  enter(nQueued, 0);
+  return nQueued - m_nQueued;
+}
+
+size_t
+IoUringEngine::poll(bool wait)
+{
+  bool isCompletionReady = *m_cqHead != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+  unsigned minComplete = wait && !isCompletionReady && m_nInFlight > 0 ? 1 : 0;
+  if (m_nQueued > 0 || minComplete > 0) {
+    __atomic_store_n(m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+    enter(m_nQueued, minComplete);
+  }
+
+  // take all ready completions first, so callbacks may queue new operations; the ones left
+  // when a callback throws are deleted with the vector
+  std::vector<unique_ptr<Operation>> completions;
+  size_t nCompleted = reap(completions);
+
+  for (const auto& op : completions) {
+    if (op->block == nullptr) {
+      if (op->sendCallback)
+        op->sendCallback(op->result);
+      continue;
+    }
+
+    // the wire owns the received block, its buffer lives on if it was taken
+    op->block->setSize(op->result > 0 ? static_cast<size_t>(op->result) : 0);
+    Wire wire(op->block.release());
+    if (op->receiveCallback)
+      op->receiveCallback(op->result, wire);
+  }
+  return nCompleted;
+}
+
+size_t
+IoUringEngine::reap(std::vector<unique_ptr<Operation>>& completions)
+{
+  size_t nCompleted = 0;
+  unsigned head = *m_cqHead;
+  unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head, ++nCompleted) {
+    const io_uring_cqe* cqe = static_cast<const io_uring_cqe*>(m_cqes) + (head & m_cqMask);
+    Operation* op = reinterpret_cast<Operation*>(cqe->user_data);
+    // cancellation requests carry no operation
+    if (op != nullptr) {
+      m_operations.erase(op);
+      op->result = cqe->res;
+      completions.emplace_back(op);
+    }
+  }
+  __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+  m_nInFlight -= nCompleted;
+  return nCompleted;
+}
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_IO_URING
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_IO_URING_ENGINE_HPP
+#define NDN_ENCODING_IO_URING_ENGINE_HPP
+
+#include "wire_test.hpp"
+
+#ifdef NDN_CXX_HAVE_IO_URING
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ndn {
+
+/** @brief Socket I/O engine on a Linux io_uring, driven with raw system calls
+ *
+ *  Operations are queued with asyncSend() and asyncReceive(), handed to the kernel together
+ *  by submit(), and their completions are reaped in a batch by poll().  Callbacks are invoked
+ *  from poll() with the result of the operation: the number of bytes, or a negative errno.
+ *
+ *  A received packet lands directly in a segment allocated from the SegmentPool.  After
+ *  registerSegmentPool(), such a receive uses the pool slabs as fixed buffers, so the kernel
+ *  does not have to map the pages for every operation.  A send submits the segments of the
+ *  Wire as one sendmsg iovec without copying them.  Any socket works, including loopback and
+ *  Unix domain sockets.
+ *
+ *  The engine is available when the build finds <linux/io_uring.h>
+ *  (NDN_CXX_HAVE_IO_URING), and needs a kernel of at least 5.6 at run time.
+ *  It is not thread-safe.
+ */
+class IoUringEngine : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  typedef function<void(int result)> SendCallback;
+  typedef function<void(int result, Wire& wire)> ReceiveCallback;
+
+  /** @brief Create an io_uring with @p queueDepth submission entries
+   *  @throw Error io_uring is not available
+   */
+  explicit
+  IoUringEngine(unsigned queueDepth = 256);
+
+  /** @brief Cancel the operations still in flight without invoking their callbacks, and wait
+   *         until the kernel has released their buffers
+   */
+  ~IoUringEngine();
+
+  /** @brief Check whether the running kernel provides io_uring
+   */
+  static bool
+  isSupported();
+
+  /** @brief Register every slab of the SegmentPool as a fixed buffer
+   *
+   *  Slabs mapped later are not covered until this is called again, so call it after the
+   *  pool has warmed up.  Receives into segments outside the registered slabs still work.
+   *  @return number of registered slabs, 0 if the kernel refused the registration
+   *          (e.g. because of RLIMIT_MEMLOCK)
+   */
+  size_t
+  registerSegmentPool();
+
+  /** @brief Queue sending @p wire on socket @p fd, as one message
+   *
+   *  @p wire must stay unchanged until @p callback is invoked.
+   */
+  void
+  asyncSend(int fd, const Wire& wire, const SendCallback& callback);
+
+  /** @brief Queue receiving up to @p maxSize bytes from socket @p fd into a pooled segment
+   *
+   *  @p callback gets a wire owning one block that holds the received bytes.  The wire is
+   *  destroyed when the callback returns, so keep its buffer (BlockN::getBuffer() through
+   *  Wire::findPosition()) or copy the bytes to retain them.
+   */
+  void
+  asyncReceive(int fd, size_t maxSize, const ReceiveCallback& callback);
+
+  /** @brief Submit all queued operations with a single system call
+   *  @return number of operations submitted
+   */
+  size_t
+  submit();
+
+  /** @brief Submit queued operations, reap all available completions and invoke their callbacks
+   *  @param wait block until at least one completion is available
+   *  @return number of completions reaped
+   */
+  size_t
+  poll(bool wait = false);
+
+  /** @brief Return the number of operations submitted or queued but not completed
+   */
+  size_t
+  getInFlight() const
+  {
+    return m_nInFlight;
+  }
+
+private:
+  struct Operation;
+
+  /** @brief Return a free submission entry, submitting queued ones if the ring is full
+   */
+  void*
+  getSubmissionEntry();
+
+  void
+  enter(unsigned toSubmit, unsigned minComplete);
+
+  /** @brief Take the ready completions into @p completions, with their results set
+   *  @return number of completion entries consumed, including those of cancellation requests
+   */
+  size_t
+  reap(std::vector<unique_ptr<Operation>>& completions);
+
+  void
+  cancelAll();
+
+  void
+  unmapRing();
+
+private:
+  int m_ringFd;
+  unsigned m_queueDepth;
+
+  void* m_sqRing;
+  size_t m_sqRingSize;
+  void* m_cqRing;
+  size_t m_cqRingSize;
+  void* m_sqes;
+
+  unsigned* m_sqHead;
+  unsigned* m_sqTail;
+  unsigned m_sqLocalTail;          ///< tail including the entries not yet published
+  unsigned m_sqMask;
+  unsigned* m_sqArray;
+  unsigned* m_cqHead;
+  unsigned* m_cqTail;
+  unsigned m_cqMask;
+  void* m_cqes;
+
+  unsigned m_nQueued;
+  size_t m_nInFlight;
+  std::unordered_map<const void*, uint16_t> m_fixedBuffers; ///< slab => fixed buffer index
+  std::unordered_set<Operation*> m_operations;             ///< queued or in the kernel
+};
+
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_IO_URING
+
+#endif // NDN_ENCODING_IO_URING_ENGINE_HPP
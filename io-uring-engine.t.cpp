@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/io-uring-engine.hpp"
+
+#ifdef NDN_CXX_HAVE_IO_URING
+
+#include "encoding/segment-pool.hpp"
+
+#include "boost-test.hpp"
+
+#include <sys/socket.h>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingIoUringEngine)
+
+BOOST_AUTO_TEST_CASE(UnixDatagram)
+{
+  if (!IoUringEngine::isSupported()) {
+    BOOST_TEST_MESSAGE("io_uring is not available, skipping");
+    return;
+  }
+
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+  IoUringEngine engine(4);
+  // make sure the pool has a slab for the receive segments
+  Buffer segment(2048, Buffer::UninitializedTag());
+  engine.registerSegmentPool(); // may register nothing under a low RLIMIT_MEMLOCK
+
+  const uint8_t header[] = {0x06, 0x64};
+  uint8_t content[100];
+  for (size_t i = 0; i < sizeof(content); ++i) {
+    content[i] = static_cast<uint8_t>(i);
+  }
+  Wire wire(2048);
+  wire.appendArray(header, sizeof(header));
+  BlockN contentBlock(content, sizeof(content));
+  wire.appendSharedBlock(contentBlock);
+
+  // more operations than submission entries
+  size_t nSent = 0;
+  size_t nReceived = 0;
+  ConstBufferPtr kept;
+  for (int i = 0; i < 10; ++i) {
+    engine.asyncReceive(fds[1], 2048, [&] (int result, Wire& received) {
+      BOOST_CHECK_EQUAL(result, 102);
+      BOOST_CHECK_EQUAL(received.size(), 102);
+      BOOST_CHECK_EQUAL(received.readUint8(0), 0x06);
+      BOOST_CHECK_EQUAL(received.readUint8(101), 99);
+      BlockN::const_iterator begin;
+      kept = received.findPosition(begin, 0)->getBuffer();
+      ++nReceived;
+    });
+    engine.asyncSend(fds[0], wire, [&] (int result) {
+      BOOST_CHECK_EQUAL(result, 102);
+      ++nSent;
+    });
+  }
+  while (engine.getInFlight() > 0) {
+    engine.poll(true);
+  }
+  BOOST_CHECK_EQUAL(nSent, 10);
+  BOOST_CHECK_EQUAL(nReceived, 10);
+  // the buffer taken in the callback outlives the received block
+  BOOST_REQUIRE(kept != nullptr);
+  BOOST_CHECK_EQUAL((*kept)[0], 0x06);
+  BOOST_CHECK_EQUAL((*kept)[101], 99);
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_CASE(ThrowingCallback)
+{
+  if (!IoUringEngine::isSupported()) {
+    BOOST_TEST_MESSAGE("io_uring is not available, skipping");
+    return;
+  }
+
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+  const uint8_t packet[] = {0x06, 0x00};
+  BOOST_REQUIRE_EQUAL(::send(fds[0], packet, sizeof(packet), 0), 2);
+  BOOST_REQUIRE_EQUAL(::send(fds[0], packet, sizeof(packet), 0), 2);
+
+  IoUringEngine engine(4);
+  SegmentPool::Statistics before = SegmentPool::get().getStatistics();
+  size_t nCallbacks = 0;
+  for (int i = 0; i < 2; ++i) {
+    engine.asyncReceive(fds[1], 2048, [&] (int, Wire&) {
+      ++nCallbacks;
+      BOOST_THROW_EXCEPTION(std::runtime_error("callback failed"));
+    });
+  }
+  engine.submit();
+
+  size_t nThrown = 0;
+  while (engine.getInFlight() > 0) {
+    try {
+      engine.poll(true);
+    }
+    catch (const std::runtime_error&) {
+      ++nThrown;
+    }
+  }
+  // a receive reaped together with the throwing one is dropped without its callback
+  BOOST_CHECK_GE(nCallbacks, 1);
+  BOOST_CHECK_EQUAL(nCallbacks, nThrown);
+  BOOST_CHECK_EQUAL(engine.poll(), 0);
+
+  // the segments of both receives are returned, with the wires or with the dropped operation
+  SegmentPool::Statistics after = SegmentPool::get().getStatistics();
+  BOOST_CHECK_EQUAL(after.nAllocations - before.nAllocations, 2);
+  BOOST_CHECK_EQUAL(after.nDeallocations - before.nDeallocations, 2);
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_CASE(DestroyInFlight)
+{
+  if (!IoUringEngine::isSupported()) {
+    BOOST_TEST_MESSAGE("io_uring is not available, skipping");
+    return;
+  }
+
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+  size_t nCallbacks = 0;
+  {
+    IoUringEngine engine(2);
+    // one receive in the kernel, more queued than the ring holds
+    engine.asyncReceive(fds[1], 2048, [&] (int, Wire&) { ++nCallbacks; });
+    engine.submit();
+    for (int i = 0; i < 3; ++i) {
+      engine.asyncReceive(fds[1], 2048, [&] (int, Wire&) { ++nCallbacks; });
+    }
+    BOOST_CHECK_EQUAL(engine.getInFlight(), 4);
+  }
+  BOOST_CHECK_EQUAL(nCallbacks, 0);
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
+
+#endif // NDN_CXX_HAVE_IO_URING
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TESTS_MAKE_DATA_HPP
+#define NDN_TESTS_MAKE_DATA_HPP
+
+#include "encoding/wire_test.hpp"
+
+#include <string>
+#include <vector>
+
+namespace ndn {
+namespace tests {
+
+/** @brief Encode the Name TLV of a single component holding the decimal digits of @p seq
+ */
+inline std::vector<uint8_t>
+makeName(uint32_t seq)
+{
+  std::string component = std::to_string(seq);
+  std::vector<uint8_t> name = {0x07, static_cast<uint8_t>(component.size() + 2),
+                               0x08, static_cast<uint8_t>(component.size())};
+  name.insert(name.end(), component.begin(), component.end());
+  return name;
+}
+
+/** @brief Append a Data packet with Name TLV @p name, Content [@p content, +@p contentSize)
+ *         and the TLVs in @p trailer (e.g. a signature) to @p wire
+ */
+inline void
+appendData(Wire& wire, const std::vector<uint8_t>& name,
+           const uint8_t* content, size_t contentSize,
+           const std::vector<uint8_t>& trailer = std::vector<uint8_t>())
+{
+  size_t dataSize = name.size() + 4 + contentSize + trailer.size();
+  const uint8_t dataHeader[] = {0x06, 0xFD, static_cast<uint8_t>(dataSize >> 8),
+                                static_cast<uint8_t>(dataSize)};
+  const uint8_t contentHeader[] = {0x15, 0xFD, static_cast<uint8_t>(contentSize >> 8),
+                                   static_cast<uint8_t>(contentSize)};
+  wire.appendArray(dataHeader, sizeof(dataHeader));
+  wire.appendArray(name.data(), name.size());
+  wire.appendArray(contentHeader, sizeof(contentHeader));
+  wire.appendArray(content, contentSize);
+  if (!trailer.empty()) {
+    wire.appendArray(trailer.data(), trailer.size());
+  }
+}
+
+/** @brief Make a Data packet named makeName(@p seq) whose @p contentSize content bytes are
+ *         all @p seq + @p fill
+ *
+ *  The Wire starts with a block of @p capacity bytes, so by default the packet spans
+ *  several blocks.
+ */
+inline Wire
+makeData(uint32_t seq, size_t contentSize, uint8_t fill = 0, size_t capacity = 64)
+{
+  std::vector<uint8_t> content(contentSize, static_cast<uint8_t>(seq + fill));
+  Wire wire(capacity);
+  appendData(wire, makeName(seq), content.data(), content.size());
+  return wire;
+}
+
+} // namespace tests
+} // namespace ndn
+
+#endif // NDN_TESTS_MAKE_DATA_HPP
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_TESTS_MAKE_SIGNED_DATA_HPP
+#define NDN_TESTS_MAKE_SIGNED_DATA_HPP
+
+#include "encoding/signing-encoder.hpp"
+
+#include "boost-test.hpp"
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+
+namespace ndn {
+namespace tests {
+
+/** @brief Generate a key pair of type @p type: RSA keys have 2048 bits, EC keys are on P-256
+ */
+inline shared_ptr<EVP_PKEY>
+generateKey(int type)
+{
+  EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_id(type, nullptr);
+  BOOST_REQUIRE(context != nullptr);
+  BOOST_REQUIRE_EQUAL(EVP_PKEY_keygen_init(context), 1);
+  if (type == EVP_PKEY_RSA)
+    EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048);
+  else if (type == EVP_PKEY_EC)
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(context, NID_X9_62_prime256v1);
+
+  EVP_PKEY* key = nullptr;
+  BOOST_REQUIRE_EQUAL(EVP_PKEY_keygen(context, &key), 1);
+  EVP_PKEY_CTX_free(context);
+  return shared_ptr<EVP_PKEY>(key, &EVP_PKEY_free);
+}
+
+inline shared_ptr<EVP_PKEY>
+generateEcKey()
+{
+  return generateKey(EVP_PKEY_EC);
+}
+
+/** @brief Encode a Data packet with Name TLV @p name and Content @p content signed by
+ *         @p signer, with a KeyLocator if @p keyName is set
+ *
+ *  The Content value is a block of its own, so the signed portion spans several blocks.
+ */
+inline unique_ptr<Wire>
+makeSignedData(Signer& signer, const std::vector<uint8_t>& name,
+               const std::vector<uint8_t>& content, const Wire* keyName = nullptr)
+{
+  unique_ptr<Wire> data = make_unique<Wire>(64);
+  encoding::SigningEncoder encoder(*data, signer);
+  encoder.append(name.data(), name.size());
+  encoder.appendTlvHeader<tlv::Content>(content.size());
+  encoder.appendBlock(BlockN(make_shared<Buffer>(content.begin(), content.end())));
+  encoder.appendSignatureInfo(keyName);
+  encoder.finish();
+  return data;
+}
+
+/** @brief Encode a Data packet named /data/<number> whose Content is @p number
+ */
+inline unique_ptr<Wire>
+makeSignedData(Signer& signer, uint8_t number, const Wire* keyName = nullptr)
+{
+  return makeSignedData(signer, {0x07, 0x09, 0x08, 0x04, 'd', 'a', 't', 'a', 0x08, 0x01, number},
+                        {number}, keyName);
+}
+
+} // namespace tests
+} // namespace ndn
+
+#endif // NDN_TESTS_MAKE_SIGNED_DATA_HPP
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "mapped-file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+
+/** @brief One mapping of the file, unmapped when the last segment referring to it is gone
+ */
+class MappedFile::Window : noncopyable
+{
+public:
+  Window(uint8_t* address, uint64_t offset, size_t length,
+         const shared_ptr<std::atomic<uint64_t>>& nLiveMappings)
+    : address(address)
+    , offset(offset)
+    , length(length)
+    , m_nLiveMappings(nLiveMappings)
+  {
+    ++*m_nLiveMappings;
+  }
+
+  ~Window()
+  {
+    ::munmap(address, length);
+    --*m_nLiveMappings;
+  }
+
+public:
+  uint8_t* const address;
+  const uint64_t offset; ///< file offset of address
+  const size_t length;
+
+private:
+  shared_ptr<std::atomic<uint64_t>> m_nLiveMappings;
+};
+
+static size_t
+getPageSize()
+{
+  static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return pageSize;
+}
+
+static int
+toMadvice(MappedFile::Advice advice)
+{
+  switch (advice) {
+  case MappedFile::ADVICE_SEQUENTIAL:
+    return MADV_SEQUENTIAL;
+  case MappedFile::ADVICE_RANDOM:
+    return MADV_RANDOM;
+  default:
+    return MADV_NORMAL;
+  }
+}
+
+/** @brief Advise the pages holding [@p begin, @p begin + @p length) as needed soon
+ */
+static void
+adviseWillNeed(const uint8_t* begin, size_t length)
+{
+  uintptr_t first = reinterpret_cast<uintptr_t>(begin) & ~static_cast<uintptr_t>(getPageSize() - 1);
+  uintptr_t last = reinterpret_cast<uintptr_t>(begin) + length;
+  if (length > 0)
+    ::madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+}
+
+MappedFile::MappedFile(const std::string& path, const Options& options)
+  : m_size(0)
+  , m_options(options)
+  , m_nSegments(0)
+  , m_nWindowHits(0)
+  , m_nWindowMisses(0)
+  , m_nSpanningMappings(0)
+  , m_nLiveMappings(make_shared<std::atomic<uint64_t>>(0))
+{
+  size_t pageSize = getPageSize();
+  m_options.windowSize = std::max(pageSize, (m_options.windowSize + pageSize - 1) & ~(pageSize - 1));
+
+  m_fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+  if (m_fd < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot open " + path + ": " + std::string(std::strerror(errno))));
+
+  struct stat status;
+  if (::fstat(m_fd, &status) < 0) {
+    int error = errno;
+    ::close(m_fd);
+    BOOST_THROW_EXCEPTION(Error("Cannot stat " + path + ": " + std::string(std::strerror(error))));
+  }
+  m_size = static_cast<uint64_t>(status.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+  // mappings stay valid after the descriptor is closed
+  ::close(m_fd);
+}
+
+uint64_t
+MappedFile::refresh()
+{
+  struct stat status;
+  if (::fstat(m_fd, &status) < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot stat file: " + std::string(std::strerror(errno))));
+  uint64_t size = static_cast<uint64_t>(status.st_size);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (size > m_size && m_size % m_options.windowSize != 0) {
+    auto found = m_windowIndex.find(m_size / m_options.windowSize);
+    if (found != m_windowIndex.end()) {
+      m_windows.erase(found->second);
+      m_windowIndex.erase(found);
+    }
+  }
+  m_size = std::max<uint64_t>(m_size, size);
+  return m_size;
+}
+
+ConstBufferPtr
+MappedFile::getSegment(uint64_t offset, size_t length)
+{
+  uint64_t size = m_size;
+  if (offset > size || length > size - offset)
+    BOOST_THROW_EXCEPTION(Error("Segment is outside the file"));
+
+  if (length == 0)
+    return make_shared<Buffer>();
+
+  shared_ptr<Window> window;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t index = offset / m_options.windowSize;
+    if (index == (offset + length - 1) / m_options.windowSize) {
+      window = findWindow(index);
+    }
+    else {
+      uint64_t begin = offset & ~static_cast<uint64_t>(getPageSize() - 1);
+      window = mapRange(begin, offset + length - begin);
+      ++m_nSpanningMappings;
+    }
+    ++m_nSegments;
+  }
+
+  const uint8_t* data = window->address + (offset - window->offset);
+  if (m_options.readAheadSize > 0) {
+    size_t remaining = window->length - (offset + length - window->offset);
+    adviseWillNeed(data + length, std::min(remaining, m_options.readAheadSize));
+  }
+
+  // the release callback owns the window, so the mapping lives as long as the buffer
+  return make_shared<ExternalBuffer>(data, length, [window] {});
+}
+
+BlockN
+MappedFile::getBlock(uint64_t offset, size_t length)
+{
+  return BlockN(getSegment(offset, length));
+}
+
+void
+MappedFile::willNeed(uint64_t offset, size_t length)
+{
+  if (offset >= m_size || length == 0)
+    return;
+
+  shared_ptr<Window> window;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    window = findWindow(offset / m_options.windowSize);
+  }
+  size_t remaining = window->length - (offset - window->offset);
+  adviseWillNeed(window->address + (offset - window->offset), std::min<uint64_t>(remaining, length));
+}
+
+shared_ptr<MappedFile::Window>
+MappedFile::findWindow(uint64_t index)
+{
+  auto found = m_windowIndex.find(index);
+  if (found != m_windowIndex.end()) {
+    m_windows.splice(m_windows.begin(), m_windows, found->second);
+    ++m_nWindowHits;
+    return found->second->second;
+  }
+
+  uint64_t begin = index * m_options.windowSize;
+  shared_ptr<Window> window = mapRange(begin, std::min<uint64_t>(m_options.windowSize,
+                                                                 m_size.load() - begin));
+  ++m_nWindowMisses;
+  if (m_options.maxCachedWindows == 0)
+    return window;
+
+  m_windows.emplace_front(index, window);
+  m_windowIndex[index] = m_windows.begin();
+  if (m_windows.size() > m_options.maxCachedWindows) {
+    m_windowIndex.erase(m_windows.back().first);
+    m_windows.pop_back();
+  }
+  return window;
+}
+
+shared_ptr<MappedFile::Window>
+MappedFile::mapRange(uint64_t begin, size_t length)
+{
+  void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, m_fd, static_cast<off_t>(begin));
+  if (address == MAP_FAILED)
+    BOOST_THROW_EXCEPTION(Error("Cannot map file: " + std::string(std::strerror(errno))));
+
+  ::madvise(address, length, toMadvice(m_options.advice));
+  return make_shared<Window>(static_cast<uint8_t*>(address), begin, length, m_nLiveMappings);
+}
+
+MappedFile::Statistics
+MappedFile::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Statistics stats;
+  stats.nSegments = m_nSegments;
+  stats.nWindowHits = m_nWindowHits;
+  stats.nWindowMisses = m_nWindowMisses;
+  stats.nSpanningMappings = m_nSpanningMappings;
+  stats.nCachedWindows = m_windows.size();
+  stats.nLiveMappings = *m_nLiveMappings;
+  return stats;
+}
+
+} // namespace ndn
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_MAPPED_FILE_HPP
+#define NDN_ENCODING_MAPPED_FILE_HPP
+
+#include "block_test.hpp"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace ndn {
+
+/** @brief Read-only file whose byte ranges become Buffer segments without copying
+ *
+ *  The file is mapped in windows of Options::windowSize bytes, and a segment is an
+ *  ExternalBuffer pointing into a window.  Every segment keeps its window mapped, so a packet
+ *  whose Content is a file segment stays valid as long as it is referenced, even after the
+ *  MappedFile is destroyed.  A Data packet can then be a small encoded header block followed by
+ *  the file segment, see Wire::appendSharedBlock.
+ *
+ *  Up to Options::maxCachedWindows recently used windows stay mapped for new segments; an
+ *  evicted window is unmapped once its last segment is gone.  Since segments taken from the same
+ *  window share one mapping, the number of mappings is bounded by the cache size plus the
+ *  windows still referenced by live packets, rather than by the number of segments, which keeps
+ *  the process well below vm.max_map_count.  A range crossing a window boundary gets a mapping
+ *  of its own.
+ *
+ *  A file that is appended to, e.g. a log, can be read further after refresh().  The file must
+ *  not be truncated while segments are in use.
+ */
+class MappedFile : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /** @brief Expected access pattern, passed to madvise for every window
+   */
+  enum Advice {
+    ADVICE_NORMAL,
+    ADVICE_SEQUENTIAL,
+    ADVICE_RANDOM
+  };
+
+  struct Options
+  {
+    Options()
+      : windowSize(16 * 1024 * 1024)
+      , maxCachedWindows(16)
+      , advice(ADVICE_SEQUENTIAL)
+      , readAheadSize(1024 * 1024)
+    {
+    }
+
+    size_t windowSize;       ///< bytes per window, rounded up to a multiple of the page size
+    size_t maxCachedWindows; ///< windows kept mapped while no segment refers to them
+    Advice advice;
+    size_t readAheadSize;    ///< bytes after each segment requested with MADV_WILLNEED, 0 to disable
+  };
+
+  /** @brief Snapshot of mapping counters
+   */
+  struct Statistics
+  {
+    uint64_t nSegments;         ///< segments handed out
+    uint64_t nWindowHits;       ///< segments served from a cached window
+    uint64_t nWindowMisses;     ///< windows mapped
+    uint64_t nSpanningMappings; ///< mappings made for ranges crossing a window boundary
+    size_t nCachedWindows;
+    uint64_t nLiveMappings;     ///< mappings not yet unmapped, cached or referenced by segments
+  };
+
+  /** @brief Open @p path for reading
+   *  @throw Error the file cannot be opened
+   */
+  explicit
+  MappedFile(const std::string& path, const Options& options = Options());
+
+  ~MappedFile();
+
+  uint64_t
+  size() const
+  {
+    return m_size;
+  }
+
+  /** @brief Extend size() to the bytes appended to the file since it was opened
+   *
+   *  A cached window that ends at the previous end of the file is dropped, so it is mapped
+   *  in full when used next; segments taken from it stay valid.
+   *  @return the new size
+   *  @throw Error the file cannot be stat'ed
+   */
+  uint64_t
+  refresh();
+
+  /** @brief Return a buffer over the @p length bytes at @p offset of the file
+   *  @throw Error the range is outside the file, or it cannot be mapped
+   */
+  ConstBufferPtr
+  getSegment(uint64_t offset, size_t length);
+
+  /** @brief Return a block over the @p length bytes at @p offset of the file
+   *  @throw Error the range is outside the file, or it cannot be mapped
+   */
+  BlockN
+  getBlock(uint64_t offset, size_t length);
+
+  /** @brief Ask the kernel to read the @p length bytes at @p offset ahead of use
+   *
+   *  Only the part within a single window is advised, and the window is mapped if needed.
+   */
+  void
+  willNeed(uint64_t offset, size_t length);
+
+  Statistics
+  getStatistics() const;
+
+private:
+  class Window;
+
+  shared_ptr<Window>
+  findWindow(uint64_t index);
+
+  shared_ptr<Window>
+  mapRange(uint64_t begin, size_t length);
+
+private:
+  int m_fd;
+  std::atomic<uint64_t> m_size;
+  Options m_options;
+
+  mutable std::mutex m_mutex;
+  typedef std::list<std::pair<uint64_t, shared_ptr<Window>>> WindowList;
+  WindowList m_windows; // most recently used first
+  std::unordered_map<uint64_t, WindowList::iterator> m_windowIndex;
+
+  uint64_t m_nSegments;
+  uint64_t m_nWindowHits;
+  uint64_t m_nWindowMisses;
+  uint64_t m_nSpanningMappings;
+  shared_ptr<std::atomic<uint64_t>> m_nLiveMappings; // shared with windows outliving the file
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_MAPPED_FILE_HPP
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/mapped-file.hpp"
+#include "encoding/wire_test.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace ndn {
+namespace tests {
+
+class MappedFileFixture
+{
+protected:
+  MappedFileFixture()
+    : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path())
+    , bytes(3 * 8192 + 100)
+  {
+    for (size_t i = 0; i < bytes.size(); ++i) {
+      bytes[i] = static_cast<uint8_t>(i * 13);
+    }
+    std::ofstream os(path.string(), std::ios::binary);
+    os.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+  ~MappedFileFixture()
+  {
+    boost::filesystem::remove(path);
+  }
+
+  static MappedFile::Options
+  makeOptions()
+  {
+    MappedFile::Options options;
+    options.windowSize = 8192;
+    options.maxCachedWindows = 1;
+    options.readAheadSize = 4096;
+    return options;
+  }
+
+protected:
+  boost::filesystem::path path;
+  std::vector<uint8_t> bytes;
+};
+
+BOOST_FIXTURE_TEST_SUITE(EncodingMappedFile, MappedFileFixture)
+
+BOOST_AUTO_TEST_CASE(Segments)
+{
+  MappedFile file(path.string(), makeOptions());
+  BOOST_CHECK_EQUAL(file.size(), bytes.size());
+
+  ConstBufferPtr first = file.getSegment(100, 1000);
+  BOOST_CHECK_EQUAL_COLLECTIONS(first->begin(), first->end(),
+                                bytes.begin() + 100, bytes.begin() + 1100);
+  ConstBufferPtr second = file.getSegment(5000, 3000);
+  BOOST_CHECK_EQUAL_COLLECTIONS(second->begin(), second->end(),
+                                bytes.begin() + 5000, bytes.begin() + 8000);
+
+  // crosses the boundary between the second and third windows
+  ConstBufferPtr spanning = file.getSegment(16000, 500);
+  BOOST_CHECK_EQUAL_COLLECTIONS(spanning->begin(), spanning->end(),
+                                bytes.begin() + 16000, bytes.begin() + 16500);
+
+  ConstBufferPtr last = file.getSegment(3 * 8192, 100);
+  BOOST_CHECK_EQUAL_COLLECTIONS(last->begin(), last->end(),
+                                bytes.begin() + 3 * 8192, bytes.end());
+  BOOST_CHECK_EQUAL(file.getSegment(bytes.size(), 0)->size(), 0);
+
+  BOOST_CHECK_THROW(file.getSegment(bytes.size() - 10, 11), MappedFile::Error);
+  BOOST_CHECK_THROW(file.getSegment(bytes.size() + 1, 0), MappedFile::Error);
+
+  MappedFile::Statistics stats = file.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nSegments, 4);
+  BOOST_CHECK_EQUAL(stats.nWindowHits, 1);
+  BOOST_CHECK_EQUAL(stats.nWindowMisses, 2);
+  BOOST_CHECK_EQUAL(stats.nSpanningMappings, 1);
+  BOOST_CHECK_EQUAL(stats.nCachedWindows, 1);
+  BOOST_CHECK_EQUAL(stats.nLiveMappings, 3);
+}
+
+BOOST_AUTO_TEST_CASE(Lifetime)
+{
+  ConstBufferPtr segment;
+  {
+    MappedFile file(path.string(), makeOptions());
+    segment = file.getSegment(9000, 200);
+    file.getSegment(20000, 200);
+    BOOST_CHECK_EQUAL(file.getStatistics().nLiveMappings, 2);
+
+    // the evicted window is unmapped as soon as its segment is gone
+    file.getSegment(100, 200);
+    BOOST_CHECK_EQUAL(file.getStatistics().nLiveMappings, 2);
+  }
+
+  // the segment outlives the file
+  BOOST_CHECK_EQUAL_COLLECTIONS(segment->begin(), segment->end(),
+                                bytes.begin() + 9000, bytes.begin() + 9200);
+}
+
+BOOST_AUTO_TEST_CASE(WireLifetime)
+{
+  MappedFile file(path.string(), makeOptions());
+  const uint8_t header[] = {0x15, 0x81, 0xC8};
+  {
+    unique_ptr<Wire> packet = make_unique<Wire>(64);
+    packet->appendArray(header, sizeof(header));
+    packet->appendSharedBlock(file.getBlock(9000, 200));
+    Wire copy(*packet);
+
+    // the window of the packets is evicted from the cache but stays mapped for them
+    file.getSegment(20000, 200);
+    BOOST_CHECK_EQUAL(file.getStatistics().nLiveMappings, 2);
+
+    packet.reset();
+    BOOST_CHECK_EQUAL(file.getStatistics().nLiveMappings, 2);
+    BOOST_CHECK_EQUAL(copy.readUint8(sizeof(header) + 199), bytes[9199]);
+  }
+
+  // destroying the last wire unmaps the window
+  BOOST_CHECK_EQUAL(file.getStatistics().nLiveMappings, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Refresh)
+{
+  MappedFile file(path.string(), makeOptions());
+  ConstBufferPtr tail = file.getSegment(bytes.size() - 50, 50);
+
+  std::vector<uint8_t> appended(500, 0xEE);
+  {
+    std::ofstream os(path.string(), std::ios::binary | std::ios::app);
+    os.write(reinterpret_cast<const char*>(appended.data()), appended.size());
+  }
+  BOOST_CHECK_THROW(file.getSegment(bytes.size(), 500), MappedFile::Error);
+  BOOST_CHECK_EQUAL(file.refresh(), bytes.size() + 500);
+  BOOST_CHECK_EQUAL(file.size(), bytes.size() + 500);
+
+  // the window ending at the old end of the file is mapped again in full
+  ConstBufferPtr across = file.getSegment(bytes.size() - 50, 550);
+  BOOST_CHECK_EQUAL_COLLECTIONS(across->begin(), across->begin() + 50,
+                                bytes.end() - 50, bytes.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(across->begin() + 50, across->end(),
+                                appended.begin(), appended.end());
+  BOOST_CHECK_EQUAL(file.getStatistics().nWindowMisses, 2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(tail->begin(), tail->end(), bytes.end() - 50, bytes.end());
+}
+
+BOOST_AUTO_TEST_CASE(DataPacket)
+{
+  MappedFile file(path.string(), makeOptions());
+
+  // Data header, Name and Content header encoded in memory, Content value from the file
+  const uint8_t header[] = {0x06, 0xFD, 0x07, 0xDE,
+                            0x07, 0x03, 0x08, 0x01, 'f',
+                            0x15, 0xFD, 0x07, 0xD0};
+  Wire packet(64);
+  packet.appendArray(header, sizeof(header));
+  packet.appendSharedBlock(file.getBlock(1000, 2000));
+
+  Wire expected(4096);
+  expected.appendArray(header, sizeof(header));
+  expected.appendArray(bytes.data() + 1000, 2000);
+  BOOST_CHECK_EQUAL(packet.size(), sizeof(header) + 2000);
+  BOOST_CHECK(packet == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "name-prefix-hashes.hpp"
+#include "fast-hash.hpp"
+
+#include <cstring>
+
+namespace ndn {
+
+/** @brief Sequential reader over a contiguous range, or over consecutive blocks of a Wire
+ */
+class NamePrefixHashes::Cursor
+{
+public:
+  Cursor(const uint8_t* begin, const uint8_t* end)
+    : m_block(nullptr)
+    , m_position(begin)
+    , m_end(end)
+    , m_remaining(end - begin)
+    , m_consumed(0)
+  {
+  }
+
+  Cursor(const BlockN* block, const uint8_t* position, size_t remaining)
+    : m_block(block)
+    , m_position(position)
+    , m_end(block->begin() + block->size())
+    , m_remaining(remaining)
+    , m_consumed(0)
+  {
+  }
+
+  size_t
+  remaining() const
+  {
+    return m_remaining;
+  }
+
+  /** @brief Return the number of bytes read so far
+   */
+  size_t
+  consumed() const
+  {
+    return m_consumed;
+  }
+
+  /** @brief Stop @p length bytes from the current position
+   */
+  void
+  limit(size_t length)
+  {
+    m_remaining = length;
+  }
+
+  bool
+  readVarNumber(uint64_t& number)
+  {
+    uint8_t bytes[9];
+    if (!read(bytes, 1))
+      return false;
+
+    size_t length = bytes[0] < 253 ? 0 : size_t(1) << (bytes[0] - 252);
+    if (!read(bytes + 1, length))
+      return false;
+
+    number = length == 0 ? bytes[0] : 0;
+    for (size_t i = 1; i <= length; ++i) {
+      number = (number << 8) | bytes[i];
+    }
+    return true;
+  }
+
+  bool
+  read(uint8_t* output, size_t length)
+  {
+    return consume(length, [&output] (const uint8_t* data, size_t size) {
+      std::memcpy(output, data, size);
+      output += size;
+    });
+  }
+
+  /** @brief Pass the next @p length bytes to @p sink, one contiguous piece at a time
+   */
+  template<typename Sink>
+  bool
+  consume(size_t length, const Sink& sink)
+  {
+    if (length > m_remaining)
+      return false;
+
+    m_remaining -= length;
+    m_consumed += length;
+    while (length > 0) {
+      if (m_position == m_end) {
+        m_block = m_block != nullptr ? m_block->next() : nullptr;
+        if (m_block == nullptr)
+          return false;
+        m_position = m_block->begin();
+        m_end = m_position + m_block->size();
+        continue;
+      }
+      size_t size = std::min<size_t>(length, m_end - m_position);
+      sink(m_position, size);
+      m_position += size;
+      length -= size;
+    }
+    return true;
+  }
+
+private:
+  const BlockN* m_block;
+  const uint8_t* m_position;
+  const uint8_t* m_end;
+  size_t m_remaining;
+  size_t m_consumed;
+};
+
+void
+NamePrefixHashes::compute(const uint8_t* begin, const uint8_t* end, uint64_t seed)
+{
+  Cursor cursor(begin, end);
+  compute(cursor, seed);
+}
+
+void
+NamePrefixHashes::compute(const Wire& wire, size_t offset, uint64_t seed)
+{
+  if (offset >= wire.size())
+    BOOST_THROW_EXCEPTION(Error("Name is outside the wire"));
+
+  BlockN::const_iterator position;
+  const BlockN* block = wire.findPosition(position, offset);
+  Cursor cursor(block, position, wire.size() - offset);
+  compute(cursor, seed);
+}
+
+/** @brief Mix @p value into @p hash, with the avalanche of the XXH64 finalizer
+ */
+static uint64_t
+combine(uint64_t hash, uint64_t value)
+{
+  hash ^= value * UINT64_C(0xC2B2AE3D27D4EB4F);
+  hash ^= hash >> 33;
+  hash *= UINT64_C(0x165667B19E3779F9);
+  hash ^= hash >> 29;
+  return hash;
+}
+
+void
+NamePrefixHashes::compute(Cursor& cursor, uint64_t seed)
+{
+  m_hashes.clear();
+  m_offsets.clear();
+  m_hasImplicitDigest = false;
+
+  uint64_t type = 0;
+  uint64_t length = 0;
+  if (!cursor.readVarNumber(type) || type != tlv::Name || !cursor.readVarNumber(length) ||
+      length > cursor.remaining())
+    BOOST_THROW_EXCEPTION(Error("Not a Name"));
+  size_t nameEnd = cursor.consumed() + length;
+  cursor.limit(length);
+
+  FastHash hash(seed);
+  m_hashes.push_back(hash.digest());
+  m_offsets.push_back(cursor.consumed());
+  while (cursor.remaining() > 0) {
+    if (!cursor.readVarNumber(type) || !cursor.readVarNumber(length) ||
+        length > cursor.remaining())
+      BOOST_THROW_EXCEPTION(Error("Malformed name component"));
+
+    if (type == tlv::ImplicitSha256DigestComponent) {
+      uint8_t digest[32];
+      if (length != sizeof(digest) || cursor.remaining() != sizeof(digest))
+        BOOST_THROW_EXCEPTION(Error("ImplicitSha256DigestComponent must be the last component "
+                                    "and have 32 bytes"));
+
+      cursor.read(digest, sizeof(digest));
+      uint64_t value;
+      std::memcpy(&value, digest, sizeof(value));
+      m_hashes.push_back(combine(m_hashes.back(), value));
+      m_offsets.push_back(nameEnd);
+      m_hasImplicitDigest = true;
+      break;
+    }
+
+    // the header is hashed in its shortest encoding, the value where it lies
+    uint8_t header[18];
+    uint8_t* headerEnd = tlv::writeVarNumber(tlv::writeVarNumber(header, type), length);
+    hash.update(header, headerEnd - header);
+    cursor.consume(length, [&hash] (const uint8_t* data, size_t size) { hash.update(data, size); });
+    m_hashes.push_back(hash.digest());
+    m_offsets.push_back(cursor.consumed());
+  }
+}
+
+} // namespace ndn
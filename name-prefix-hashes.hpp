@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_NAME_PREFIX_HASHES_HPP
+#define NDN_ENCODING_NAME_PREFIX_HASHES_HPP
+
+#include "wire_test.hpp"
+
+namespace ndn {
+
+/** @brief Hashes of all prefixes of an encoded Name, computed in one pass
+ *
+ *  The hash of the prefix of n components is the FastHash, with a chosen seed, of the
+ *  encoding of these n components, so it does not depend on the rest of the Name and equals
+ *  the hash of the full Name of n components.  The components are walked in their TLV encoding
+ *  and fed to one streaming FastHash, whose digest is taken after each component, so no
+ *  component is decoded or copied.  A Name split across the blocks of a Wire is hashed in
+ *  place.
+ *
+ *  An ImplicitSha256DigestComponent, which must be the last component, is already a
+ *  uniformly distributed SHA-256 digest: instead of being hashed, its first 8 bytes are
+ *  combined with the hash of the preceding prefix.  hasImplicitDigest() tells whether the last
+ *  hash covers such a component, so lookups by name prefix can skip it.
+ *
+ *  An object can be reused for many Names without allocating.
+ */
+class NamePrefixHashes
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : tlv::Error(what)
+    {
+    }
+  };
+
+  NamePrefixHashes()
+    : m_hasImplicitDigest(false)
+  {
+  }
+
+  /** @brief Hash the Name TLV in [@p begin, @p end)
+   *  @throw Error the bytes are not a well-formed Name
+   */
+  void
+  compute(const uint8_t* begin, const uint8_t* end, uint64_t seed = 0);
+
+  /** @brief Hash the Name TLV at offset @p offset of @p wire
+   *  @throw Error the bytes are not a well-formed Name
+   */
+  void
+  compute(const Wire& wire, size_t offset = 0, uint64_t seed = 0);
+
+  /** @brief Return the number of components, the longest prefix
+   */
+  size_t
+  size() const
+  {
+    return m_hashes.empty() ? 0 : m_hashes.size() - 1;
+  }
+
+  /** @brief Return the hash of the prefix of @p nComponents components, from 0 to size()
+   */
+  uint64_t
+  operator[](size_t nComponents) const
+  {
+    return m_hashes[nComponents];
+  }
+
+  /** @brief Return the offset, from the start of the Name TLV, of the end of the first
+   *         @p nComponents components
+   *
+   *  getPrefixOffset(0) is where the first component starts.
+   */
+  size_t
+  getPrefixOffset(size_t nComponents) const
+  {
+    return m_offsets[nComponents];
+  }
+
+  bool
+  hasImplicitDigest() const
+  {
+    return m_hasImplicitDigest;
+  }
+
+private:
+  class Cursor;
+
+  void
+  compute(Cursor& cursor, uint64_t seed);
+
+private:
+  std::vector<uint64_t> m_hashes;
+  std::vector<size_t> m_offsets;
+  bool m_hasImplicitDigest;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_NAME_PREFIX_HASHES_HPP
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/name-prefix-hashes.hpp"
+#include "encoding/fast-hash.hpp"
+
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingNamePrefixHashes)
+
+// /ndn/edu/ucla/%00%01, with a component longer than 252 bytes
+static std::vector<uint8_t>
+makeName()
+{
+  std::vector<uint8_t> name = {0x07, 0xFD, 0x01, 0x14,
+                               0x08, 0x03, 'n', 'd', 'n',
+                               0x08, 0x03, 'e', 'd', 'u',
+                               0x08, 0x04, 'u', 'c', 'l', 'a',
+                               0x08, 0xFD, 0x01, 0x00};
+  for (size_t i = 0; i < 256; ++i) {
+    name.push_back(static_cast<uint8_t>(i));
+  }
+  return name;
+}
+
+BOOST_AUTO_TEST_CASE(Contiguous)
+{
+  std::vector<uint8_t> name = makeName();
+  NamePrefixHashes hashes;
+  hashes.compute(name.data(), name.data() + name.size());
+  BOOST_REQUIRE_EQUAL(hashes.size(), 4);
+  BOOST_CHECK(!hashes.hasImplicitDigest());
+
+  // each prefix hash covers the encoding of its components
+  BOOST_CHECK_EQUAL(hashes[0], FastHash::compute(nullptr, 0));
+  BOOST_CHECK_EQUAL(hashes[1], FastHash::compute(name.data() + 4, 5));
+  BOOST_CHECK_EQUAL(hashes[3], FastHash::compute(name.data() + 4, 16));
+  BOOST_CHECK_EQUAL(hashes[4], FastHash::compute(name.data() + 4, name.size() - 4));
+  BOOST_CHECK_EQUAL(hashes.getPrefixOffset(0), 4);
+  BOOST_CHECK_EQUAL(hashes.getPrefixOffset(2), 14);
+  BOOST_CHECK_EQUAL(hashes.getPrefixOffset(4), name.size());
+
+  // and equals the hash of the shorter name
+  const uint8_t prefix[] = {0x07, 0x0A, 0x08, 0x03, 'n', 'd', 'n', 0x08, 0x03, 'e', 'd', 'u'};
+  NamePrefixHashes prefixHashes;
+  prefixHashes.compute(prefix, prefix + sizeof(prefix));
+  BOOST_CHECK_EQUAL(prefixHashes.size(), 2);
+  BOOST_CHECK_EQUAL(prefixHashes[2], hashes[2]);
+
+  NamePrefixHashes seeded;
+  seeded.compute(name.data(), name.data() + name.size(), 42);
+  BOOST_CHECK_NE(seeded[4], hashes[4]);
+}
+
+BOOST_AUTO_TEST_CASE(SplitAcrossBlocks)
+{
+  std::vector<uint8_t> name = makeName();
+  NamePrefixHashes expected;
+  expected.compute(name.data(), name.data() + name.size());
+
+  const uint8_t header[] = {0x06, 0xFD, 0x01, 0x1F};
+  // at split 0 the Name starts in the second block
+  for (size_t split = 0; split < name.size(); split += 7) {
+    Wire wire(sizeof(header) + split);
+    wire.appendArray(header, sizeof(header));
+    wire.appendArray(name.data(), split);
+    wire.appendSharedBlock(BlockN(name.data() + split, name.size() - split));
+
+    NamePrefixHashes hashes;
+    hashes.compute(wire, sizeof(header));
+    BOOST_REQUIRE_EQUAL(hashes.size(), expected.size());
+    for (size_t i = 0; i <= hashes.size(); ++i) {
+      BOOST_CHECK_EQUAL(hashes[i], expected[i]);
+    }
+  }
+
+  // the Name is inside the block the wire is currently writing to
+  const uint8_t filler[] = {0x0A, 0x00};
+  Wire wire(sizeof(header));
+  wire.appendArray(header, sizeof(header));
+  wire.appendArray(filler, sizeof(filler));
+  wire.appendArray(name.data(), name.size());
+  NamePrefixHashes hashes;
+  hashes.compute(wire, sizeof(header) + sizeof(filler));
+  BOOST_CHECK_EQUAL(hashes[4], expected[4]);
+}
+
+BOOST_AUTO_TEST_CASE(ImplicitDigest)
+{
+  std::vector<uint8_t> name = {0x07, 0x27, 0x08, 0x03, 'n', 'd', 'n', 0x01, 0x20};
+  for (uint8_t i = 0; i < 32; ++i) {
+    name.push_back(i * 11);
+  }
+
+  NamePrefixHashes hashes;
+  hashes.compute(name.data(), name.data() + name.size());
+  BOOST_CHECK_EQUAL(hashes.size(), 2);
+  BOOST_CHECK(hashes.hasImplicitDigest());
+  BOOST_CHECK_EQUAL(hashes[1], FastHash::compute(name.data() + 2, 5));
+  BOOST_CHECK_NE(hashes[2], hashes[1]);
+
+  name[8] = 0x10; // 16-byte digest
+  name[1] = 0x17;
+  name.resize(name.size() - 16);
+  BOOST_CHECK_THROW(hashes.compute(name.data(), name.data() + name.size()),
+                    NamePrefixHashes::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  NamePrefixHashes hashes;
+  const uint8_t notName[] = {0x08, 0x01, 'a'};
+  BOOST_CHECK_THROW(hashes.compute(notName, notName + sizeof(notName)), NamePrefixHashes::Error);
+  const uint8_t truncated[] = {0x07, 0x05, 0x08, 0x04, 'a'};
+  BOOST_CHECK_THROW(hashes.compute(truncated, truncated + sizeof(truncated)),
+                    NamePrefixHashes::Error);
+  const uint8_t overlong[] = {0x07, 0x03, 0x08, 0x02, 'a', 'b'};
+  BOOST_CHECK_THROW(hashes.compute(overlong, overlong + sizeof(overlong)), NamePrefixHashes::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
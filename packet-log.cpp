@@ -0,0 +1,787 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "packet-log.hpp"
+#include "fast-hash.hpp"
+
+#include <boost/asio/buffer.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+
+const size_t PacketLog::MAX_LOG_FILES;
+
+struct PacketLog::IndexHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t isClean;
+  uint64_t nSlots;
+  uint64_t nPackets;
+  uint64_t nTombstones;   ///< removed slots, not records
+  uint64_t nextLogId;
+  uint32_t activeFile;
+  uint32_t reserved[3];
+};
+
+struct PacketLog::LogFile
+{
+  uint64_t id;             ///< name of the log file, 0 if the entry is unused
+  uint64_t size;           ///< committed bytes, anything after them is a torn append
+  uint64_t liveBytes;      ///< bytes of records the index refers to, and of tombstones
+  uint64_t tombstoneBytes;
+};
+
+struct PacketLog::Slot
+{
+  uint64_t hash;
+  uint64_t offset;
+  uint32_t file;
+  uint32_t length;
+};
+
+static const char INDEX_MAGIC[8] = {'N', 'D', 'N', 'P', 'K', 'L', 'O', 'G'};
+static const uint32_t INDEX_VERSION = 1;
+
+// slot hashes below 2 are reserved
+static const uint64_t EMPTY_SLOT = 0;
+static const uint64_t REMOVED_SLOT = 1;
+
+static uint64_t
+hashName(const uint8_t* name, size_t size)
+{
+  uint64_t hash = FastHash::compute(name, size);
+  return hash <= REMOVED_SLOT ? hash + 2 : hash;
+}
+
+// index layout: IndexHeader, MAX_LOG_FILES LogFile entries, nSlots Slot entries
+static const size_t HEADER_SIZE = 64;
+static const size_t LOG_FILE_SIZE = 32;
+static const size_t SLOT_SIZE = 24;
+static const size_t SLOTS_OFFSET = HEADER_SIZE + LOG_FILE_SIZE * PacketLog::MAX_LOG_FILES;
+
+static size_t
+getIndexSize(uint64_t nSlots)
+{
+  return SLOTS_OFFSET + SLOT_SIZE * nSlots;
+}
+
+/** @brief Parse the record at [@p begin, @p end): a Data packet or a tombstone Name
+ *  @return false if the bytes do not hold a complete record
+ */
+static bool
+parseRecord(const uint8_t* begin, const uint8_t* end,
+            uint32_t& type, size_t& recordSize, const uint8_t*& name, size_t& nameSize)
+{
+  const uint8_t* position = begin;
+  uint64_t length = 0;
+  if (!tlv::readType(position, end, type) || !tlv::readVarNumber(position, end, length) ||
+      length > static_cast<uint64_t>(end - position))
+    return false;
+  recordSize = (position - begin) + length;
+
+  if (type == tlv::Name) {
+    name = begin;
+    nameSize = recordSize;
+    return true;
+  }
+  if (type != tlv::Data)
+    return false;
+
+  const uint8_t* valueEnd = position + length;
+  uint32_t nameType = 0;
+  name = position;
+  if (!tlv::readType(position, valueEnd, nameType) || nameType != tlv::Name ||
+      !tlv::readVarNumber(position, valueEnd, length) ||
+      length > static_cast<uint64_t>(valueEnd - position))
+    return false;
+  nameSize = (position - name) + length;
+  return true;
+}
+
+static void
+writeAll(int fd, std::vector<iovec>& iov, uint64_t offset)
+{
+  size_t i = 0;
+  while (i < iov.size()) {
+    ssize_t nWritten = ::pwritev(fd, &iov[i], std::min<size_t>(iov.size() - i, IOV_MAX),
+                                 static_cast<off_t>(offset));
+    if (nWritten < 0) {
+      if (errno == EINTR)
+        continue;
+      BOOST_THROW_EXCEPTION(PacketLog::Error("Cannot write log file: " +
+                                             std::string(std::strerror(errno))));
+    }
+
+    offset += nWritten;
+    size_t remaining = static_cast<size_t>(nWritten);
+    while (i < iov.size() && remaining >= iov[i].iov_len) {
+      remaining -= iov[i].iov_len;
+      ++i;
+    }
+    if (remaining > 0) {
+      iov[i].iov_base = static_cast<uint8_t*>(iov[i].iov_base) + remaining;
+      iov[i].iov_len -= remaining;
+    }
+  }
+}
+
+PacketLog::PacketLog(const std::string& directory, const Options& options)
+  : m_directory(directory)
+  , m_options(options)
+  , m_indexFd(-1)
+  , m_index(nullptr)
+  , m_indexSize(0)
+  , m_activeFd(-1)
+  , m_readers(MAX_LOG_FILES)
+  , m_nReaderOpens(0)
+  , m_wasRecovered(false)
+  , m_nCompactions(0)
+  , m_isCompactionRequested(false)
+  , m_isStopping(false)
+{
+  if (::mkdir(m_directory.data(), 0755) < 0 && errno != EEXIST)
+    BOOST_THROW_EXCEPTION(Error("Cannot create " + m_directory + ": " +
+                                std::string(std::strerror(errno))));
+
+  uint64_t nSlots = 1;
+  while (nSlots < std::max<uint64_t>(m_options.initialIndexSize, 16))
+    nSlots <<= 1;
+
+  int fd = ::open((m_directory + "/index").data(), O_RDWR | O_CLOEXEC);
+  if (fd >= 0) {
+    mapIndex(fd);
+  }
+
+  if (m_index != nullptr && m_header->isClean) {
+    // fast path: the index is up to date, only a torn append may follow the committed bytes
+    m_header->isClean = 0;
+    ::msync(m_index, sizeof(IndexHeader), MS_SYNC);
+
+    const LogFile& active = m_files[m_header->activeFile];
+    m_activeFd = ::open(getLogPath(active.id).data(), O_WRONLY | O_CLOEXEC);
+    if (m_activeFd < 0 || ::ftruncate(m_activeFd, static_cast<off_t>(active.size)) < 0)
+      BOOST_THROW_EXCEPTION(Error("Cannot open the current log file: " +
+                                  std::string(std::strerror(errno))));
+  }
+  else {
+    rebuildIndex(m_index != nullptr ? m_header->nSlots : nSlots);
+  }
+
+  for (uint32_t file = 0; file < MAX_LOG_FILES; ++file) {
+    if (isCompactionNeeded(file))
+      m_isCompactionRequested = true;
+  }
+  if (m_options.enableBackgroundCompaction)
+    m_compactionThread = std::thread(&PacketLog::runCompaction, this);
+}
+
+PacketLog::~PacketLog()
+{
+  if (m_compactionThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_isStopping = true;
+    }
+    m_compactionRequested.notify_one();
+    m_compactionThread.join();
+  }
+
+  ::fdatasync(m_activeFd);
+  ::close(m_activeFd);
+  ::msync(m_index, m_indexSize, MS_SYNC);
+  m_header->isClean = 1;
+  ::msync(m_index, sizeof(IndexHeader), MS_SYNC);
+  ::munmap(m_index, m_indexSize);
+  ::close(m_indexFd);
+}
+
+void
+PacketLog::mapIndex(int fd)
+{
+  struct stat status;
+  void* index = MAP_FAILED;
+  if (::fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= getIndexSize(0))
+    index = ::mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  const IndexHeader* header = static_cast<const IndexHeader*>(index);
+  if (index == MAP_FAILED || std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+      header->version != INDEX_VERSION || (header->nSlots & (header->nSlots - 1)) != 0 ||
+      getIndexSize(header->nSlots) != static_cast<size_t>(status.st_size)) {
+    // not an index of this version, rebuilt from the logs
+    if (index != MAP_FAILED)
+      ::munmap(index, status.st_size);
+    ::close(fd);
+    return;
+  }
+
+  static_assert(sizeof(IndexHeader) == HEADER_SIZE && sizeof(LogFile) == LOG_FILE_SIZE &&
+                sizeof(Slot) == SLOT_SIZE, "index entries must keep their on-disk size");
+  m_indexFd = fd;
+  m_index = static_cast<uint8_t*>(index);
+  m_indexSize = status.st_size;
+  m_header = reinterpret_cast<IndexHeader*>(m_index);
+  m_files = reinterpret_cast<LogFile*>(m_index + HEADER_SIZE);
+  m_slots = reinterpret_cast<Slot*>(m_index + SLOTS_OFFSET);
+}
+
+void
+PacketLog::createIndex(const std::string& path, uint64_t nSlots)
+{
+  int fd = ::open(path.data(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(getIndexSize(nSlots))) < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot create index: " + std::string(std::strerror(errno))));
+
+  // the file is sparse, so all slots start empty
+  IndexHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  header.version = INDEX_VERSION;
+  header.nSlots = nSlots;
+  header.nextLogId = 1;
+  if (::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+    BOOST_THROW_EXCEPTION(Error("Cannot create index: " + std::string(std::strerror(errno))));
+
+  mapIndex(fd);
+  if (m_index == nullptr)
+    BOOST_THROW_EXCEPTION(Error("Cannot map index"));
+}
+
+void
+PacketLog::rebuildIndex(uint64_t nSlots)
+{
+  if (m_index != nullptr) {
+    ::munmap(m_index, m_indexSize);
+    ::close(m_indexFd);
+    m_index = nullptr;
+  }
+  createIndex(m_directory + "/index", nSlots);
+
+  std::vector<uint64_t> ids;
+  DIR* directory = ::opendir(m_directory.data());
+  if (directory == nullptr)
+    BOOST_THROW_EXCEPTION(Error("Cannot list " + m_directory));
+  while (const dirent* entry = ::readdir(directory)) {
+    char* end = nullptr;
+    uint64_t id = std::strtoull(entry->d_name, &end, 10);
+    if (id > 0 && end != entry->d_name && std::strcmp(end, ".log") == 0)
+      ids.push_back(id);
+  }
+  ::closedir(directory);
+
+  if (ids.size() > MAX_LOG_FILES)
+    BOOST_THROW_EXCEPTION(Error("Too many log files in " + m_directory));
+  std::sort(ids.begin(), ids.end());
+
+  // later records replace earlier ones, so the logs are replayed oldest first
+  for (uint32_t file = 0; file < ids.size(); ++file) {
+    struct stat status;
+    if (::stat(getLogPath(ids[file]).data(), &status) < 0)
+      BOOST_THROW_EXCEPTION(Error("Cannot stat log file: " + std::string(std::strerror(errno))));
+
+    m_files[file].id = ids[file];
+    m_files[file].size = status.st_size;
+    m_header->nextLogId = ids[file] + 1;
+    replayLogFile(file);
+  }
+
+  if (!ids.empty() && m_files[ids.size() - 1].size < m_options.maxLogFileSize) {
+    m_header->activeFile = ids.size() - 1;
+    m_activeFd = ::open(getLogPath(ids.back()).data(), O_WRONLY | O_CLOEXEC);
+    if (m_activeFd < 0)
+      BOOST_THROW_EXCEPTION(Error("Cannot open log file: " + std::string(std::strerror(errno))));
+  }
+  else {
+    startLogFile();
+  }
+  m_wasRecovered = !ids.empty();
+}
+
+void
+PacketLog::replayLogFile(uint32_t file)
+{
+  LogFile& log = m_files[file];
+  if (log.size == 0)
+    return;
+
+  ConstBufferPtr bytes = getReader(file, log.size)->getSegment(0, log.size);
+  uint64_t offset = 0;
+  while (offset < log.size) {
+    uint32_t type = 0;
+    size_t recordSize = 0;
+    const uint8_t* name = nullptr;
+    size_t nameSize = 0;
+    if (!parseRecord(bytes->data() + offset, bytes->data() + log.size,
+                     type, recordSize, name, nameSize))
+      break;
+
+    uint64_t hash = hashName(name, nameSize);
+    Slot* freeSlot = nullptr;
+    Slot* slot = findSlot(hash, name, nameSize, &freeSlot);
+    if (slot != nullptr) {
+      releaseRecord(slot->file, slot->length);
+      removeSlot(slot);
+      findSlot(hash, name, nameSize, &freeSlot);
+    }
+    log.liveBytes += recordSize;
+    if (type == tlv::Data) {
+      insertSlot(freeSlot, hash, file, offset, recordSize);
+    }
+    else {
+      log.tombstoneBytes += recordSize;
+    }
+    offset += recordSize;
+  }
+
+  if (offset < log.size) {
+    // cut off a torn or corrupt tail
+    if (::truncate(getLogPath(log.id).data(), static_cast<off_t>(offset)) < 0)
+      BOOST_THROW_EXCEPTION(Error("Cannot truncate log file: " + std::string(std::strerror(errno))));
+    log.size = offset;
+    m_readers[file].reset();
+  }
+}
+
+void
+PacketLog::resizeIndex(uint64_t nSlots)
+{
+  uint8_t* oldIndex = m_index;
+  size_t oldIndexSize = m_indexSize;
+  int oldIndexFd = m_indexFd;
+  const Slot* oldSlots = m_slots;
+  uint64_t nOldSlots = m_header->nSlots;
+
+  std::string path = m_directory + "/index";
+  createIndex(path + ".tmp", nSlots);
+  std::memcpy(m_index, oldIndex, SLOTS_OFFSET);
+  m_header->nSlots = nSlots;
+  m_header->nTombstones = 0;
+
+  uint64_t mask = nSlots - 1;
+  for (uint64_t i = 0; i < nOldSlots; ++i) {
+    if (oldSlots[i].hash <= REMOVED_SLOT)
+      continue;
+    uint64_t position = oldSlots[i].hash & mask;
+    while (m_slots[position].hash != EMPTY_SLOT)
+      position = (position + 1) & mask;
+    m_slots[position] = oldSlots[i];
+  }
+
+  // the new index must be complete on disk before it replaces the old one
+  if (::msync(m_index, m_indexSize, MS_SYNC) < 0 ||
+      ::rename((path + ".tmp").data(), path.data()) < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot replace index: " + std::string(std::strerror(errno))));
+  ::munmap(oldIndex, oldIndexSize);
+  ::close(oldIndexFd);
+  syncDirectory();
+}
+
+PacketLog::Slot*
+PacketLog::findSlot(uint64_t hash, const uint8_t* name, size_t size,
+                    Slot** freeSlot, ConstBufferPtr* record) const
+{
+  uint64_t mask = m_header->nSlots - 1;
+  Slot* firstFree = nullptr;
+  for (uint64_t position = hash & mask; ; position = (position + 1) & mask) {
+    Slot* slot = &m_slots[position];
+    if (slot->hash == EMPTY_SLOT) {
+      if (firstFree == nullptr)
+        firstFree = slot;
+      break;
+    }
+    if (slot->hash == REMOVED_SLOT) {
+      if (firstFree == nullptr)
+        firstFree = slot;
+      continue;
+    }
+    if (slot->hash != hash)
+      continue;
+
+    // confirm the Name against the record, hashes may collide
+    ConstBufferPtr bytes = getReader(slot->file, slot->offset + slot->length)
+                             ->getSegment(slot->offset, slot->length);
+    uint32_t type = 0;
+    size_t recordSize = 0;
+    const uint8_t* recordName = nullptr;
+    size_t recordNameSize = 0;
+    if (parseRecord(bytes->data(), bytes->data() + bytes->size(),
+                    type, recordSize, recordName, recordNameSize) &&
+        recordNameSize == size && std::memcmp(recordName, name, size) == 0) {
+      if (record != nullptr)
+        *record = bytes;
+      return slot;
+    }
+  }
+
+  if (freeSlot != nullptr)
+    *freeSlot = firstFree;
+  return nullptr;
+}
+
+void
+PacketLog::insertSlot(Slot* freeSlot, uint64_t hash, uint32_t file, uint64_t offset,
+                      uint32_t length)
+{
+  if (freeSlot->hash == REMOVED_SLOT)
+    --m_header->nTombstones;
+  freeSlot->offset = offset;
+  freeSlot->file = file;
+  freeSlot->length = length;
+  freeSlot->hash = hash;
+  ++m_header->nPackets;
+
+  // keep probe sequences short: at most half of the slots are in use or removed
+  if ((m_header->nPackets + m_header->nTombstones) * 2 > m_header->nSlots) {
+    resizeIndex(m_header->nPackets * 4 > m_header->nSlots ? m_header->nSlots * 2 :
+                                                            m_header->nSlots);
+  }
+}
+
+void
+PacketLog::removeSlot(Slot* slot)
+{
+  slot->hash = REMOVED_SLOT;
+  --m_header->nPackets;
+  ++m_header->nTombstones;
+}
+
+shared_ptr<MappedFile>
+PacketLog::getReader(uint32_t file, uint64_t end) const
+{
+  shared_ptr<MappedFile>& reader = m_readers[file];
+  if (reader == nullptr) {
+    MappedFile::Options options;
+    options.maxCachedWindows = 4;
+    options.advice = MappedFile::ADVICE_RANDOM;
+    options.readAheadSize = 0;
+    reader = make_shared<MappedFile>(getLogPath(m_files[file].id), options);
+    ++m_nReaderOpens;
+  }
+  if (reader->size() < end) {
+    // the current log file has grown since its reader last looked at it
+    reader->refresh();
+  }
+  return reader;
+}
+
+uint64_t
+PacketLog::append(std::vector<iovec>& iov, size_t size, bool isTombstone)
+{
+  if (m_files[m_header->activeFile].size > 0 &&
+      m_files[m_header->activeFile].size + size > m_options.maxLogFileSize)
+    startLogFile();
+
+  LogFile& log = m_files[m_header->activeFile];
+  uint64_t offset = log.size;
+  writeAll(m_activeFd, iov, offset);
+  log.size += size;
+  log.liveBytes += size;
+  if (isTombstone)
+    log.tombstoneBytes += size;
+  return offset;
+}
+
+void
+PacketLog::startLogFile()
+{
+  uint32_t file = 0;
+  while (file < MAX_LOG_FILES && m_files[file].id != 0)
+    ++file;
+  if (file == MAX_LOG_FILES)
+    BOOST_THROW_EXCEPTION(Error("Too many log files, compaction is falling behind"));
+
+  uint64_t id = m_header->nextLogId;
+  int fd = ::open(getLogPath(id).data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot create log file: " + std::string(std::strerror(errno))));
+
+  if (m_activeFd >= 0) {
+    ::fdatasync(m_activeFd);
+    ::close(m_activeFd);
+  }
+  uint32_t sealed = m_header->activeFile;
+  m_activeFd = fd;
+  m_files[file].id = id;
+  m_files[file].size = m_files[file].liveBytes = m_files[file].tombstoneBytes = 0;
+  m_header->nextLogId = id + 1;
+  m_header->activeFile = file;
+
+  if (isCompactionNeeded(sealed)) {
+    m_isCompactionRequested = true;
+    m_compactionRequested.notify_one();
+  }
+}
+
+void
+PacketLog::releaseRecord(uint32_t file, uint32_t length)
+{
+  m_files[file].liveBytes -= length;
+
+  if (!m_isCompactionRequested && isCompactionNeeded(file)) {
+    m_isCompactionRequested = true;
+    m_compactionRequested.notify_one();
+  }
+}
+
+bool
+PacketLog::isCompactionNeeded(uint32_t file) const
+{
+  const LogFile& log = m_files[file];
+  if (log.id == 0 || log.size == 0 || file == m_header->activeFile)
+    return false;
+
+  uint64_t deadBytes = log.size - log.liveBytes;
+  if (deadBytes >= m_options.compactionThreshold * log.size)
+    return true;
+  if (log.tombstoneBytes == 0)
+    return false;
+
+  // tombstones are needed as long as an older log may hold a packet they erased
+  for (uint32_t other = 0; other < MAX_LOG_FILES; ++other) {
+    if (m_files[other].id != 0 && m_files[other].id < log.id)
+      return false;
+  }
+  return deadBytes + log.tombstoneBytes >= m_options.compactionThreshold * log.size;
+}
+
+void
+PacketLog::insert(const Wire& data)
+{
+  std::vector<uint8_t> name;
+  if (!data.getDataName(name))
+    BOOST_THROW_EXCEPTION(Error("Not a Data packet with a Name"));
+
+  std::vector<iovec> iov;
+  for (Wire::const_iterator i = data.begin(); i != data.end(); ++i) {
+    iovec buffer;
+    buffer.iov_base = const_cast<void*>((*i).data());
+    buffer.iov_len = (*i).size();
+    iov.push_back(buffer);
+  }
+
+  uint64_t hash = hashName(name.data(), name.size());
+  std::lock_guard<std::mutex> lock(m_mutex);
+  uint64_t recordOffset = append(iov, data.size(), false);
+
+  Slot* freeSlot = nullptr;
+  Slot* slot = findSlot(hash, name.data(), name.size(), &freeSlot);
+  if (slot != nullptr) {
+    releaseRecord(slot->file, slot->length);
+    slot->file = m_header->activeFile;
+    slot->offset = recordOffset;
+    slot->length = data.size();
+  }
+  else {
+    insertSlot(freeSlot, hash, m_header->activeFile, recordOffset, data.size());
+  }
+}
+
+Wire
+PacketLog::find(const uint8_t* name, size_t size) const
+{
+  uint64_t hash = hashName(name, size);
+  ConstBufferPtr record;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (findSlot(hash, name, size, nullptr, &record) == nullptr)
+      return Wire();
+  }
+  return Wire(record, record->begin(), record->end());
+}
+
+bool
+PacketLog::erase(const uint8_t* name, size_t size)
+{
+  uint64_t hash = hashName(name, size);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Slot* slot = findSlot(hash, name, size);
+  if (slot == nullptr)
+    return false;
+
+  // the tombstone makes the erasure survive a rebuild of the index
+  std::vector<iovec> iov(1);
+  iov[0].iov_base = const_cast<uint8_t*>(name);
+  iov[0].iov_len = size;
+  append(iov, size, true);
+
+  releaseRecord(slot->file, slot->length);
+  removeSlot(slot);
+  return true;
+}
+
+void
+PacketLog::sync()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (::fdatasync(m_activeFd) < 0 || ::msync(m_index, m_indexSize, MS_SYNC) < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot sync: " + std::string(std::strerror(errno))));
+}
+
+void
+PacketLog::compact()
+{
+  std::lock_guard<std::mutex> compactionLock(m_compactionMutex);
+  for (uint32_t file = 0; file < MAX_LOG_FILES; ++file) {
+    bool isNeeded = false;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      isNeeded = isCompactionNeeded(file);
+    }
+    if (isNeeded)
+      compactLogFile(file);
+  }
+}
+
+void
+PacketLog::compactLogFile(uint32_t file)
+{
+  ConstBufferPtr bytes;
+  uint64_t id = 0;
+  uint64_t size = 0;
+  bool isOldest = true;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    id = m_files[file].id;
+    size = m_files[file].size;
+    bytes = getReader(file, size)->getSegment(0, size);
+    for (uint32_t other = 0; other < MAX_LOG_FILES; ++other) {
+      if (m_files[other].id != 0 && m_files[other].id < id)
+        isOldest = false;
+    }
+  }
+
+  // the file is sealed, so only the index may change while its records are copied
+  uint64_t offset = 0;
+  while (offset < size) {
+    uint32_t type = 0;
+    size_t recordSize = 0;
+    const uint8_t* name = nullptr;
+    size_t nameSize = 0;
+    if (!parseRecord(bytes->data() + offset, bytes->data() + size,
+                     type, recordSize, name, nameSize))
+      break;
+
+    uint64_t hash = hashName(name, nameSize);
+    std::vector<iovec> iov(1);
+    iov[0].iov_base = const_cast<uint8_t*>(bytes->data() + offset);
+    iov[0].iov_len = recordSize;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot* slot = findSlot(hash, name, nameSize);
+    if (type == tlv::Data) {
+      if (slot != nullptr && slot->file == file && slot->offset == offset) {
+        slot->offset = append(iov, recordSize, false);
+        slot->file = m_header->activeFile;
+      }
+    }
+    else if (!isOldest && slot == nullptr) {
+      append(iov, recordSize, true);
+    }
+    offset += recordSize;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // the copied records, the index pointing at them and the entry of the log file holding them
+  // must be durable before the only other copy is removed
+  if (::fdatasync(m_activeFd) < 0 || ::msync(m_index, m_indexSize, MS_SYNC) < 0)
+    BOOST_THROW_EXCEPTION(Error("Cannot sync before compaction: " +
+                                std::string(std::strerror(errno))));
+  syncDirectory();
+  ::unlink(getLogPath(id).data());
+  m_files[file].id = 0;
+  m_files[file].size = m_files[file].liveBytes = m_files[file].tombstoneBytes = 0;
+  m_readers[file].reset();
+  ++m_nCompactions;
+}
+
+void
+PacketLog::runCompaction()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_compactionRequested.wait(lock, [this] { return m_isCompactionRequested || m_isStopping; });
+    if (m_isStopping)
+      return;
+
+    m_isCompactionRequested = false;
+    lock.unlock();
+    try {
+      compact();
+    }
+    catch (const std::exception&) {
+      // the file is left as is and compacted again on the next request
+    }
+    lock.lock();
+  }
+}
+
+PacketLog::Statistics
+PacketLog::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Statistics stats;
+  stats.nPackets = m_header->nPackets;
+  stats.nIndexSlots = m_header->nSlots;
+  stats.nLogFiles = 0;
+  stats.nLogBytes = 0;
+  stats.nLiveBytes = 0;
+  for (size_t file = 0; file < MAX_LOG_FILES; ++file) {
+    if (m_files[file].id == 0)
+      continue;
+    ++stats.nLogFiles;
+    stats.nLogBytes += m_files[file].size;
+    stats.nLiveBytes += m_files[file].liveBytes;
+  }
+  stats.nCompactions = m_nCompactions;
+  stats.nReaderOpens = m_nReaderOpens;
+  stats.wasRecovered = m_wasRecovered;
+  return stats;
+}
+
+std::string
+PacketLog::getLogPath(uint64_t id) const
+{
+  return m_directory + "/" + std::to_string(id) + ".log";
+}
+
+void
+PacketLog::syncDirectory() const
+{
+  int fd = ::open(m_directory.data(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0 || ::fsync(fd) < 0) {
+    int error = errno;
+    if (fd >= 0)
+      ::close(fd);
+    BOOST_THROW_EXCEPTION(Error("Cannot sync " + m_directory + ": " + std::strerror(error)));
+  }
+  ::close(fd);
+}
+
+} // namespace ndn
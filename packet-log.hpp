@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_PACKET_LOG_HPP
+#define NDN_ENCODING_PACKET_LOG_HPP
+
+#include "mapped-file.hpp"
+#include "wire_test.hpp"
+
+#include <condition_variable>
+#include <sys/uio.h>
+#include <thread>
+
+namespace ndn {
+
+/** @brief Persistent store of encoded Data packets in append-only log files
+ *
+ *  Packets are appended as raw TLV to log files in a directory.  A log file is sealed when it
+ *  reaches Options::maxLogFileSize, and the next one is started.  An on-disk hash index from the
+ *  FastHash of the Name TLV to (log file, offset, length) is memory-mapped, so opening a store
+ *  that was closed cleanly only maps the index instead of re-parsing the logs.  find() returns
+ *  a Wire viewing the record in the mapped log, without copying it.
+ *
+ *  Inserting a packet whose Name is already stored replaces it, and erase() appends a
+ *  tombstone (the bare Name TLV), so the logs alone determine the content of the store.  If the
+ *  store was not closed cleanly, the index is rebuilt by replaying the logs in order and a torn
+ *  record at the end of a log is cut off.
+ *
+ *  Replaced and erased records stay in their log file until it is compacted: once the dead
+ *  bytes of a sealed file reach Options::compactionThreshold of its size, a background thread
+ *  copies its live records to the current log file and deletes it.  Wires returned before
+ *  remain valid after their file is deleted.
+ *
+ *  The index and the logs are in host byte order.  All methods are thread-safe.
+ */
+class PacketLog : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  struct Options
+  {
+    Options()
+      : maxLogFileSize(1024 * 1024 * 1024)
+      , initialIndexSize(65536)
+      , compactionThreshold(0.5)
+      , enableBackgroundCompaction(true)
+    {
+    }
+
+    uint64_t maxLogFileSize;     ///< size at which a log file is sealed
+    uint64_t initialIndexSize;   ///< index slots of a new store, rounded up to a power of two
+    double compactionThreshold;  ///< fraction of dead bytes at which a sealed file is compacted
+    bool enableBackgroundCompaction;
+  };
+
+  /** @brief Snapshot of store counters
+   */
+  struct Statistics
+  {
+    uint64_t nPackets;
+    uint64_t nIndexSlots;
+    size_t nLogFiles;
+    uint64_t nLogBytes;
+    uint64_t nLiveBytes;   ///< bytes of stored packets and of tombstones still needed
+    uint64_t nCompactions; ///< log files compacted since the store was opened
+    uint64_t nReaderOpens; ///< log files mapped for reading since the store was opened
+    bool wasRecovered;     ///< the index was rebuilt from the logs when the store was opened
+  };
+
+  /** @brief Maximum number of log files in a store
+   */
+  static const size_t MAX_LOG_FILES = 1024;
+
+  /** @brief Open or create the store in @p directory
+   *  @throw Error the store cannot be opened
+   */
+  explicit
+  PacketLog(const std::string& directory, const Options& options = Options());
+
+  /** @brief Finish the running compaction, flush the store and mark it closed cleanly
+   */
+  ~PacketLog();
+
+  /** @brief Append the Data packet @p data, replacing a stored packet with the same Name
+   *  @throw Error @p data is not a Data packet, or it cannot be written
+   */
+  void
+  insert(const Wire& data);
+
+  /** @brief Return the stored packet whose Name TLV is the @p size bytes at @p name
+   *  @return a Wire viewing the mapped log, or a Wire without blocks (see Wire::hasWire)
+   *          if there is no such packet
+   */
+  Wire
+  find(const uint8_t* name, size_t size) const;
+
+  /** @brief Erase the stored packet whose Name TLV is the @p size bytes at @p name
+   *  @return whether there was such a packet
+   */
+  bool
+  erase(const uint8_t* name, size_t size);
+
+  /** @brief Write the current log file and the index through to disk
+   */
+  void
+  sync();
+
+  /** @brief Compact every sealed log file past the threshold in the calling thread
+   */
+  void
+  compact();
+
+  Statistics
+  getStatistics() const;
+
+private:
+  struct IndexHeader;
+  struct LogFile;
+  struct Slot;
+
+  void
+  mapIndex(int fd);
+
+  void
+  createIndex(const std::string& path, uint64_t nSlots);
+
+  void
+  rebuildIndex(uint64_t nSlots);
+
+  void
+  replayLogFile(uint32_t file);
+
+  void
+  resizeIndex(uint64_t nSlots);
+
+  /** @brief Find the slot of the packet named [@p name, @p name + @p size) with hash @p hash
+   *  @param[out] freeSlot the slot where such a packet would be inserted, if not found
+   *  @param[out] record the packet, if found
+   */
+  Slot*
+  findSlot(uint64_t hash, const uint8_t* name, size_t size,
+           Slot** freeSlot = nullptr, ConstBufferPtr* record = nullptr) const;
+
+  void
+  insertSlot(Slot* freeSlot, uint64_t hash, uint32_t file, uint64_t offset, uint32_t length);
+
+  void
+  removeSlot(Slot* slot);
+
+  /** @brief Return the reader of log file @p file, covering at least its first @p end bytes
+   *
+   *  A reader is opened once per log file; the one of the current log file is refreshed
+   *  as the file grows.
+   */
+  shared_ptr<MappedFile>
+  getReader(uint32_t file, uint64_t end) const;
+
+  /** @brief Append a record gathered from @p iov to the current log file
+   *  @return the offset of the record, in the log file m_header->activeFile
+   */
+  uint64_t
+  append(std::vector<iovec>& iov, size_t size, bool isTombstone);
+
+  void
+  startLogFile();
+
+  void
+  releaseRecord(uint32_t file, uint32_t length);
+
+  bool
+  isCompactionNeeded(uint32_t file) const;
+
+  void
+  compactLogFile(uint32_t file);
+
+  void
+  runCompaction();
+
+  std::string
+  getLogPath(uint64_t id) const;
+
+  /** @brief Make the entries of the log directory durable, e.g. a created or renamed file
+   *  @throw Error the directory cannot be synced
+   */
+  void
+  syncDirectory() const;
+
+private:
+  std::string m_directory;
+  Options m_options;
+
+  mutable std::mutex m_mutex;
+  std::mutex m_compactionMutex; // serializes compact() calls
+
+  int m_indexFd;
+  uint8_t* m_index;
+  size_t m_indexSize;
+  IndexHeader* m_header;
+  LogFile* m_files; // MAX_LOG_FILES entries, following m_header
+  Slot* m_slots;
+
+  int m_activeFd;
+  mutable std::vector<shared_ptr<MappedFile>> m_readers;
+  mutable uint64_t m_nReaderOpens;
+  bool m_wasRecovered;
+  uint64_t m_nCompactions;
+
+  std::condition_variable m_compactionRequested;
+  bool m_isCompactionRequested;
+  bool m_isStopping;
+  std::thread m_compactionThread;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_PACKET_LOG_HPP
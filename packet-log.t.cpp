@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/packet-log.hpp"
+
+#include "boost-test.hpp"
+#include "make-data.hpp"
+
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace tests {
+
+class PacketLogFixture
+{
+protected:
+  PacketLogFixture()
+    : directory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path())
+  {
+  }
+
+  ~PacketLogFixture()
+  {
+    boost::filesystem::remove_all(directory);
+  }
+
+  Wire
+  find(PacketLog& log, uint32_t seq)
+  {
+    std::vector<uint8_t> name = makeName(seq);
+    return log.find(name.data(), name.size());
+  }
+
+  static PacketLog::Options
+  makeOptions()
+  {
+    PacketLog::Options options;
+    options.maxLogFileSize = 8192;
+    options.initialIndexSize = 16;
+    options.enableBackgroundCompaction = false;
+    return options;
+  }
+
+protected:
+  boost::filesystem::path directory;
+};
+
+BOOST_FIXTURE_TEST_SUITE(EncodingPacketLog, PacketLogFixture)
+
+BOOST_AUTO_TEST_CASE(InsertFindErase)
+{
+  PacketLog log(directory.string(), makeOptions());
+  for (uint32_t seq = 0; seq < 100; ++seq) {
+    log.insert(makeData(seq, 300));
+  }
+  log.insert(makeData(7, 500, 1)); // replaces
+
+  for (uint32_t seq = 0; seq < 100; ++seq) {
+    Wire found = find(log, seq);
+    BOOST_REQUIRE(found.hasWire());
+    BOOST_CHECK_EQUAL(found.countBlock(), 1);
+    BOOST_CHECK(found == makeData(seq, seq == 7 ? 500 : 300, seq == 7 ? 1 : 0));
+  }
+  BOOST_CHECK(!find(log, 100).hasWire());
+
+  std::vector<uint8_t> name = makeName(42);
+  BOOST_CHECK(log.erase(name.data(), name.size()));
+  BOOST_CHECK(!log.erase(name.data(), name.size()));
+  BOOST_CHECK(!find(log, 42).hasWire());
+
+  PacketLog::Statistics stats = log.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nPackets, 99);
+  BOOST_CHECK_GE(stats.nIndexSlots, 256);
+  BOOST_CHECK_GT(stats.nLogFiles, 1);
+  BOOST_CHECK_LT(stats.nLiveBytes, stats.nLogBytes);
+  BOOST_CHECK(!stats.wasRecovered);
+
+  const uint8_t interest[] = {0x05, 0x03, 0x07, 0x01, 0x08};
+  Wire notData(64);
+  notData.appendArray(interest, sizeof(interest));
+  BOOST_CHECK_THROW(log.insert(notData), PacketLog::Error);
+}
+
+BOOST_AUTO_TEST_CASE(GrowingLogFile)
+{
+  PacketLog::Options options = makeOptions();
+  options.maxLogFileSize = 1024 * 1024;
+  PacketLog log(directory.string(), options);
+
+  // every packet is found right after it is appended to the current log file
+  std::vector<Wire> found;
+  for (uint32_t seq = 0; seq < 50; ++seq) {
+    log.insert(makeData(seq, 300));
+    found.push_back(find(log, seq));
+    BOOST_REQUIRE(found.back().hasWire());
+  }
+  BOOST_CHECK_EQUAL(log.getStatistics().nReaderOpens, 1);
+
+  // wires viewing the file before it grew stay valid
+  for (uint32_t seq = 0; seq < 50; ++seq) {
+    BOOST_CHECK(found[seq] == makeData(seq, 300));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Reopen)
+{
+  {
+    PacketLog log(directory.string(), makeOptions());
+    for (uint32_t seq = 0; seq < 50; ++seq) {
+      log.insert(makeData(seq, 300));
+    }
+    std::vector<uint8_t> name = makeName(3);
+    log.erase(name.data(), name.size());
+  }
+
+  PacketLog log(directory.string(), makeOptions());
+  BOOST_CHECK(!log.getStatistics().wasRecovered);
+  BOOST_CHECK_EQUAL(log.getStatistics().nPackets, 49);
+  BOOST_CHECK(!find(log, 3).hasWire());
+  BOOST_CHECK(find(log, 49) == makeData(49, 300));
+}
+
+BOOST_AUTO_TEST_CASE(Recovery)
+{
+  {
+    PacketLog log(directory.string(), makeOptions());
+    for (uint32_t seq = 0; seq < 50; ++seq) {
+      log.insert(makeData(seq, 300));
+    }
+    log.insert(makeData(10, 300, 1));
+    std::vector<uint8_t> name = makeName(3);
+    log.erase(name.data(), name.size());
+  }
+
+  // crash: the index is not marked clean, and an append was torn
+  int fd = ::open((directory / "index").string().data(), O_WRONLY);
+  const uint32_t isClean = 0;
+  BOOST_REQUIRE_EQUAL(::pwrite(fd, &isClean, sizeof(isClean), 12), 4);
+  ::close(fd);
+  uint64_t lastId = 0;
+  for (boost::filesystem::directory_iterator i(directory), end; i != end; ++i) {
+    if (i->path().extension() == ".log")
+      lastId = std::max<uint64_t>(lastId, std::stoull(i->path().stem().string()));
+  }
+  fd = ::open((directory / (std::to_string(lastId) + ".log")).string().data(), O_WRONLY | O_APPEND);
+  const uint8_t torn[] = {0x06, 0xFD, 0x01, 0x00, 0x07};
+  BOOST_REQUIRE_EQUAL(::write(fd, torn, sizeof(torn)), 5);
+  ::close(fd);
+
+  PacketLog log(directory.string(), makeOptions());
+  BOOST_CHECK(log.getStatistics().wasRecovered);
+  BOOST_CHECK_EQUAL(log.getStatistics().nPackets, 49);
+  BOOST_CHECK(!find(log, 3).hasWire());
+  BOOST_CHECK(find(log, 10) == makeData(10, 300, 1));
+  BOOST_CHECK(find(log, 49) == makeData(49, 300));
+
+  log.insert(makeData(50, 300));
+  BOOST_CHECK(find(log, 50) == makeData(50, 300));
+}
+
+BOOST_AUTO_TEST_CASE(Compaction)
+{
+  PacketLog log(directory.string(), makeOptions());
+  for (uint32_t round = 0; round < 3; ++round) {
+    for (uint32_t seq = 0; seq < 40; ++seq) {
+      log.insert(makeData(seq, 300, round));
+    }
+  }
+  PacketLog::Statistics before = log.getStatistics();
+
+  log.compact();
+  PacketLog::Statistics after = log.getStatistics();
+  BOOST_CHECK_GT(after.nCompactions, 0);
+  BOOST_CHECK_LT(after.nLogBytes, before.nLogBytes);
+  BOOST_CHECK_EQUAL(after.nLiveBytes, before.nLiveBytes);
+  for (uint32_t seq = 0; seq < 40; ++seq) {
+    BOOST_CHECK(find(log, seq) == makeData(seq, 300, 2));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BackgroundCompaction)
+{
+  PacketLog::Options options = makeOptions();
+  options.enableBackgroundCompaction = true;
+  Wire kept;
+  {
+    PacketLog log(directory.string(), options);
+    log.insert(makeData(0, 300));
+    kept = find(log, 0);
+    for (uint32_t round = 0; round < 3; ++round) {
+      for (uint32_t seq = 0; seq < 40; ++seq) {
+        log.insert(makeData(seq, 300, round + 1));
+      }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (log.getStatistics().nCompactions == 0 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    BOOST_CHECK_GT(log.getStatistics().nCompactions, 0);
+  }
+
+  // the file of the replaced packet is gone, its mapping is not
+  BOOST_CHECK(kept == makeData(0, 300));
+
+  PacketLog log(directory.string(), options);
+  for (uint32_t seq = 0; seq < 40; ++seq) {
+    BOOST_CHECK(find(log, seq) == makeData(seq, 300, 3));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,447 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "segment-pool.hpp"
+
+#include <algorithm>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+
+#ifdef NDN_CXX_HAVE_NUMA
+#include <numa.h>
+#endif // NDN_CXX_HAVE_NUMA
+
+namespace ndn {
+
+const size_t SegmentPool::CHUNK_SIZE;
+const size_t SegmentPool::MAX_POOLED_SIZE;
+const size_t SegmentPool::N_SIZE_CLASSES;
+const size_t SegmentPool::SIZE_CLASSES[SegmentPool::N_SIZE_CLASSES] = {
+  128, 256, 512, 1024, 2048, 4096, SegmentPool::MAX_POOLED_SIZE
+};
+
+/** @brief Header at the beginning of every slab
+ *
+ *  Segments start at CHUNK_HEADER_SIZE, so they stay cache-line aligned.
+ */
+struct ChunkHeader
+{
+  size_t node;
+};
+
+static const size_t CHUNK_HEADER_SIZE = 64;
+
+struct SegmentPool::Arena
+{
+  explicit
+  Arena(size_t node)
+    : node(node)
+  {
+    std::fill(freeLists, freeLists + N_SIZE_CLASSES, nullptr);
+    std::fill(bumpBegin, bumpBegin + N_SIZE_CLASSES, nullptr);
+    std::fill(bumpEnd, bumpEnd + N_SIZE_CLASSES, nullptr);
+  }
+
+  size_t node;
+  std::mutex mutex;
+  void* freeLists[N_SIZE_CLASSES];   // intrusive lists of returned segments
+  char* bumpBegin[N_SIZE_CLASSES];   // not yet used part of the newest slab
+  char* bumpEnd[N_SIZE_CLASSES];
+  std::vector<char*> chunks;
+};
+
+// set once the cache of the calling thread has been destroyed at thread exit
+static thread_local bool t_isThreadCacheDestroyed = false;
+
+/** @brief Free segments of the process-wide pool held by one thread
+ *
+ *  All cached segments belong to the arena of @c node.
+ */
+struct SegmentPool::ThreadCache
+{
+  ThreadCache()
+    : node(SegmentPool::get().getCurrentNode())
+  {
+    std::fill(freeLists, freeLists + N_SIZE_CLASSES, nullptr);
+    std::fill(counts, counts + N_SIZE_CLASSES, 0);
+  }
+
+  ~ThreadCache()
+  {
+    for (size_t sizeClass = 0; sizeClass < N_SIZE_CLASSES; ++sizeClass) {
+      SegmentPool::get().flushThreadCache(*this, sizeClass, counts[sizeClass]);
+    }
+    t_isThreadCacheDestroyed = true;
+  }
+
+  size_t node;
+  void* freeLists[N_SIZE_CLASSES];
+  size_t counts[N_SIZE_CLASSES];
+};
+
+SegmentPool&
+SegmentPool::get()
+{
+  // never destroyed, so that buffers released during static destruction can still be returned
+  static SegmentPool* pool = new SegmentPool(true);
+  return *pool;
+}
+
+SegmentPool::SegmentPool(bool hasThreadCaches)
+  : m_hugePageMode(HUGE_PAGE_NONE)
+  , m_hasThreadCaches(hasThreadCaches)
+  , m_nAllocations(0)
+  , m_nDeallocations(0)
+  , m_nCrossNodeFrees(0)
+  , m_nChunks(0)
+  , m_nLargeAllocations(0)
+  , m_nHugePageChunks(0)
+  , m_nTransparentHugePageChunks(0)
+  , m_nHugePageFallbacks(0)
+  , m_nThreadCacheRefills(0)
+  , m_nThreadCacheFlushes(0)
+{
+  size_t nNodes = 1;
+#ifdef NDN_CXX_HAVE_NUMA
+  if (numa_available() >= 0 && numa_num_configured_nodes() > 1) {
+    nNodes = static_cast<size_t>(numa_max_node()) + 1;
+  }
+#endif // NDN_CXX_HAVE_NUMA
+
+  for (size_t node = 0; node < nNodes; ++node) {
+    m_arenas.push_back(make_unique<Arena>(node));
+  }
+}
+
+SegmentPool::~SegmentPool()
+{
+  for (const auto& arena : m_arenas) {
+    for (char* chunk : arena->chunks) {
+      ::munmap(chunk, CHUNK_SIZE);
+    }
+  }
+}
+
+size_t
+SegmentPool::getSizeClass(size_t size)
+{
+  size_t sizeClass = 0;
+  while (SIZE_CLASSES[sizeClass] < size) {
+    ++sizeClass;
+  }
+  return sizeClass;
+}
+
+size_t
+SegmentPool::getCurrentNode() const
+{
+#ifdef NDN_CXX_HAVE_NUMA
+  if (isNumaEnabled()) {
+    int cpu = sched_getcpu();
+    if (cpu >= 0) {
+      int node = numa_node_of_cpu(cpu);
+      if (node >= 0 && static_cast<size_t>(node) < m_arenas.size())
+        return static_cast<size_t>(node);
+    }
+  }
+#endif // NDN_CXX_HAVE_NUMA
+  return 0;
+}
+
+size_t
+SegmentPool::getBatchSize(size_t sizeClass)
+{
+  // about 32 KB per batch, but at least a few segments of the largest class
+  return std::min<size_t>(64, std::max<size_t>(4, 32768 / SIZE_CLASSES[sizeClass]));
+}
+
+void*
+SegmentPool::allocate(size_t size)
+{
+  if (size > MAX_POOLED_SIZE) {
+    ++m_nLargeAllocations;
+    return ::operator new(size);
+  }
+
+  size_t sizeClass = getSizeClass(size);
+  ++m_nAllocations;
+
+  ThreadCache* cache = m_hasThreadCaches ? getThreadCache() : nullptr;
+  if (cache != nullptr) {
+    if (cache->freeLists[sizeClass] == nullptr) {
+      refillThreadCache(*cache, sizeClass);
+    }
+    void* segment = cache->freeLists[sizeClass];
+    cache->freeLists[sizeClass] = *static_cast<void**>(segment);
+    --cache->counts[sizeClass];
+    return segment;
+  }
+
+  Arena& arena = *m_arenas[getCurrentNode()];
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  return takeSegment(arena, sizeClass);
+}
+
+void
+SegmentPool::deallocate(void* p, size_t size) noexcept
+{
+  if (p == nullptr)
+    return;
+
+  if (size > MAX_POOLED_SIZE) {
+    ::operator delete(p);
+    return;
+  }
+
+  size_t sizeClass = getSizeClass(size);
+  size_t node = static_cast<const ChunkHeader*>(getChunkOf(p))->node;
+  ++m_nDeallocations;
+
+  ThreadCache* cache = m_hasThreadCaches ? getThreadCache() : nullptr;
+  if (cache != nullptr) {
+    if (node == cache->node) {
+      *static_cast<void**>(p) = cache->freeLists[sizeClass];
+      cache->freeLists[sizeClass] = p;
+      if (++cache->counts[sizeClass] > 2 * getBatchSize(sizeClass)) {
+        flushThreadCache(*cache, sizeClass, getBatchSize(sizeClass));
+      }
+      return;
+    }
+    ++m_nCrossNodeFrees;
+  }
+  else if (node != getCurrentNode()) {
+    ++m_nCrossNodeFrees;
+  }
+
+  Arena& arena = *m_arenas[node];
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  *static_cast<void**>(p) = arena.freeLists[sizeClass];
+  arena.freeLists[sizeClass] = p;
+}
+
+void*
+SegmentPool::takeSegment(Arena& arena, size_t sizeClass)
+{
+  void* segment = arena.freeLists[sizeClass];
+  if (segment != nullptr) {
+    arena.freeLists[sizeClass] = *static_cast<void**>(segment);
+    return segment;
+  }
+
+  if (arena.bumpBegin[sizeClass] == arena.bumpEnd[sizeClass]) {
+    allocateChunk(arena, sizeClass);
+  }
+  segment = arena.bumpBegin[sizeClass];
+  arena.bumpBegin[sizeClass] += SIZE_CLASSES[sizeClass];
+  return segment;
+}
+
+SegmentPool::ThreadCache*
+SegmentPool::getThreadCache()
+{
+  // buffers freed by thread_local objects destroyed after the cache bypass it
+  if (t_isThreadCacheDestroyed)
+    return nullptr;
+
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void
+SegmentPool::refillThreadCache(ThreadCache& cache, size_t sizeClass)
+{
+  // the thread may have migrated since the last refill; the cache follows it
+  size_t node = getCurrentNode();
+  if (node != cache.node) {
+    for (size_t i = 0; i < N_SIZE_CLASSES; ++i) {
+      flushThreadCache(cache, i, cache.counts[i]);
+    }
+    cache.node = node;
+  }
+
+  Arena& arena = *m_arenas[node];
+  size_t batchSize = getBatchSize(sizeClass);
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  for (size_t i = 0; i < batchSize; ++i) {
+    void* segment = nullptr;
+    try {
+      segment = takeSegment(arena, sizeClass);
+    }
+    catch (const std::bad_alloc&) {
+      // a partial batch is enough as long as it has a segment
+      if (cache.freeLists[sizeClass] == nullptr)
+        throw;
+      break;
+    }
+    *static_cast<void**>(segment) = cache.freeLists[sizeClass];
+    cache.freeLists[sizeClass] = segment;
+    ++cache.counts[sizeClass];
+  }
+  ++m_nThreadCacheRefills;
+}
+
+void
+SegmentPool::flushThreadCache(ThreadCache& cache, size_t sizeClass, size_t n) noexcept
+{
+  if (n == 0 || cache.freeLists[sizeClass] == nullptr)
+    return;
+
+  // detach the first n segments of the cache list, then splice them into the arena at once
+  void* first = cache.freeLists[sizeClass];
+  void* last = first;
+  for (size_t i = 1; i < n && *static_cast<void**>(last) != nullptr; ++i) {
+    last = *static_cast<void**>(last);
+    --cache.counts[sizeClass];
+  }
+  --cache.counts[sizeClass];
+  cache.freeLists[sizeClass] = *static_cast<void**>(last);
+
+  Arena& arena = *m_arenas[cache.node];
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  *static_cast<void**>(last) = arena.freeLists[sizeClass];
+  arena.freeLists[sizeClass] = first;
+  ++m_nThreadCacheFlushes;
+}
+
+void
+SegmentPool::allocateChunk(Arena& arena, size_t sizeClass)
+{
+  char* chunk = static_cast<char*>(mapChunk(arena.node));
+  reinterpret_cast<ChunkHeader*>(chunk)->node = arena.node;
+  arena.chunks.push_back(chunk);
+  ++m_nChunks;
+
+  size_t nSegments = (CHUNK_SIZE - CHUNK_HEADER_SIZE) / SIZE_CLASSES[sizeClass];
+  arena.bumpBegin[sizeClass] = chunk + CHUNK_HEADER_SIZE;
+  arena.bumpEnd[sizeClass] = arena.bumpBegin[sizeClass] + nSegments * SIZE_CLASSES[sizeClass];
+}
+
+void*
+SegmentPool::mapChunk(size_t node)
+{
+  HugePageMode mode = m_hugePageMode;
+  bool isFallback = false;
+  void* chunk = nullptr;
+
+#ifdef MAP_HUGETLB
+  if (mode == HUGE_PAGE_EXPLICIT) {
+    // huge page mappings are always aligned to the huge page size
+    chunk = ::mmap(nullptr, CHUNK_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (chunk != MAP_FAILED) {
+      ++m_nHugePageChunks;
+    }
+    else {
+      chunk = nullptr;
+      isFallback = true;
+      mode = HUGE_PAGE_TRANSPARENT;
+    }
+  }
+#else
+  if (mode == HUGE_PAGE_EXPLICIT) {
+    isFallback = true;
+    mode = HUGE_PAGE_TRANSPARENT;
+  }
+#endif // MAP_HUGETLB
+
+  if (chunk == nullptr) {
+    chunk = mapAlignedChunk();
+    if (mode == HUGE_PAGE_TRANSPARENT) {
+#ifdef MADV_HUGEPAGE
+      if (::madvise(chunk, CHUNK_SIZE, MADV_HUGEPAGE) == 0) {
+        ++m_nTransparentHugePageChunks;
+      }
+      else {
+        isFallback = true;
+      }
+#else
+      isFallback = true;
+#endif // MADV_HUGEPAGE
+    }
+  }
+
+  if (isFallback) {
+    ++m_nHugePageFallbacks;
+  }
+
+#ifdef NDN_CXX_HAVE_NUMA
+  if (isNumaEnabled()) {
+    // mbind the slab before it is first touched, so its pages are faulted in on the node
+    numa_tonode_memory(chunk, CHUNK_SIZE, static_cast<int>(node));
+  }
+#else
+  (void)node;
+#endif // NDN_CXX_HAVE_NUMA
+
+  return chunk;
+}
+
+void*
+SegmentPool::mapAlignedChunk()
+{
+  // over-map and trim, so that the slab header can be found by masking a segment address
+  size_t length = 2 * CHUNK_SIZE;
+  void* region = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED)
+    throw std::bad_alloc();
+
+  uintptr_t begin = reinterpret_cast<uintptr_t>(region);
+  uintptr_t aligned = (begin + CHUNK_SIZE - 1) & ~static_cast<uintptr_t>(CHUNK_SIZE - 1);
+  if (aligned > begin) {
+    ::munmap(region, aligned - begin);
+  }
+  if (begin + length > aligned + CHUNK_SIZE) {
+    ::munmap(reinterpret_cast<void*>(aligned + CHUNK_SIZE), begin + length - aligned - CHUNK_SIZE);
+  }
+  return reinterpret_cast<void*>(aligned);
+}
+
+SegmentPool::Statistics
+SegmentPool::getStatistics() const
+{
+  Statistics stats;
+  stats.nNodes = m_arenas.size();
+  stats.nAllocations = m_nAllocations;
+  stats.nDeallocations = m_nDeallocations;
+  stats.nCrossNodeFrees = m_nCrossNodeFrees;
+  stats.nChunks = m_nChunks;
+  stats.nLargeAllocations = m_nLargeAllocations;
+  stats.nHugePageChunks = m_nHugePageChunks;
+  stats.nTransparentHugePageChunks = m_nTransparentHugePageChunks;
+  stats.nHugePageFallbacks = m_nHugePageFallbacks;
+  stats.nThreadCacheRefills = m_nThreadCacheRefills;
+  stats.nThreadCacheFlushes = m_nThreadCacheFlushes;
+  return stats;
+}
+
+std::vector<void*>
+SegmentPool::getChunks() const
+{
+  std::vector<void*> chunks;
+  for (const auto& arena : m_arenas) {
+    std::lock_guard<std::mutex> lock(arena->mutex);
+    chunks.insert(chunks.end(), arena->chunks.begin(), arena->chunks.end());
+  }
+  return chunks;
+}
+
+} // namespace ndn
@@ -0,0 +1,453 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_SEGMENT_POOL_HPP
+#define NDN_ENCODING_SEGMENT_POOL_HPP
+
+#include "../common.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ndn {
+
+/** @brief Process-wide allocator of the memory segments underlying Buffer and Wire blocks
+ *
+ *  Requests up to MAX_POOLED_SIZE bytes are rounded up to a size class and carved out of
+ *  CHUNK_SIZE-aligned slabs, one slab per size class.  Larger requests go to the global heap.
+ *
+ *  On a multi-node NUMA machine (and when the library is built with libnuma) every node has
+ *  its own arena whose slabs are bound to that node with mbind, and a segment is always taken
+ *  from the arena of the node the calling thread runs on.  A segment freed on another node is
+ *  returned to its owning arena and counted in Statistics::nCrossNodeFrees.  On a single-node
+ *  machine, or without libnuma, there is exactly one arena and no memory policy is applied.
+ *
+ *  The process-wide pool keeps a small per-thread cache of free segments for every size class,
+ *  so that most allocations and frees touch neither the arena mutex nor sched_getcpu.  A cache
+ *  is refilled from, and trimmed back to, the arena of the thread's node in batches, and is
+ *  returned to the arena when the thread exits.  A thread therefore keeps using the node it
+ *  ran on at its last refill, and a segment counts as a cross-node free when it belongs to
+ *  another node than that one.  Pools constructed for tests have no thread caches.
+ *
+ *  Slabs can be backed by 2 MB huge pages (see HugePageMode) to cut dTLB misses when many
+ *  segments are live.  If huge pages cannot be obtained the slab falls back to normal pages,
+ *  which is reported in Statistics::nHugePageFallbacks.
+ *
+ *  Slabs are never returned to the operating system.
+ */
+class SegmentPool : noncopyable
+{
+public:
+  /** @brief Snapshot of pool counters
+   */
+  struct Statistics
+  {
+    size_t nNodes;
+    uint64_t nAllocations;
+    uint64_t nDeallocations;
+    uint64_t nCrossNodeFrees;
+    uint64_t nChunks;
+    uint64_t nLargeAllocations;
+    uint64_t nHugePageChunks;            ///< slabs mapped with MAP_HUGETLB
+    uint64_t nTransparentHugePageChunks; ///< slabs accepted by madvise(MADV_HUGEPAGE)
+    uint64_t nHugePageFallbacks;         ///< slabs that did not get the requested page size
+    uint64_t nThreadCacheRefills;        ///< batches moved from an arena to a thread cache
+    uint64_t nThreadCacheFlushes;        ///< batches moved from a thread cache to an arena
+  };
+
+  /** @brief Kind of pages backing the slabs
+   */
+  enum HugePageMode {
+    /** @brief normal pages
+     */
+    HUGE_PAGE_NONE,
+
+    /** @brief transparent huge pages requested with madvise(MADV_HUGEPAGE)
+     */
+    HUGE_PAGE_TRANSPARENT,
+
+    /** @brief explicit huge pages from the hugetlbfs pool (MAP_HUGETLB),
+     *         falling back to HUGE_PAGE_TRANSPARENT when the pool is exhausted
+     */
+    HUGE_PAGE_EXPLICIT
+  };
+
+  /** @brief Size and alignment of a slab
+   */
+  static const size_t CHUNK_SIZE = 2 * 1024 * 1024;
+
+  /** @brief Largest request served from the slabs
+   */
+  static const size_t MAX_POOLED_SIZE = 8832;
+
+  /** @brief Return the process-wide pool
+   */
+  static SegmentPool&
+  get();
+
+  /** @brief Allocate @p size bytes on the NUMA node of the calling thread
+   *  @throw std::bad_alloc memory cannot be obtained
+   */
+  void*
+  allocate(size_t size);
+
+  /** @brief Return @p size bytes at @p p, previously obtained from allocate(@p size)
+   */
+  void
+  deallocate(void* p, size_t size) noexcept;
+
+  /** @brief Return the number of arenas, one per NUMA node in use
+   */
+  size_t
+  getNodeCount() const
+  {
+    return m_arenas.size();
+  }
+
+  /** @brief Check whether segments are placed on NUMA nodes
+   *
+   *  This is false on single-node machines and when libnuma is not available.
+   */
+  bool
+  isNumaEnabled() const
+  {
+    return m_arenas.size() > 1;
+  }
+
+  /** @brief Select the pages backing slabs mapped from now on
+   */
+  void
+  setHugePageMode(HugePageMode mode)
+  {
+    m_hugePageMode = mode;
+  }
+
+  HugePageMode
+  getHugePageMode() const
+  {
+    return m_hugePageMode;
+  }
+
+  Statistics
+  getStatistics() const;
+
+  /** @brief Return the start of every slab mapped so far, each of CHUNK_SIZE bytes
+   *
+   *  This lets I/O engines register the pool memory with the kernel.
+   */
+  std::vector<void*>
+  getChunks() const;
+
+  /** @brief Return the start of the slab that contains the pooled segment at @p p
+   */
+  static void*
+  getChunkOf(const void* p)
+  {
+    return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(p) &
+                                   ~static_cast<uintptr_t>(CHUNK_SIZE - 1));
+  }
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /** @param hasThreadCaches whether allocations go through per-thread caches; only the
+   *         process-wide pool, which is never destroyed, may have them
+   */
+  explicit
+  SegmentPool(bool hasThreadCaches = false);
+
+  /** @brief Unmap all slabs
+   *  @warning segments still in use become invalid
+   */
+  ~SegmentPool();
+
+  /** @brief Return the index of the size class serving @p size bytes
+   */
+  static size_t
+  getSizeClass(size_t size);
+
+  /** @brief Return the NUMA node of the calling thread
+   */
+  size_t
+  getCurrentNode() const;
+
+  /** @brief Return the number of segments moved at once between a thread cache and an arena
+   */
+  static size_t
+  getBatchSize(size_t sizeClass);
+
+private:
+  struct Arena;
+  struct ThreadCache;
+
+  /** @brief Take a segment from @p arena
+   *  @pre arena.mutex is held
+   */
+  void*
+  takeSegment(Arena& arena, size_t sizeClass);
+
+  /** @brief Return the cache of the calling thread, or nullptr once it is destroyed
+   */
+  static ThreadCache*
+  getThreadCache();
+
+  void
+  refillThreadCache(ThreadCache& cache, size_t sizeClass);
+
+  /** @brief Return up to @p n segments of @p sizeClass from @p cache to its arena
+   */
+  void
+  flushThreadCache(ThreadCache& cache, size_t sizeClass, size_t n) noexcept;
+
+  void
+  allocateChunk(Arena& arena, size_t sizeClass);
+
+  void*
+  mapChunk(size_t node);
+
+  /** @brief Map a CHUNK_SIZE-aligned slab of normal pages
+   */
+  static void*
+  mapAlignedChunk();
+
+private:
+  static const size_t N_SIZE_CLASSES = 7;
+  static const size_t SIZE_CLASSES[N_SIZE_CLASSES];
+
+  std::vector<unique_ptr<Arena>> m_arenas;
+  std::atomic<HugePageMode> m_hugePageMode;
+  const bool m_hasThreadCaches;
+
+  std::atomic<uint64_t> m_nAllocations;
+  std::atomic<uint64_t> m_nDeallocations;
+  std::atomic<uint64_t> m_nCrossNodeFrees;
+  std::atomic<uint64_t> m_nChunks;
+  std::atomic<uint64_t> m_nLargeAllocations;
+  std::atomic<uint64_t> m_nHugePageChunks;
+  std::atomic<uint64_t> m_nTransparentHugePageChunks;
+  std::atomic<uint64_t> m_nHugePageFallbacks;
+  std::atomic<uint64_t> m_nThreadCacheRefills;
+  std::atomic<uint64_t> m_nThreadCacheFlushes;
+};
+
+/** @brief Memory owned outside the library, lent to a single SegmentAllocator allocation
+ *
+ *  The release callback is invoked exactly once: when the allocation is returned, or when the
+ *  AdoptedMemory is destroyed if the memory was never handed out.
+ */
+class AdoptedMemory : noncopyable
+{
+public:
+  typedef function<void()> ReleaseCallback;
+
+  AdoptedMemory(const uint8_t* memory, size_t size, const ReleaseCallback& release)
+    : m_memory(const_cast<uint8_t*>(memory))
+    , m_size(size)
+    , m_release(release)
+    , m_isHandedOut(false)
+  {
+  }
+
+  ~AdoptedMemory()
+  {
+    if (m_memory != nullptr)
+      this->release();
+  }
+
+  /** @brief Hand out the memory for an allocation of @p size bytes
+   *  @return the memory, or nullptr if it is too small or was handed out before
+   */
+  void*
+  acquire(size_t size) noexcept
+  {
+    if (m_isHandedOut || m_memory == nullptr || size > m_size)
+      return nullptr;
+
+    m_isHandedOut = true;
+    return m_memory;
+  }
+
+  /** @brief Release the memory if @p p is the allocation handed out by acquire()
+   *  @return whether @p p was the adopted memory
+   */
+  bool
+  tryRelease(void* p) noexcept
+  {
+    if (!m_isHandedOut || p != m_memory)
+      return false;
+
+    this->release();
+    return true;
+  }
+
+private:
+  void
+  release() noexcept
+  {
+    m_memory = nullptr;
+    if (m_release)
+      m_release();
+  }
+
+private:
+  uint8_t* m_memory;
+  size_t m_size;
+  ReleaseCallback m_release;
+  bool m_isHandedOut;
+};
+
+/** @brief Standard allocator drawing memory from SegmentPool
+ *
+ *  This is the allocator of Buffer, so every Buffer lives in a pooled segment.
+ *
+ *  An allocator constructed with an AdoptedMemory serves its first fitting allocation from that
+ *  memory instead, which is how ExternalBuffer wraps memory without copying it.  Copies of a
+ *  container do not inherit the adopted memory.
+ *
+ *  Elements constructed without an initializer are value-initialized, as with std::allocator.
+ *  An allocator constructed with DefaultInitTag, or with an AdoptedMemory whose contents must
+ *  be kept, default-initializes them instead, so a container sized with `vector(n)` or
+ *  `resize(n)` leaves its bytes indeterminate rather than zero-filling memory the caller is
+ *  about to overwrite.  Copies of a container value-initialize again.
+ */
+template<typename T>
+class SegmentAllocator
+{
+public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  template<typename U>
+  struct rebind
+  {
+    typedef SegmentAllocator<U> other;
+  };
+
+  /** @brief Tag selecting an allocator that default-initializes elements
+   */
+  struct DefaultInitTag
+  {
+  };
+
+  SegmentAllocator() noexcept
+    : m_isDefaultInit(false)
+  {
+  }
+
+  explicit
+  SegmentAllocator(DefaultInitTag) noexcept
+    : m_isDefaultInit(true)
+  {
+  }
+
+  explicit
+  SegmentAllocator(const shared_ptr<AdoptedMemory>& adopted) noexcept
+    : m_adopted(adopted)
+    , m_isDefaultInit(true)
+  {
+  }
+
+  template<typename U>
+  SegmentAllocator(const SegmentAllocator<U>& other) noexcept
+    : m_adopted(other.getAdoptedMemory())
+    , m_isDefaultInit(other.isDefaultInit())
+  {
+  }
+
+  SegmentAllocator
+  select_on_container_copy_construction() const noexcept
+  {
+    return SegmentAllocator();
+  }
+
+  const shared_ptr<AdoptedMemory>&
+  getAdoptedMemory() const noexcept
+  {
+    return m_adopted;
+  }
+
+  /** @brief Check whether elements constructed without an initializer are left indeterminate
+   */
+  bool
+  isDefaultInit() const noexcept
+  {
+    return m_isDefaultInit;
+  }
+
+  T*
+  allocate(size_t n)
+  {
+    if (m_adopted != nullptr) {
+      void* memory = m_adopted->acquire(n * sizeof(T));
+      if (memory != nullptr)
+        return static_cast<T*>(memory);
+    }
+    return static_cast<T*>(SegmentPool::get().allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T* p, size_t n) noexcept
+  {
+    if (m_adopted != nullptr && m_adopted->tryRelease(p))
+      return;
+
+    SegmentPool::get().deallocate(p, n * sizeof(T));
+  }
+
+  template<typename U>
+  void
+  construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value)
+  {
+    if (m_isDefaultInit)
+      ::new (static_cast<void*>(p)) U;
+    else
+      ::new (static_cast<void*>(p)) U();
+  }
+
+  template<typename U, typename... Args>
+  void
+  construct(U* p, Args&&... args)
+  {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+private:
+  shared_ptr<AdoptedMemory> m_adopted;
+  bool m_isDefaultInit;
+};
+
+template<typename T, typename U>
+inline bool
+operator==(const SegmentAllocator<T>& lhs, const SegmentAllocator<U>& rhs) noexcept
+{
+  return lhs.getAdoptedMemory() == rhs.getAdoptedMemory();
+}
+
+template<typename T, typename U>
+inline bool
+operator!=(const SegmentAllocator<T>& lhs, const SegmentAllocator<U>& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_SEGMENT_POOL_HPP
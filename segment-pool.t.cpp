@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/segment-pool.hpp"
+#include "encoding/buffer.hpp"
+
+#include "boost-test.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingSegmentPool)
+
+BOOST_AUTO_TEST_CASE(SizeClass)
+{
+  BOOST_CHECK_EQUAL(SegmentPool::getSizeClass(1), 0);
+  BOOST_CHECK_EQUAL(SegmentPool::getSizeClass(128), 0);
+  BOOST_CHECK_EQUAL(SegmentPool::getSizeClass(129), 1);
+  BOOST_CHECK_EQUAL(SegmentPool::getSizeClass(2048), 4);
+  BOOST_CHECK_EQUAL(SegmentPool::getSizeClass(8800), 6);
+}
+
+BOOST_AUTO_TEST_CASE(Reuse)
+{
+  SegmentPool pool;
+
+  uint8_t* first = static_cast<uint8_t*>(pool.allocate(2048));
+  std::fill(first, first + 2048, 0xcc);
+  uint8_t* second = static_cast<uint8_t*>(pool.allocate(2000));
+  BOOST_CHECK_EQUAL(second - first, 2048);
+
+  pool.deallocate(first, 2048);
+  BOOST_CHECK(pool.allocate(1500) == first);
+
+  SegmentPool::Statistics stats = pool.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nAllocations, 3);
+  BOOST_CHECK_EQUAL(stats.nDeallocations, 1);
+  BOOST_CHECK_EQUAL(stats.nChunks, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Alignment)
+{
+  SegmentPool pool;
+
+  void* segment = pool.allocate(100);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(segment) % 64, 0);
+  pool.deallocate(segment, 100);
+}
+
+BOOST_AUTO_TEST_CASE(Large)
+{
+  SegmentPool pool;
+
+  void* large = pool.allocate(SegmentPool::MAX_POOLED_SIZE + 1);
+  pool.deallocate(large, SegmentPool::MAX_POOLED_SIZE + 1);
+
+  SegmentPool::Statistics stats = pool.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nLargeAllocations, 1);
+  BOOST_CHECK_EQUAL(stats.nAllocations, 0);
+  BOOST_CHECK_EQUAL(stats.nChunks, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SingleNode)
+{
+  SegmentPool pool;
+  if (pool.isNumaEnabled())
+    return;
+
+  BOOST_CHECK_EQUAL(pool.getNodeCount(), 1);
+  BOOST_CHECK_EQUAL(pool.getCurrentNode(), 0);
+  pool.deallocate(pool.allocate(2048), 2048);
+  BOOST_CHECK_EQUAL(pool.getStatistics().nCrossNodeFrees, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadCache)
+{
+  SegmentPool& pool = SegmentPool::get();
+  size_t batchSize = SegmentPool::getBatchSize(SegmentPool::getSizeClass(1024));
+  SegmentPool::Statistics before = pool.getStatistics();
+
+  std::thread([&] {
+    std::vector<void*> segments;
+    segments.push_back(pool.allocate(1024));
+    BOOST_CHECK_EQUAL(pool.getStatistics().nThreadCacheRefills, before.nThreadCacheRefills + 1);
+
+    // the rest of the batch is served without going back to the arena
+    for (size_t i = 1; i < batchSize; ++i) {
+      segments.push_back(pool.allocate(1024));
+    }
+    BOOST_CHECK_EQUAL(pool.getStatistics().nThreadCacheRefills, before.nThreadCacheRefills + 1);
+
+    // a freed segment is reused first
+    pool.deallocate(segments.back(), 1024);
+    BOOST_CHECK(pool.allocate(1024) == segments.back());
+
+    // the cache keeps up to two batches and returns one when it grows past that
+    while (segments.size() <= 2 * batchSize) {
+      segments.push_back(pool.allocate(1024));
+    }
+    for (void* segment : segments) {
+      pool.deallocate(segment, 1024);
+    }
+    BOOST_CHECK_EQUAL(pool.getStatistics().nThreadCacheFlushes, before.nThreadCacheFlushes + 1);
+  }).join();
+
+  // the rest is returned when the thread exits
+  SegmentPool::Statistics after = pool.getStatistics();
+  BOOST_CHECK_GT(after.nThreadCacheFlushes, before.nThreadCacheFlushes + 1);
+  BOOST_CHECK_EQUAL(after.nAllocations - before.nAllocations,
+                    after.nDeallocations - before.nDeallocations);
+}
+
+BOOST_AUTO_TEST_CASE(TransparentHugePages)
+{
+  SegmentPool pool;
+  pool.setHugePageMode(SegmentPool::HUGE_PAGE_TRANSPARENT);
+
+  uint8_t* segment = static_cast<uint8_t*>(pool.allocate(2048));
+  std::fill(segment, segment + 2048, 0xcc);
+
+  SegmentPool::Statistics stats = pool.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nChunks, 1);
+  BOOST_CHECK_EQUAL(stats.nHugePageChunks, 0);
+  BOOST_CHECK_EQUAL(stats.nTransparentHugePageChunks + stats.nHugePageFallbacks, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitHugePages)
+{
+  SegmentPool pool;
+  pool.setHugePageMode(SegmentPool::HUGE_PAGE_EXPLICIT);
+
+  // succeeds whether or not the hugetlbfs pool has pages to spare
+  uint8_t* segment = static_cast<uint8_t*>(pool.allocate(4096));
+  std::fill(segment, segment + 4096, 0xcc);
+  BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(segment) % 64, 0);
+
+  SegmentPool::Statistics stats = pool.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nChunks, 1);
+  BOOST_CHECK_EQUAL(stats.nHugePageChunks + stats.nHugePageFallbacks, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BufferFromPool)
+{
+  uint64_t nAllocations = SegmentPool::get().getStatistics().nAllocations;
+  Buffer buffer(2048);
+  BOOST_CHECK_EQUAL(SegmentPool::get().getStatistics().nAllocations, nAllocations + 1);
+  BOOST_CHECK_EQUAL(buffer[2047], 0);
+}
+
+/** @brief Return a pooled 2048-byte segment filled with 0xcc to the pool, and return its address
+ */
+static const uint8_t*
+releaseDirtySegment()
+{
+  Buffer dirty(2048, Buffer::UninitializedTag());
+  std::fill(dirty.begin(), dirty.end(), 0xcc);
+  return dirty.data();
+}
+
+BOOST_AUTO_TEST_CASE(UninitializedBuffer)
+{
+  uint64_t nAllocations = SegmentPool::get().getStatistics().nAllocations;
+  Buffer buffer(2048, Buffer::UninitializedTag());
+  BOOST_CHECK_EQUAL(buffer.size(), 2048);
+  BOOST_CHECK_EQUAL(SegmentPool::get().getStatistics().nAllocations, nAllocations + 1);
+  BOOST_CHECK(buffer.get_allocator().isDefaultInit());
+
+  buffer.resize(4096);
+  BOOST_CHECK_EQUAL(buffer.size(), 4096);
+
+  // the recycled segment keeps its old bytes, except the free list link at its start
+  const uint8_t* segment = releaseDirtySegment();
+  Buffer reused(2048, Buffer::UninitializedTag());
+  BOOST_REQUIRE(reused.data() == segment);
+  BOOST_CHECK_EQUAL(std::count(reused.begin() + 64, reused.end(), 0xcc), 2048 - 64);
+}
+
+BOOST_AUTO_TEST_CASE(ValueInitializedByDefault)
+{
+  const uint8_t* segment = releaseDirtySegment();
+  Buffer sized(2048);
+  BOOST_REQUIRE(sized.data() == segment);
+  BOOST_CHECK_EQUAL(std::count(sized.begin(), sized.end(), 0), 2048);
+  BOOST_CHECK(!sized.get_allocator().isDefaultInit());
+
+  segment = releaseDirtySegment();
+  Buffer resized;
+  resized.resize(2048);
+  BOOST_REQUIRE(resized.data() == segment);
+  BOOST_CHECK_EQUAL(std::count(resized.begin(), resized.end(), 0), 2048);
+
+  segment = releaseDirtySegment();
+  std::vector<uint8_t, SegmentAllocator<uint8_t>> vector(2048);
+  BOOST_REQUIRE(vector.data() == segment);
+  BOOST_CHECK_EQUAL(std::count(vector.begin(), vector.end(), 0), 2048);
+
+  // a copy of an uninitialized buffer value-initializes when it grows
+  Buffer uninitialized(16, Buffer::UninitializedTag());
+  Buffer copy(uninitialized);
+  BOOST_CHECK(!copy.get_allocator().isDefaultInit());
+}
+
+BOOST_AUTO_TEST_CASE(AdoptExternalMemory)
+{
+  static const uint8_t memory[] = {0x15, 0x03, 0x01, 0x02, 0x03};
+  int nReleases = 0;
+  uint64_t nAllocations = SegmentPool::get().getStatistics().nAllocations;
+
+  {
+    ConstBufferPtr buffer = make_shared<ExternalBuffer>(memory, sizeof(memory),
+                                                         [&nReleases] { ++nReleases; });
+    BOOST_CHECK(buffer->data() == memory);
+    BOOST_CHECK_EQUAL(buffer->size(), sizeof(memory));
+    BOOST_CHECK_EQUAL(SegmentPool::get().getStatistics().nAllocations, nAllocations);
+
+    Buffer copy(*buffer);
+    BOOST_CHECK(copy.data() != memory);
+    BOOST_CHECK_EQUAL_COLLECTIONS(copy.begin(), copy.end(), memory, memory + sizeof(memory));
+    BOOST_CHECK_EQUAL(nReleases, 0);
+  }
+  BOOST_CHECK_EQUAL(nReleases, 1);
+}
+
+BOOST_AUTO_TEST_CASE(AdoptExternalMemoryGrow)
+{
+  uint8_t memory[] = {0x01, 0x02};
+  int nReleases = 0;
+
+  ExternalBuffer buffer(memory, sizeof(memory), [&nReleases] { ++nReleases; });
+  buffer.push_back(0x03);
+  BOOST_CHECK(buffer.data() != memory);
+  BOOST_CHECK_EQUAL(nReleases, 1);
+  BOOST_CHECK_EQUAL(buffer.size(), 3);
+  BOOST_CHECK_EQUAL(buffer[1], 0x02);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
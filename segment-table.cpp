@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "segment-table.hpp"
+#include "fast-hash.hpp"
+
+namespace ndn {
+
+/** @brief Owner behind one intern() reference, counted in its entry while alive
+ */
+class SegmentTable::Reference : noncopyable
+{
+public:
+  Reference(const shared_ptr<const Buffer>& segment,
+            const shared_ptr<std::atomic<size_t>>& nReferences)
+    : m_segment(segment)
+    , m_nReferences(nReferences)
+  {
+    ++*m_nReferences;
+  }
+
+  ~Reference()
+  {
+    --*m_nReferences;
+  }
+
+private:
+  shared_ptr<const Buffer> m_segment;
+  shared_ptr<std::atomic<size_t>> m_nReferences;
+};
+
+SegmentTable::SegmentTable()
+  : m_nInsertsSinceCleanup(0)
+  , m_nHits(0)
+  , m_nMisses(0)
+{
+}
+
+shared_ptr<const Buffer>
+SegmentTable::makeReference(const Entry& entry, const shared_ptr<const Buffer>& segment)
+{
+  // the reference shares ownership of the Reference, but points to the segment bytes
+  return shared_ptr<const Buffer>(make_shared<Reference>(segment, entry.nReferences),
+                                  segment.get());
+}
+
+shared_ptr<const Buffer>
+SegmentTable::intern(const uint8_t* data, size_t size, const shared_ptr<const Buffer>& owner,
+                     bool* isFound)
+{
+  uint64_t hash = FastHash::compute(data, size);
+
+  auto range = m_entries.equal_range(hash);
+  for (auto i = range.first; i != range.second; ) {
+    shared_ptr<const Buffer> segment = i->second.segment.lock();
+    if (segment == nullptr) {
+      i = m_entries.erase(i);
+      continue;
+    }
+    if (segment->size() == size && std::memcmp(segment->data(), data, size) == 0) {
+      ++m_nHits;
+      if (isFound != nullptr)
+        *isFound = true;
+      return makeReference(i->second, segment);
+    }
+    ++i;
+  }
+
+  shared_ptr<const Buffer> segment;
+  if (owner != nullptr && owner->data() == data && owner->size() == size) {
+    segment = owner;
+  }
+  else {
+    segment = make_shared<Buffer>(data, size);
+  }
+  Entry entry{segment, make_shared<std::atomic<size_t>>(0)};
+  m_entries.insert(std::make_pair(hash, entry));
+  ++m_nMisses;
+  if (isFound != nullptr)
+    *isFound = false;
+
+  // expired entries of other hashes are dropped once the table has doubled since the last sweep
+  if (++m_nInsertsSinceCleanup > m_entries.size() / 2) {
+    cleanup();
+  }
+  return makeReference(entry, segment);
+}
+
+void
+SegmentTable::cleanup()
+{
+  for (auto i = m_entries.begin(); i != m_entries.end(); ) {
+    if (i->second.segment.expired())
+      i = m_entries.erase(i);
+    else
+      ++i;
+  }
+  m_nInsertsSinceCleanup = 0;
+}
+
+SegmentTable::Statistics
+SegmentTable::getStatistics() const
+{
+  Statistics stats;
+  stats.nEntries = 0;
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nUniqueBytes = 0;
+  stats.nSavedBytes = 0;
+  for (const auto& entry : m_entries) {
+    shared_ptr<const Buffer> segment = entry.second.segment.lock();
+    if (segment == nullptr)
+      continue;
+
+    ++stats.nEntries;
+    stats.nUniqueBytes += segment->size();
+    size_t nReferences = *entry.second.nReferences;
+    if (nReferences > 1)
+      stats.nSavedBytes += (nReferences - 1) * segment->size();
+  }
+  return stats;
+}
+
+} // namespace ndn
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_SEGMENT_TABLE_HPP
+#define NDN_ENCODING_SEGMENT_TABLE_HPP
+
+#include "buffer.hpp"
+
+#include <atomic>
+#include <unordered_map>
+
+namespace ndn {
+
+/** @brief Content-addressed table of immutable segments, so that identical payloads share
+ *         one Buffer
+ *
+ *  The table only holds weak references: a segment is kept alive by the blocks sharing it and
+ *  leaves the table when the last of them is gone.  Lookups hash the bytes with FastHash and
+ *  confirm a match with memcmp.
+ *
+ *  Every intern() call returns a reference of its own to the segment, and copies of it, e.g.
+ *  in copies of a frozen Wire, count as that one reference.  This lets the table tell how
+ *  many copies of a payload sharing saves, whatever else refers to the segment.
+ *
+ *  The table is not thread-safe, but the returned references may be released on any thread.
+ *  @sa Wire::freeze
+ */
+class SegmentTable : noncopyable
+{
+public:
+  /** @brief Snapshot of table counters
+   */
+  struct Statistics
+  {
+    size_t nEntries;       ///< live interned segments
+    uint64_t nHits;        ///< intern() calls that found an identical segment
+    uint64_t nMisses;      ///< intern() calls that added a segment
+    size_t nUniqueBytes;   ///< bytes held by live interned segments
+    size_t nSavedBytes;    ///< bytes the live intern() references would hold without
+                           ///< sharing, minus nUniqueBytes
+  };
+
+  SegmentTable();
+
+  /** @brief Return a segment holding the @p size bytes at @p data
+   *
+   *  If an identical segment is in the table, it is returned.  Otherwise @p owner is added
+   *  when it holds exactly these bytes, or else a right-sized copy is made and added.
+   *  @param[out] isFound if not nullptr, set to whether an identical segment was found
+   *  @return a new reference to the segment, see the class description
+   */
+  shared_ptr<const Buffer>
+  intern(const uint8_t* data, size_t size, const shared_ptr<const Buffer>& owner = nullptr,
+         bool* isFound = nullptr);
+
+  /** @brief Drop entries whose segment is no longer referenced
+   */
+  void
+  cleanup();
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  /** @brief Return counters, including the memory currently saved by sharing
+   *
+   *  This walks all entries.
+   */
+  Statistics
+  getStatistics() const;
+
+private:
+  class Reference;
+
+  struct Entry
+  {
+    weak_ptr<const Buffer> segment;
+    shared_ptr<std::atomic<size_t>> nReferences; ///< live intern() references
+  };
+
+  /** @brief Return a new intern() reference to the segment of @p entry
+   */
+  static shared_ptr<const Buffer>
+  makeReference(const Entry& entry, const shared_ptr<const Buffer>& segment);
+
+private:
+  typedef std::unordered_multimap<uint64_t, Entry> EntryMap;
+  EntryMap m_entries;
+  size_t m_nInsertsSinceCleanup;
+  uint64_t m_nHits;
+  uint64_t m_nMisses;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_SEGMENT_TABLE_HPP
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/segment-table.hpp"
+
+#include "boost-test.hpp"
+#include "make-data.hpp"
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingSegmentTable)
+
+BOOST_AUTO_TEST_CASE(Intern)
+{
+  uint8_t bytes[100];
+  for (size_t i = 0; i < sizeof(bytes); ++i) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+
+  SegmentTable table;
+  auto owner = make_shared<Buffer>(bytes, sizeof(bytes));
+  shared_ptr<const Buffer> first = table.intern(owner->data(), owner->size(), owner);
+  BOOST_CHECK(first == owner);
+
+  // a slice of another buffer is copied on a miss
+  shared_ptr<const Buffer> half = table.intern(bytes, 50);
+  BOOST_CHECK_EQUAL(half->size(), 50);
+  BOOST_CHECK(half->data() != bytes);
+
+  shared_ptr<const Buffer> second = table.intern(bytes, sizeof(bytes));
+  BOOST_CHECK(second == owner);
+
+  SegmentTable::Statistics stats = table.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nEntries, 2);
+  BOOST_CHECK_EQUAL(stats.nHits, 1);
+  BOOST_CHECK_EQUAL(stats.nMisses, 2);
+  BOOST_CHECK_EQUAL(stats.nUniqueBytes, 150);
+
+  // segments leave the table once unreferenced
+  owner.reset();
+  first.reset();
+  second.reset();
+  table.cleanup();
+  BOOST_CHECK_EQUAL(table.size(), 1);
+}
+
+static Wire
+makeDataWithContent(const uint8_t* content, size_t contentSize, uint8_t seq)
+{
+  Wire wire(2048);
+  appendData(wire, {0x07, 0x04, 0x08, 0x02, 'a', seq}, content, contentSize, {0x17, 0x01, seq});
+  return wire;
+}
+
+BOOST_AUTO_TEST_CASE(FreezeData)
+{
+  uint8_t content[3000];
+  for (size_t i = 0; i < sizeof(content); ++i) {
+    content[i] = static_cast<uint8_t>(i * 3);
+  }
+
+  SegmentTable table;
+  Wire a = makeDataWithContent(content, 3000, 1); // spans two segments
+  Wire b = makeDataWithContent(content, 3000, 2);
+  Wire c = makeDataWithContent(content, 1500, 3);
+  Wire small = makeDataWithContent(content, 100, 4);
+
+  BOOST_CHECK_EQUAL(a.freeze(table), 0);
+  BOOST_CHECK_EQUAL(b.freeze(table), 3000);
+  BOOST_CHECK_EQUAL(c.freeze(table), 0);
+  BOOST_CHECK_EQUAL(small.freeze(table), 0);
+
+  // header, content and trailer
+  BOOST_CHECK_EQUAL(a.countBlock(), 3);
+  BOOST_CHECK_EQUAL(b.countBlock(), 3);
+  BOOST_CHECK_EQUAL(small.countBlock(), 1);
+  BOOST_CHECK(a == makeDataWithContent(content, 3000, 1));
+  BOOST_CHECK(b == makeDataWithContent(content, 3000, 2));
+  BOOST_CHECK(c == makeDataWithContent(content, 1500, 3));
+
+  SegmentTable::Statistics stats = table.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nEntries, 2);
+  BOOST_CHECK_EQUAL(stats.nHits, 1);
+  BOOST_CHECK_EQUAL(stats.nUniqueBytes, 4500);
+  BOOST_CHECK_EQUAL(stats.nSavedBytes, 3000);
+
+  // not a Data packet
+  Wire interest(64);
+  const uint8_t bytes[] = {0x05, 0x01, 0x00};
+  interest.appendArray(bytes, sizeof(bytes));
+  BOOST_CHECK_EQUAL(interest.freeze(table), 0);
+  BOOST_CHECK_EQUAL(interest.countBlock(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SavedBytesAndExpiry)
+{
+  uint8_t content[2000];
+  std::fill(content, content + sizeof(content), 0x5A);
+
+  SegmentTable table;
+  {
+    Wire a = makeDataWithContent(content, 2000, 1);
+    a.freeze(table);
+    // copies of a frozen packet share its reference
+    std::vector<Wire> copies(3, a);
+    BOOST_CHECK_EQUAL(table.getStatistics().nSavedBytes, 0);
+
+    {
+      Wire b = makeDataWithContent(content, 2000, 2);
+      BOOST_CHECK_EQUAL(b.freeze(table), 2000);
+      Wire copy(b);
+      BOOST_CHECK_EQUAL(table.getStatistics().nSavedBytes, 2000);
+    }
+    SegmentTable::Statistics stats = table.getStatistics();
+    BOOST_CHECK_EQUAL(stats.nEntries, 1);
+    BOOST_CHECK_EQUAL(stats.nSavedBytes, 0);
+  }
+
+  // the segment expires with the last frozen wire
+  SegmentTable::Statistics stats = table.getStatistics();
+  BOOST_CHECK_EQUAL(stats.nEntries, 0);
+  BOOST_CHECK_EQUAL(stats.nUniqueBytes, 0);
+  table.cleanup();
+  BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/sha256-batch.hpp"
+
+#include "boost-test.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+/** @brief Print the throughput of @p hashAll, which hashes @p nPackets packets of
+ *         @p packetSize bytes
+ */
+template<typename HashAll>
+static void
+measure(const std::string& label, size_t packetSize, size_t nPackets, const HashAll& hashAll)
+{
+  const size_t N_ROUNDS = 5;
+  hashAll(); // warm up
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < N_ROUNDS; ++round) {
+    hashAll();
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+  double nPacketsPerSecond = nPackets * N_ROUNDS / time.count();
+  std::cout << std::setw(6) << packetSize << " B  " << std::setw(32) << std::left << label
+            << std::right << std::setw(10) << std::fixed << std::setprecision(0)
+            << nPacketsPerSecond << " packets/s " << std::setw(8)
+            << nPacketsPerSecond * packetSize / 1e6 << " MB/s" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(Sha256BatchThroughput)
+{
+  const size_t BYTES_PER_SIZE = 32 * 1024 * 1024;
+
+  for (size_t packetSize : {100, 1024, 8192}) {
+    // packets of two segments, as a header encoded in front of a shared payload
+    std::vector<uint8_t> payload(packetSize);
+    std::vector<Wire> wires;
+    for (size_t i = 0; i < BYTES_PER_SIZE / packetSize; ++i) {
+      Wire wire(16);
+      uint8_t header[4] = {0x06, 0xFD, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+      wire.appendArray(header, sizeof(header));
+      wire.appendSharedBlock(BlockN(payload.data(), packetSize - sizeof(header)));
+      wires.push_back(wire);
+    }
+    std::vector<const Wire*> pointers;
+    for (const Wire& wire : wires) {
+      pointers.push_back(&wire);
+    }
+    std::vector<uint8_t> digests(wires.size() * Sha256::DIGEST_SIZE);
+
+    Sha256::Implementation original = Sha256::getImplementation();
+    for (Sha256::Implementation implementation : {Sha256::IMPLEMENTATION_PORTABLE,
+                                                  Sha256::IMPLEMENTATION_SHA_NI}) {
+      if (!Sha256::setImplementation(implementation))
+        continue;
+      measure(implementation == Sha256::IMPLEMENTATION_PORTABLE ?
+              "loop, portable" : "loop, SHA-NI", packetSize, wires.size(), [&] {
+        for (const Wire& wire : wires) {
+          wire.computeSha256Digest(0, wire.size());
+        }
+      });
+    }
+    Sha256::setImplementation(original);
+
+    Sha256Batch::Options options;
+    options.nThreads = 1;
+    Sha256Batch singleThread(options);
+    if (singleThread.setKernel(Sha256Batch::KERNEL_SHA_NI_X2)) {
+      measure("batch, SHA-NI x2, 1 thread", packetSize, wires.size(), [&] {
+        singleThread.compute(pointers.data(), pointers.size(), digests.data());
+      });
+    }
+    if (singleThread.setKernel(Sha256Batch::KERNEL_AVX2)) {
+      measure("batch, AVX2 x8, 1 thread", packetSize, wires.size(), [&] {
+        singleThread.compute(pointers.data(), pointers.size(), digests.data());
+      });
+    }
+
+    Sha256Batch batch;
+    measure("batch, default, " + std::to_string(Sha256Batch::Options().nThreads) + " threads",
+            packetSize, wires.size(), [&] {
+      batch.compute(pointers.data(), pointers.size(), digests.data());
+    });
+  }
+}
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,549 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "sha256-batch.hpp"
+#include "endian.hpp"
+
+#include <atomic>
+
+#include <boost/asio/buffer.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NDN_ENCODING_SHA256_BATCH_X86
+#include <immintrin.h>
+#endif
+
+namespace ndn {
+
+static const size_t CHUNK_SIZE = 64; ///< packets claimed by a thread at a time
+
+struct Sha256Batch::Job
+{
+  Job(const Wire* const* wires, size_t nWires, uint8_t* digests, size_t nThreads)
+    : wires(wires)
+    , nWires(nWires)
+    , digests(digests)
+    , nThreads(nThreads)
+    , next(0)
+  {
+  }
+
+  const Wire* const* wires;
+  size_t nWires;
+  uint8_t* digests;
+  size_t nThreads;          ///< threads taking part, including the caller
+  std::atomic<size_t> next; ///< first packet not claimed yet
+
+  /** @brief Claim the next packet, taking a new chunk from the job when @p begin reaches @p end
+   *  @return false when every packet is claimed
+   */
+  bool
+  claim(size_t& begin, size_t& end, size_t& index)
+  {
+    if (begin == end) {
+      begin = next.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+      if (begin >= nWires) {
+        end = begin;
+        return false;
+      }
+      end = std::min(begin + CHUNK_SIZE, nWires);
+    }
+    index = begin++;
+    return true;
+  }
+};
+
+static void
+hashSingleStream(const Wire& wire, uint8_t* digest)
+{
+  Sha256 sha256;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    size_t size = (*i).size();
+    if (size > 0)
+      sha256.update(static_cast<const uint8_t*>((*i).data()), size);
+  }
+  sha256.digest(digest);
+}
+
+#ifdef NDN_ENCODING_SHA256_BATCH_X86
+
+static bool
+hasAvx2()
+{
+  return __builtin_cpu_supports("avx2");
+}
+
+/** @brief Message of one lane, read as 64-byte blocks from the segments of a Wire,
+ *         followed by the padding blocks
+ */
+class LaneReader
+{
+public:
+  void
+  start(const Wire& wire)
+  {
+    m_segment = wire.begin();
+    m_position = nullptr;
+    m_segmentSize = 0;
+    m_totalLength = wire.size();
+    m_remaining = m_totalLength;
+    m_nTailBlocks = 0;
+    m_nReturnedTailBlocks = 0;
+  }
+
+  /** @return the next block, nullptr after the last one
+   */
+  const uint8_t*
+  next()
+  {
+    if (m_remaining >= 64) {
+      m_remaining -= 64;
+      while (m_segmentSize == 0) {
+        loadSegment();
+      }
+      if (m_segmentSize < 64) {
+        gather(m_staging, 64);
+        return m_staging;
+      }
+      const uint8_t* block = m_position;
+      m_position += 64;
+      m_segmentSize -= 64;
+      return block;
+    }
+
+    if (m_nTailBlocks == 0) {
+      size_t tailSize = static_cast<size_t>(m_remaining);
+      gather(m_staging, tailSize);
+      m_remaining = 0;
+      m_nTailBlocks = tailSize + 9 <= 64 ? 1 : 2;
+      std::memset(m_staging + tailSize, 0, 64 * m_nTailBlocks - tailSize);
+      m_staging[tailSize] = 0x80;
+      uint64_t nBits = htobe64(m_totalLength * 8);
+      std::memcpy(m_staging + 64 * m_nTailBlocks - 8, &nBits, sizeof(nBits));
+    }
+    if (m_nReturnedTailBlocks == m_nTailBlocks)
+      return nullptr;
+    return m_staging + 64 * m_nReturnedTailBlocks++;
+  }
+
+private:
+  void
+  loadSegment()
+  {
+    m_position = static_cast<const uint8_t*>((*m_segment).data());
+    m_segmentSize = (*m_segment).size();
+    ++m_segment;
+  }
+
+  void
+  gather(uint8_t* destination, size_t size)
+  {
+    while (size > 0) {
+      while (m_segmentSize == 0) {
+        loadSegment();
+      }
+      size_t toCopy = std::min(size, m_segmentSize);
+      std::memcpy(destination, m_position, toCopy);
+      destination += toCopy;
+      size -= toCopy;
+      m_position += toCopy;
+      m_segmentSize -= toCopy;
+    }
+  }
+
+private:
+  Wire::const_iterator m_segment;
+  const uint8_t* m_position;
+  size_t m_segmentSize;         ///< bytes left in the current segment
+  uint64_t m_totalLength;
+  uint64_t m_remaining;         ///< bytes of the message not returned in a block yet
+  size_t m_nTailBlocks;         ///< blocks holding the last bytes and the padding, 0 until built
+  size_t m_nReturnedTailBlocks;
+  uint8_t m_staging[128];
+};
+
+__attribute__((target("avx2")))
+static inline __m256i
+rotateRight(__m256i x, int bits)
+{
+  return _mm256_or_si256(_mm256_srli_epi32(x, bits), _mm256_slli_epi32(x, 32 - bits));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i
+add(__m256i a, __m256i b)
+{
+  return _mm256_add_epi32(a, b);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i
+exclusiveOr(__m256i a, __m256i b, __m256i c)
+{
+  return _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+}
+
+/** @brief Load word @p 8 * @p half + j of the block of each lane l into element l of
+ *         @p w[8 * @p half + j], transposing the 8x8 matrix of words
+ */
+__attribute__((target("avx2")))
+static inline void
+loadWords(__m256i* w, const uint8_t* const* blocks, int half)
+{
+  const __m256i byteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                           12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  __m256i r[8];
+  for (int l = 0; l < 8; ++l) {
+    r[l] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[l] + 32 * half));
+  }
+  __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+  __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+  __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+  __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+  __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+  __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+  __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+  __m256i u[8] = {
+    _mm256_unpacklo_epi64(t0, t2), _mm256_unpackhi_epi64(t0, t2),
+    _mm256_unpacklo_epi64(t1, t3), _mm256_unpackhi_epi64(t1, t3),
+    _mm256_unpacklo_epi64(t4, t6), _mm256_unpackhi_epi64(t4, t6),
+    _mm256_unpacklo_epi64(t5, t7), _mm256_unpackhi_epi64(t5, t7)
+  };
+  // u[j] holds word j of lanes 0-3 and word j + 4 of lanes 4-7, and the other way round
+  for (int j = 0; j < 4; ++j) {
+    w[8 * half + j] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[j], u[j + 4], 0x20),
+                                          byteSwap);
+    w[8 * half + j + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[j], u[j + 4], 0x31),
+                                              byteSwap);
+  }
+}
+
+/** @brief Compress one block of each of eight messages, @p state[i][l] being word i of the
+ *         state of lane l
+ */
+__attribute__((target("avx2")))
+static void
+compressAvx2(uint32_t (*state)[8], const uint8_t* const* blocks)
+{
+  __m256i w[16];
+  loadWords(w, blocks, 0);
+  loadWords(w, blocks, 1);
+
+  __m256i v[8];
+  for (int i = 0; i < 8; ++i) {
+    v[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[i]));
+  }
+  __m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+
+  for (int i = 0; i < 64; ++i) {
+    if (i >= 16) {
+      __m256i w15 = w[(i + 1) & 15];
+      __m256i w2 = w[(i + 14) & 15];
+      __m256i s0 = exclusiveOr(rotateRight(w15, 7), rotateRight(w15, 18),
+                               _mm256_srli_epi32(w15, 3));
+      __m256i s1 = exclusiveOr(rotateRight(w2, 17), rotateRight(w2, 19),
+                               _mm256_srli_epi32(w2, 10));
+      w[i & 15] = add(add(w[i & 15], s0), add(w[(i + 9) & 15], s1));
+    }
+
+    __m256i s1 = exclusiveOr(rotateRight(e, 6), rotateRight(e, 11), rotateRight(e, 25));
+    __m256i choice = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+    __m256i t1 = add(add(add(h, s1), add(choice, w[i & 15])),
+                     _mm256_set1_epi32(static_cast<int>(Sha256::ROUND_CONSTANTS[i])));
+    __m256i s0 = exclusiveOr(rotateRight(a, 2), rotateRight(a, 13), rotateRight(a, 22));
+    __m256i majority = _mm256_or_si256(_mm256_and_si256(a, b),
+                                       _mm256_and_si256(c, _mm256_or_si256(a, b)));
+    h = g;
+    g = f;
+    f = e;
+    e = add(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = add(t1, add(s0, majority));
+  }
+
+  __m256i result[8] = {a, b, c, d, e, f, g, h};
+  for (int i = 0; i < 8; ++i) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(state[i]), add(v[i], result[i]));
+  }
+}
+
+/** @brief Compress one block of each of two messages, interleaving their SHA-NI rounds so
+ *         that each hides the latency of the other
+ *
+ *  The state of each lane is kept as ABEF and CDGH, as by the single-stream SHA-NI kernel.
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+static void
+compressShaNiX2(uint32_t (*state)[2], const uint8_t* const* blocks)
+{
+  const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i abef[2];
+  __m128i cdgh[2];
+  __m128i saved[2][2];
+  __m128i w[2][4];
+  for (int s = 0; s < 2; ++s) {
+    abef[s] = _mm_set_epi32(state[0][s], state[1][s], state[4][s], state[5][s]);
+    cdgh[s] = _mm_set_epi32(state[2][s], state[3][s], state[6][s], state[7][s]);
+    saved[s][0] = abef[s];
+    saved[s][1] = cdgh[s];
+    for (int i = 0; i < 4; ++i) {
+      const __m128i* words = reinterpret_cast<const __m128i*>(blocks[s] + 16 * i);
+      w[s][i] = _mm_shuffle_epi8(_mm_loadu_si128(words), byteSwap);
+    }
+  }
+
+  for (int i = 0; i < 16; ++i) {
+    __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Sha256::ROUND_CONSTANTS + 4 * i));
+    for (int s = 0; s < 2; ++s) {
+      __m128i wk = _mm_add_epi32(w[s][i & 3], k);
+      cdgh[s] = _mm_sha256rnds2_epu32(cdgh[s], abef[s], wk);
+      abef[s] = _mm_sha256rnds2_epu32(abef[s], cdgh[s], _mm_shuffle_epi32(wk, 0x0E));
+    }
+    if (i < 12) {
+      for (int s = 0; s < 2; ++s) {
+        __m128i next = _mm_sha256msg1_epu32(w[s][i & 3], w[s][(i + 1) & 3]);
+        next = _mm_add_epi32(next, _mm_alignr_epi8(w[s][(i + 3) & 3], w[s][(i + 2) & 3], 4));
+        w[s][i & 3] = _mm_sha256msg2_epu32(next, w[s][(i + 3) & 3]);
+      }
+    }
+  }
+
+  for (int s = 0; s < 2; ++s) {
+    alignas(16) uint32_t words[2][4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words[0]), _mm_add_epi32(abef[s], saved[s][0]));
+    _mm_store_si128(reinterpret_cast<__m128i*>(words[1]), _mm_add_epi32(cdgh[s], saved[s][1]));
+    // ABEF and CDGH, with A and C in the highest element
+    state[0][s] = words[0][3];
+    state[1][s] = words[0][2];
+    state[4][s] = words[0][1];
+    state[5][s] = words[0][0];
+    state[2][s] = words[1][3];
+    state[3][s] = words[1][2];
+    state[6][s] = words[1][1];
+    state[7][s] = words[1][0];
+  }
+}
+
+/** @brief Hash the packets handed out by @p claim, N_LANES at a time
+ *
+ *  @p compress takes the state as @p state[i][l], word i of lane l, and the next block of each
+ *  lane.  A lane without a packet left is fed a dummy block.
+ *  @param claim bool(size_t& index), setting the index of the next packet if there is one
+ */
+template<size_t N_LANES, typename Claim>
+static void
+hashLanes(void (*compress)(uint32_t (*)[N_LANES], const uint8_t* const*),
+          const Wire* const* wires, uint8_t* digests, const Claim& claim)
+{
+  static const uint8_t idleBlock[64] = {};
+
+  LaneReader readers[N_LANES];
+  size_t indices[N_LANES];
+  const uint8_t* blocks[N_LANES];
+  alignas(32) uint32_t state[8][N_LANES];
+  size_t nActive = 0;
+
+  auto startLane = [&] (size_t l) {
+    if (!claim(indices[l]))
+      return false;
+    readers[l].start(*wires[indices[l]]);
+    for (int i = 0; i < 8; ++i) {
+      state[i][l] = Sha256::INITIAL_STATE[i];
+    }
+    return true;
+  };
+
+  for (size_t l = 0; l < N_LANES; ++l) {
+    blocks[l] = idleBlock;
+    if (startLane(l)) {
+      blocks[l] = nullptr;
+      ++nActive;
+    }
+  }
+
+  while (nActive > 0) {
+    for (size_t l = 0; l < N_LANES; ++l) {
+      if (blocks[l] == idleBlock)
+        continue;
+      blocks[l] = readers[l].next();
+      if (blocks[l] != nullptr)
+        continue;
+
+      // the message of the lane is done: emit its digest and start the next packet
+      uint8_t* digest = digests + indices[l] * Sha256::DIGEST_SIZE;
+      for (int i = 0; i < 8; ++i) {
+        uint32_t word = htobe32(state[i][l]);
+        std::memcpy(digest + 4 * i, &word, sizeof(word));
+      }
+      if (startLane(l)) {
+        blocks[l] = readers[l].next();
+      }
+      else {
+        blocks[l] = idleBlock;
+        --nActive;
+      }
+    }
+    if (nActive > 0)
+      compress(state, blocks);
+  }
+}
+
+#endif // NDN_ENCODING_SHA256_BATCH_X86
+
+Sha256Batch::Sha256Batch(const Options& options)
+  : m_options(options)
+  , m_kernel(KERNEL_SINGLE_STREAM)
+  , m_job(nullptr)
+  , m_jobId(0)
+  , m_nBusyWorkers(0)
+  , m_isStopping(false)
+{
+  if (!setKernel(KERNEL_SHA_NI_X2))
+    setKernel(KERNEL_AVX2);
+
+  for (size_t i = 1; i < m_options.nThreads; ++i) {
+    m_workers.emplace_back(&Sha256Batch::runWorker, this);
+  }
+}
+
+Sha256Batch::~Sha256Batch()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_jobPosted.notify_all();
+  for (std::thread& worker : m_workers) {
+    worker.join();
+  }
+}
+
+bool
+Sha256Batch::setKernel(Kernel kernel)
+{
+  switch (kernel) {
+  case KERNEL_SINGLE_STREAM:
+    m_kernel = kernel;
+    return true;
+  case KERNEL_SHA_NI_X2:
+#ifdef NDN_ENCODING_SHA256_BATCH_X86
+    if (Sha256::isSupported(Sha256::IMPLEMENTATION_SHA_NI)) {
+      m_kernel = kernel;
+      return true;
+    }
+#endif // NDN_ENCODING_SHA256_BATCH_X86
+    return false;
+  case KERNEL_AVX2:
+#ifdef NDN_ENCODING_SHA256_BATCH_X86
+    if (hasAvx2()) {
+      m_kernel = kernel;
+      return true;
+    }
+#endif // NDN_ENCODING_SHA256_BATCH_X86
+    return false;
+  }
+  return false;
+}
+
+void
+Sha256Batch::compute(const Wire* const* wires, size_t nWires, uint8_t* digests)
+{
+  size_t nBytes = 0;
+  for (size_t i = 0; i < nWires; ++i) {
+    nBytes += wires[i]->size();
+  }
+  size_t nThreads = std::min(m_workers.size() + 1, nBytes / m_options.minBytesPerThread);
+  nThreads = std::min(nThreads, (nWires + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  Job job(wires, nWires, digests, std::max<size_t>(nThreads, 1));
+
+  if (job.nThreads > 1) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_job = &job;
+      ++m_jobId;
+    }
+    m_jobPosted.notify_all();
+  }
+
+  work(job);
+
+  if (job.nThreads > 1) {
+    // a worker waking up after this sees no job
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobDone.wait(lock, [this] { return m_nBusyWorkers == 0; });
+    m_job = nullptr;
+  }
+}
+
+void
+Sha256Batch::work(Job& job)
+{
+  size_t begin = 0;
+  size_t end = 0;
+  size_t index = 0;
+
+#ifdef NDN_ENCODING_SHA256_BATCH_X86
+  auto claim = [&] (size_t& index) { return job.claim(begin, end, index); };
+  switch (m_kernel) {
+  case KERNEL_SHA_NI_X2:
+    hashLanes<2>(&compressShaNiX2, job.wires, job.digests, claim);
+    return;
+  case KERNEL_AVX2:
+    hashLanes<8>(&compressAvx2, job.wires, job.digests, claim);
+    return;
+  case KERNEL_SINGLE_STREAM:
+    break;
+  }
+#endif // NDN_ENCODING_SHA256_BATCH_X86
+
+  while (job.claim(begin, end, index)) {
+    hashSingleStream(*job.wires[index], job.digests + index * Sha256::DIGEST_SIZE);
+  }
+}
+
+void
+Sha256Batch::runWorker()
+{
+  uint64_t lastJobId = 0;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_jobPosted.wait(lock, [&] { return m_isStopping || m_jobId != lastJobId; });
+    if (m_isStopping)
+      return;
+    lastJobId = m_jobId;
+    if (m_job == nullptr || m_nBusyWorkers + 1 >= m_job->nThreads)
+      continue;
+
+    Job& job = *m_job;
+    ++m_nBusyWorkers;
+    lock.unlock();
+    work(job);
+    lock.lock();
+    if (--m_nBusyWorkers == 0)
+      m_jobDone.notify_all();
+  }
+}
+
+} // namespace ndn
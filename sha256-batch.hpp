@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_SHA256_BATCH_HPP
+#define NDN_ENCODING_SHA256_BATCH_HPP
+
+#include "wire_test.hpp"
+#include "sha256.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+
+/** @brief Computes the SHA-256 digests of many packets at once
+ *
+ *  A single SHA-256 stream runs its 64 rounds one after the other, so hashing small packets
+ *  one by one leaves execution units idle.  A multi-buffer kernel instead hashes several
+ *  packets at a time, one per lane: each step compresses the next block of every lane, and a
+ *  lane whose packet is done is refilled with the next one.  With the SHA extensions, two
+ *  packets are interleaved so that the rounds of one run during the latency of the other;
+ *  otherwise with AVX2, eight packets are hashed in the 32-bit lanes of the vector registers.
+ *  Blocks are read in place from the segments of each Wire; only a block straddling two
+ *  segments and the padded last blocks are staged.
+ *
+ *  A batch of more than Options::minBytesPerThread bytes is split among worker threads,
+ *  which take chunks of packets along with the calling thread.
+ *
+ *  compute() must not be called concurrently on the same batch.
+ */
+class Sha256Batch : noncopyable
+{
+public:
+  struct Options
+  {
+    Options()
+      : nThreads(std::max(1u, std::thread::hardware_concurrency()))
+      , minBytesPerThread(256 * 1024)
+    {
+    }
+
+    size_t nThreads;          ///< threads hashing a large batch, including the caller
+    size_t minBytesPerThread; ///< bytes below which a batch is not worth another thread
+  };
+
+  enum Kernel {
+    KERNEL_SINGLE_STREAM, ///< one packet after another, with Sha256
+    KERNEL_SHA_NI_X2,     ///< two packets at once, with the SHA extensions
+    KERNEL_AVX2           ///< eight packets at once, in AVX2 lanes
+  };
+
+  explicit
+  Sha256Batch(const Options& options = Options());
+
+  ~Sha256Batch();
+
+  /** @brief Write the digest of @p wires[i] to @p digests + i * Sha256::DIGEST_SIZE,
+   *         for each i below @p nWires
+   */
+  void
+  compute(const Wire* const* wires, size_t nWires, uint8_t* digests);
+
+  /** @brief Return the kernel hashing the packets
+   *
+   *  It defaults to KERNEL_SHA_NI_X2 when the CPU has the SHA extensions, which outrun eight
+   *  AVX2 lanes, then to KERNEL_AVX2, then to KERNEL_SINGLE_STREAM.
+   */
+  Kernel
+  getKernel() const
+  {
+    return m_kernel;
+  }
+
+  /** @brief Use @p kernel from now on
+   *  @return false if the CPU does not support it
+   */
+  bool
+  setKernel(Kernel kernel);
+
+private:
+  struct Job;
+
+  /** @brief Hash chunks of the current job until none is left
+   */
+  void
+  work(Job& job);
+
+  void
+  runWorker();
+
+private:
+  Options m_options;
+  Kernel m_kernel;
+
+  std::mutex m_mutex;
+  std::condition_variable m_jobPosted;
+  std::condition_variable m_jobDone;
+  Job* m_job;
+  uint64_t m_jobId;
+  size_t m_nBusyWorkers;
+  bool m_isStopping;
+  std::vector<std::thread> m_workers;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_SHA256_BATCH_HPP
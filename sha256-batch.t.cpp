@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/sha256-batch.hpp"
+
+#include "boost-test.hpp"
+
+#include <random>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingSha256Batch)
+
+/** @brief Make @p nWires packets of random sizes up to @p maxSize, split at random offsets
+ */
+static std::vector<Wire>
+makeWires(size_t nWires, size_t maxSize, uint32_t seed)
+{
+  std::mt19937 random(seed);
+  std::vector<Wire> wires;
+  for (size_t i = 0; i < nWires; ++i) {
+    std::vector<uint8_t> bytes(random() % (maxSize + 1));
+    for (uint8_t& byte : bytes) {
+      byte = static_cast<uint8_t>(random());
+    }
+
+    Wire wire(64);
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+      size_t size = std::min<size_t>(bytes.size() - offset, 1 + random() % 200);
+      if (random() % 2 == 0)
+        wire.appendArray(bytes.data() + offset, size);
+      else
+        wire.appendSharedBlock(BlockN(bytes.data() + offset, size));
+      offset += size;
+    }
+    wires.push_back(wire);
+  }
+  return wires;
+}
+
+static void
+checkBatch(Sha256Batch& batch, const std::vector<Wire>& wires)
+{
+  std::vector<const Wire*> pointers;
+  for (const Wire& wire : wires) {
+    pointers.push_back(&wire);
+  }
+  std::vector<uint8_t> digests(wires.size() * Sha256::DIGEST_SIZE);
+  batch.compute(pointers.data(), pointers.size(), digests.data());
+
+  for (size_t i = 0; i < wires.size(); ++i) {
+    ConstBufferPtr expected = wires[i].computeSha256Digest(0, wires[i].size());
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(digests.begin() + i * Sha256::DIGEST_SIZE,
+                                    digests.begin() + (i + 1) * Sha256::DIGEST_SIZE,
+                                    expected->begin(), expected->end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Kernels)
+{
+  std::vector<Wire> wires = makeWires(300, 1500, 1);
+
+  Sha256Batch::Options options;
+  options.nThreads = 1;
+  Sha256Batch batch(options);
+  for (Sha256Batch::Kernel kernel : {Sha256Batch::KERNEL_SINGLE_STREAM,
+                                     Sha256Batch::KERNEL_SHA_NI_X2,
+                                     Sha256Batch::KERNEL_AVX2}) {
+    if (!batch.setKernel(kernel))
+      continue;
+    BOOST_TEST_MESSAGE("kernel " << kernel);
+    checkBatch(batch, wires);
+    checkBatch(batch, makeWires(3, 200, 2)); // fewer packets than lanes
+    checkBatch(batch, {});
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Threads)
+{
+  Sha256Batch::Options options;
+  options.nThreads = 4;
+  options.minBytesPerThread = 1;
+  Sha256Batch batch(options);
+  for (uint32_t seed = 0; seed < 20; ++seed) {
+    checkBatch(batch, makeWires(500, 300, seed));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "sha256.hpp"
+#include "endian.hpp"
+
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NDN_ENCODING_SHA256_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace ndn {
+
+const uint32_t Sha256::INITIAL_STATE[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+const uint32_t Sha256::ROUND_CONSTANTS[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t* const K = Sha256::ROUND_CONSTANTS;
+
+typedef void (*CompressFunction)(uint32_t* state, const uint8_t* data, size_t nBlocks);
+
+static inline uint32_t
+rotateRight(uint32_t value, int bits)
+{
+  return (value >> bits) | (value << (32 - bits));
+}
+
+static inline uint32_t
+readUint32(const uint8_t* p)
+{
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return be32toh(value);
+}
+
+static void
+compressPortable(uint32_t* state, const uint8_t* data, size_t nBlocks)
+{
+  for (; nBlocks > 0; --nBlocks, data += 64) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = readUint32(data + 4 * i);
+    }
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+      uint32_t t1 = h + s1 + ((e & f) ^ (~e & g)) + K[i] + w[i];
+      uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+      uint32_t t2 = s0 + ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#ifdef NDN_ENCODING_SHA256_X86
+
+static bool
+hasShaNi()
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1))
+    return false;
+  return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 29)); // SHA
+}
+
+/** @brief Compress with the SHA extensions, which keep the state as ABEF and CDGH and run
+ *         two rounds per sha256rnds2
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+static void
+compressShaNi(uint32_t* state, const uint8_t* data, size_t nBlocks)
+{
+  const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)),
+                                   0xB1);
+  __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)),
+                                   0x1B);
+  __m128i abef = _mm_alignr_epi8(abcd, efgh, 8);
+  __m128i cdgh = _mm_blend_epi16(efgh, abcd, 0xF0);
+
+  for (; nBlocks > 0; --nBlocks, data += 64) {
+    __m128i savedAbef = abef;
+    __m128i savedCdgh = cdgh;
+
+    __m128i w[4];
+    for (int i = 0; i < 4; ++i) {
+      w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)),
+                              byteSwap);
+    }
+    for (int i = 0; i < 16; ++i) {
+      __m128i wk = _mm_add_epi32(w[i & 3],
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 4 * i)));
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0E));
+
+      // w[i & 3] becomes the next four words of the message schedule
+      if (i < 12) {
+        __m128i next = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+        next = _mm_add_epi32(next, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+        w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+      }
+    }
+
+    abef = _mm_add_epi32(abef, savedAbef);
+    cdgh = _mm_add_epi32(cdgh, savedCdgh);
+  }
+
+  __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+  __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#endif // NDN_ENCODING_SHA256_X86
+
+static std::atomic<CompressFunction>&
+getCompressFunction()
+{
+#ifdef NDN_ENCODING_SHA256_X86
+  static std::atomic<CompressFunction> compress(hasShaNi() ? &compressShaNi : &compressPortable);
+#else
+  static std::atomic<CompressFunction> compress(&compressPortable);
+#endif // NDN_ENCODING_SHA256_X86
+  return compress;
+}
+
+const size_t Sha256::DIGEST_SIZE;
+
+Sha256::Sha256()
+  : m_totalLength(0)
+  , m_blockSize(0)
+{
+  std::memcpy(m_state, INITIAL_STATE, sizeof(m_state));
+}
+
+void
+Sha256::update(const uint8_t* data, size_t length)
+{
+  CompressFunction compress = getCompressFunction().load(std::memory_order_relaxed);
+  m_totalLength += length;
+
+  if (m_blockSize > 0) {
+    size_t toCopy = std::min(length, sizeof(m_block) - m_blockSize);
+    std::memcpy(m_block + m_blockSize, data, toCopy);
+    m_blockSize += toCopy;
+    data += toCopy;
+    length -= toCopy;
+    if (m_blockSize < sizeof(m_block))
+      return;
+    compress(m_state, m_block, 1);
+    m_blockSize = 0;
+  }
+
+  // whole blocks are compressed straight from the input
+  size_t nBlocks = length / sizeof(m_block);
+  if (nBlocks > 0) {
+    compress(m_state, data, nBlocks);
+    data += nBlocks * sizeof(m_block);
+    length -= nBlocks * sizeof(m_block);
+  }
+
+  if (length > 0) {
+    std::memcpy(m_block, data, length);
+    m_blockSize = length;
+  }
+}
+
+void
+Sha256::digest(uint8_t* digest) const
+{
+  uint32_t state[8];
+  std::memcpy(state, m_state, sizeof(state));
+
+  // padding: 0x80, zeros, then the length in bits, ending a block
+  uint8_t tail[128] = {};
+  std::memcpy(tail, m_block, m_blockSize);
+  tail[m_blockSize] = 0x80;
+  size_t tailSize = m_blockSize + 9 <= 64 ? 64 : 128;
+  uint64_t nBits = htobe64(m_totalLength * 8);
+  std::memcpy(tail + tailSize - 8, &nBits, sizeof(nBits));
+  getCompressFunction().load(std::memory_order_relaxed)(state, tail, tailSize / 64);
+
+  for (int i = 0; i < 8; ++i) {
+    uint32_t word = htobe32(state[i]);
+    std::memcpy(digest + 4 * i, &word, sizeof(word));
+  }
+}
+
+ConstBufferPtr
+Sha256::computeDigest() const
+{
+  auto buffer = make_shared<Buffer>(DIGEST_SIZE, Buffer::UninitializedTag());
+  digest(buffer->get());
+  return buffer;
+}
+
+void
+Sha256::compute(const uint8_t* data, size_t length, uint8_t* digest)
+{
+  Sha256 sha256;
+  sha256.update(data, length);
+  sha256.digest(digest);
+}
+
+Sha256::Implementation
+Sha256::getImplementation()
+{
+#ifdef NDN_ENCODING_SHA256_X86
+  if (getCompressFunction().load() == &compressShaNi)
+    return IMPLEMENTATION_SHA_NI;
+#endif // NDN_ENCODING_SHA256_X86
+  return IMPLEMENTATION_PORTABLE;
+}
+
+bool
+Sha256::isSupported(Implementation implementation)
+{
+  switch (implementation) {
+  case IMPLEMENTATION_PORTABLE:
+    return true;
+  case IMPLEMENTATION_SHA_NI:
+#ifdef NDN_ENCODING_SHA256_X86
+    return hasShaNi();
+#else
+    return false;
+#endif // NDN_ENCODING_SHA256_X86
+  }
+  return false;
+}
+
+bool
+Sha256::setImplementation(Implementation implementation)
+{
+  if (!isSupported(implementation))
+    return false;
+
+#ifdef NDN_ENCODING_SHA256_X86
+  if (implementation == IMPLEMENTATION_SHA_NI) {
+    getCompressFunction() = &compressShaNi;
+    return true;
+  }
+#endif // NDN_ENCODING_SHA256_X86
+  getCompressFunction() = &compressPortable;
+  return true;
+}
+
+} // namespace ndn
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_SHA256_HPP
+#define NDN_ENCODING_SHA256_HPP
+
+#include "buffer.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Streaming SHA-256
+ *
+ * The digest depends only on the concatenation of the bytes passed to update(), not on how
+ * they are split, so it can be computed over the segments of a Wire without linearizing them.
+ *
+ * Blocks are compressed with the SHA extensions (SHA-NI) when the CPU has them, and with a
+ * portable implementation otherwise.  The implementation is chosen once, at first use.
+ */
+class Sha256
+{
+public:
+  static const size_t DIGEST_SIZE = 32;
+
+  enum Implementation {
+    IMPLEMENTATION_PORTABLE,
+    IMPLEMENTATION_SHA_NI
+  };
+
+  Sha256();
+
+  /**
+   * @brief Add @p length bytes at @p data to the hashed input
+   */
+  void
+  update(const uint8_t* data, size_t length);
+
+  /**
+   * @brief Write the digest of all bytes added so far to @p digest, DIGEST_SIZE bytes
+   *
+   * More bytes can be added afterwards.
+   */
+  void
+  digest(uint8_t* digest) const;
+
+  /**
+   * @brief Return the digest of all bytes added so far
+   */
+  ConstBufferPtr
+  computeDigest() const;
+
+  /**
+   * @brief Write the digest of @p length bytes at @p data to @p digest
+   */
+  static void
+  compute(const uint8_t* data, size_t length, uint8_t* digest);
+
+  /**
+   * @brief Return the implementation compressing the blocks
+   */
+  static Implementation
+  getImplementation();
+
+  /**
+   * @brief Check whether the CPU supports @p implementation
+   */
+  static bool
+  isSupported(Implementation implementation);
+
+  /**
+   * @brief Use @p implementation from now on, for instance to compare implementations
+   * @return false if the CPU does not support it
+   */
+  static bool
+  setImplementation(Implementation implementation);
+
+public:
+  /// initial hash value, also used by the multi-buffer kernels of Sha256Batch
+  static const uint32_t INITIAL_STATE[8];
+  /// round constants, also used by the multi-buffer kernels of Sha256Batch
+  static const uint32_t ROUND_CONSTANTS[64];
+
+private:
+  uint32_t m_state[8];
+  uint64_t m_totalLength;
+  uint8_t m_block[64];    ///< bytes not yet forming a full block
+  size_t m_blockSize;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_SHA256_HPP
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/sha256.hpp"
+#include "encoding/wire_test.hpp"
+
+#include "boost-test.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace ndn {
+namespace tests {
+
+static std::string
+toHex(const uint8_t* digest)
+{
+  std::ostringstream os;
+  for (size_t i = 0; i < Sha256::DIGEST_SIZE; ++i) {
+    os << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(digest[i]);
+  }
+  return os.str();
+}
+
+static std::string
+computeHex(const std::string& input)
+{
+  uint8_t digest[Sha256::DIGEST_SIZE];
+  Sha256::compute(reinterpret_cast<const uint8_t*>(input.data()), input.size(), digest);
+  return toHex(digest);
+}
+
+/** @brief Runs each test case with every implementation the CPU supports
+ */
+class ImplementationFixture
+{
+public:
+  ImplementationFixture()
+    : m_original(Sha256::getImplementation())
+  {
+  }
+
+  ~ImplementationFixture()
+  {
+    Sha256::setImplementation(m_original);
+  }
+
+  std::vector<Sha256::Implementation>
+  getImplementations() const
+  {
+    std::vector<Sha256::Implementation> implementations;
+    for (Sha256::Implementation implementation : {Sha256::IMPLEMENTATION_PORTABLE,
+                                                  Sha256::IMPLEMENTATION_SHA_NI}) {
+      if (Sha256::isSupported(implementation))
+        implementations.push_back(implementation);
+    }
+    return implementations;
+  }
+
+private:
+  Sha256::Implementation m_original;
+};
+
+BOOST_FIXTURE_TEST_SUITE(EncodingSha256, ImplementationFixture)
+
+BOOST_AUTO_TEST_CASE(KnownDigests)
+{
+  for (Sha256::Implementation implementation : getImplementations()) {
+    BOOST_TEST_MESSAGE("implementation " << implementation);
+    Sha256::setImplementation(implementation);
+    BOOST_CHECK_EQUAL(computeHex(""),
+                      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    BOOST_CHECK_EQUAL(computeHex("abc"),
+                      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    BOOST_CHECK_EQUAL(computeHex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+                      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    BOOST_CHECK_EQUAL(computeHex(std::string(1000000, 'a')),
+                      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SplitInput)
+{
+  uint8_t input[1000];
+  for (size_t i = 0; i < sizeof(input); ++i) {
+    input[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  std::vector<std::string> expected;
+  for (Sha256::Implementation implementation : getImplementations()) {
+    Sha256::setImplementation(implementation);
+    for (size_t length = 0; length <= 300; ++length) {
+      uint8_t digest[Sha256::DIGEST_SIZE];
+      Sha256::compute(input, length, digest);
+      if (implementation == Sha256::IMPLEMENTATION_PORTABLE)
+        expected.push_back(toHex(digest));
+      else
+        BOOST_CHECK_EQUAL(toHex(digest), expected.at(length));
+    }
+
+    uint8_t whole[Sha256::DIGEST_SIZE];
+    Sha256::compute(input, sizeof(input), whole);
+    for (size_t split = 0; split < sizeof(input); split += 37) {
+      Sha256 sha256;
+      sha256.update(input, split);
+      sha256.update(input + split, 0);
+      sha256.update(input + split, sizeof(input) - split);
+      BOOST_CHECK_EQUAL(toHex(sha256.computeDigest()->get()), toHex(whole));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DigestOfWire)
+{
+  uint8_t input[500];
+  for (size_t i = 0; i < sizeof(input); ++i) {
+    input[i] = static_cast<uint8_t>(i * 13);
+  }
+  uint8_t expected[Sha256::DIGEST_SIZE];
+  Sha256::compute(input, sizeof(input), expected);
+
+  Wire wire(100);
+  wire.appendArray(input, 100);
+  wire.appendSharedBlock(BlockN(input + 100, 250));
+  wire.appendArray(input + 350, 150);
+
+  ConstBufferPtr digest = wire.getSha256Digest();
+  BOOST_CHECK_EQUAL(toHex(digest->get()), toHex(expected));
+  BOOST_CHECK_EQUAL(wire.getSha256Digest(), digest); // cached
+
+  uint8_t slice[Sha256::DIGEST_SIZE];
+  Sha256::compute(input + 90, 300, slice);
+  BOOST_CHECK_EQUAL(toHex(wire.computeSha256Digest(90, 300)->get()), toHex(slice));
+  BOOST_CHECK_THROW(wire.computeSha256Digest(400, 101), Wire::Error);
+
+  wire.appendArray(input, 1);
+  BOOST_CHECK_NE(toHex(wire.getSha256Digest()->get()), toHex(expected));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
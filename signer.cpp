@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "signer.hpp"
+
+#include <openssl/evp.h>
+
+namespace ndn {
+
+Signer::~Signer() = default;
+
+tlv::SignatureTypeValue
+DigestSha256Signer::getType() const
+{
+  return tlv::DigestSha256;
+}
+
+void
+DigestSha256Signer::update(const uint8_t* data, size_t length)
+{
+  if (length > 0)
+    m_sha256.update(data, length);
+}
+
+ConstBufferPtr
+DigestSha256Signer::sign()
+{
+  ConstBufferPtr digest = m_sha256.computeDigest();
+  m_sha256 = Sha256();
+  return digest;
+}
+
+PrivateKeySigner::PrivateKeySigner(evp_pkey_st* key)
+  : m_key(key)
+  , m_context(nullptr)
+  , m_isStarted(false)
+{
+  switch (EVP_PKEY_base_id(key)) {
+  case EVP_PKEY_RSA:
+    m_type = tlv::SignatureSha256WithRsa;
+    break;
+  case EVP_PKEY_EC:
+    m_type = tlv::SignatureSha256WithEcdsa;
+    break;
+  default:
+    BOOST_THROW_EXCEPTION(Error("Key is neither RSA nor EC"));
+  }
+
+  m_context = EVP_MD_CTX_new();
+  if (m_context == nullptr)
+    BOOST_THROW_EXCEPTION(Error("Cannot allocate the digest context"));
+  EVP_PKEY_up_ref(m_key);
+}
+
+PrivateKeySigner::~PrivateKeySigner()
+{
+  EVP_MD_CTX_free(m_context);
+  EVP_PKEY_free(m_key);
+}
+
+tlv::SignatureTypeValue
+PrivateKeySigner::getType() const
+{
+  return m_type;
+}
+
+void
+PrivateKeySigner::start()
+{
+  if (m_isStarted)
+    return;
+  if (EVP_DigestSignInit(m_context, nullptr, EVP_sha256(), nullptr, m_key) != 1)
+    BOOST_THROW_EXCEPTION(Error("Cannot initialize signing"));
+  m_isStarted = true;
+}
+
+void
+PrivateKeySigner::update(const uint8_t* data, size_t length)
+{
+  start();
+  if (length > 0 && EVP_DigestSignUpdate(m_context, data, length) != 1)
+    BOOST_THROW_EXCEPTION(Error("Cannot hash the signed bytes"));
+}
+
+ConstBufferPtr
+PrivateKeySigner::sign()
+{
+  start();
+  m_isStarted = false;
+
+  size_t size = 0;
+  if (EVP_DigestSignFinal(m_context, nullptr, &size) != 1)
+    BOOST_THROW_EXCEPTION(Error("Cannot determine the signature size"));
+  auto signature = make_shared<Buffer>(size, Buffer::UninitializedTag());
+  if (EVP_DigestSignFinal(m_context, signature->get(), &size) != 1)
+    BOOST_THROW_EXCEPTION(Error("Cannot sign"));
+  // an ECDSA signature is often shorter than its maximum size
+  signature->resize(size);
+  return signature;
+}
+
+} // namespace ndn
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_SIGNER_HPP
+#define NDN_ENCODING_SIGNER_HPP
+
+#include "sha256.hpp"
+#include "tlv_test.hpp"
+
+struct evp_pkey_st;
+struct evp_md_ctx_st;
+
+namespace ndn {
+
+/** @brief Computes a signature over bytes fed incrementally
+ *
+ *  The signed bytes are passed to update() in order, in as many pieces as convenient, e.g.
+ *  one per segment of a Wire, and sign() returns the SignatureValue over all of them.
+ */
+class Signer : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  virtual
+  ~Signer();
+
+  /** @brief Return the SignatureType of the signatures
+   */
+  virtual tlv::SignatureTypeValue
+  getType() const = 0;
+
+  /** @brief Add @p length bytes at @p data to the signed bytes
+   */
+  virtual void
+  update(const uint8_t* data, size_t length) = 0;
+
+  /** @brief Return the signature of the bytes added since the previous sign(), and start
+   *         a new signature
+   *  @throw Error signing failed
+   */
+  virtual ConstBufferPtr
+  sign() = 0;
+};
+
+/** @brief Signer of DigestSha256 signatures, the SHA-256 digest of the signed bytes
+ */
+class DigestSha256Signer : public Signer
+{
+public:
+  tlv::SignatureTypeValue
+  getType() const final;
+
+  void
+  update(const uint8_t* data, size_t length) final;
+
+  ConstBufferPtr
+  sign() final;
+
+private:
+  Sha256 m_sha256;
+};
+
+/** @brief Signer with a private key: SignatureSha256WithRsa with an RSA key (PKCS #1 v1.5),
+ *         SignatureSha256WithEcdsa with an EC key (DER-encoded ECDSA-Sig-Value)
+ *
+ *  The signed bytes are hashed by OpenSSL as they are added.
+ */
+class PrivateKeySigner : public Signer
+{
+public:
+  /** @brief Create a signer with @p key, an OpenSSL EVP_PKEY holding an RSA or EC private key
+   *
+   *  The signer takes its own reference to @p key.
+   *  @throw Error the key is neither RSA nor EC
+   */
+  explicit
+  PrivateKeySigner(evp_pkey_st* key);
+
+  ~PrivateKeySigner();
+
+  tlv::SignatureTypeValue
+  getType() const final;
+
+  void
+  update(const uint8_t* data, size_t length) final;
+
+  ConstBufferPtr
+  sign() final;
+
+private:
+  /** @brief Start hashing with the key, unless already started
+   */
+  void
+  start();
+
+private:
+  evp_pkey_st* m_key;
+  evp_md_ctx_st* m_context;
+  tlv::SignatureTypeValue m_type;
+  bool m_isStarted;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_SIGNER_HPP
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/signer.hpp"
+
+#include "boost-test.hpp"
+#include "make-signed-data.hpp"
+
+namespace ndn {
+namespace tests {
+
+static bool
+verifySignature(EVP_PKEY* key, const uint8_t* data, size_t size, const Buffer& signature)
+{
+  EVP_MD_CTX* context = EVP_MD_CTX_new();
+  bool isValid = EVP_DigestVerifyInit(context, nullptr, EVP_sha256(), nullptr, key) == 1 &&
+                 EVP_DigestVerifyUpdate(context, data, size) == 1 &&
+                 EVP_DigestVerifyFinal(context, signature.data(), signature.size()) == 1;
+  EVP_MD_CTX_free(context);
+  return isValid;
+}
+
+BOOST_AUTO_TEST_SUITE(EncodingSigner)
+
+BOOST_AUTO_TEST_CASE(DigestSha256)
+{
+  DigestSha256Signer signer;
+  BOOST_CHECK_EQUAL(signer.getType(), tlv::DigestSha256);
+
+  const uint8_t input[] = {'a', 'b', 'c'};
+  uint8_t expected[Sha256::DIGEST_SIZE];
+  Sha256::compute(input, sizeof(input), expected);
+  for (int i = 0; i < 2; ++i) {
+    signer.update(input, 1);
+    signer.update(input + 1, 0);
+    signer.update(input + 1, 2);
+    ConstBufferPtr signature = signer.sign();
+    BOOST_CHECK_EQUAL_COLLECTIONS(signature->begin(), signature->end(),
+                                  expected, expected + sizeof(expected));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PrivateKey)
+{
+  std::vector<uint8_t> input(1000);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<uint8_t>(i);
+  }
+
+  for (int keyType : {EVP_PKEY_RSA, EVP_PKEY_EC}) {
+    shared_ptr<EVP_PKEY> key = generateKey(keyType);
+    PrivateKeySigner signer(key.get());
+    BOOST_CHECK_EQUAL(signer.getType(), keyType == EVP_PKEY_RSA ? tlv::SignatureSha256WithRsa :
+                                                                  tlv::SignatureSha256WithEcdsa);
+
+    // two signatures in a row, each over the input split in several pieces
+    for (int i = 0; i < 2; ++i) {
+      for (size_t offset = 0; offset < input.size(); offset += 300) {
+        signer.update(input.data() + offset, std::min<size_t>(300, input.size() - offset));
+      }
+      ConstBufferPtr signature = signer.sign();
+      BOOST_CHECK(verifySignature(key.get(), input.data(), input.size(), *signature));
+      BOOST_CHECK(!verifySignature(key.get(), input.data(), input.size() - 1, *signature));
+    }
+  }
+
+  shared_ptr<EVP_PKEY> ed25519 = generateKey(EVP_PKEY_ED25519);
+  BOOST_CHECK_THROW(PrivateKeySigner signer(ed25519.get()), Signer::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "signing-encoder.hpp"
+
+#include <boost/asio/buffer.hpp>
+
+namespace ndn {
+namespace encoding {
+
+SigningEncoder::SigningEncoder(Wire& wire, Signer& signer)
+  : m_wire(wire)
+  , m_signer(signer)
+  , m_prepared(nullptr)
+  , m_signedSize(0)
+  , m_isFinished(false)
+{
+  if (!m_wire.hasWire() || m_wire.size() != 0)
+    BOOST_THROW_EXCEPTION(Error("The wire must have a block and be empty"));
+}
+
+uint8_t*
+SigningEncoder::prepare(size_t length)
+{
+  m_prepared = m_wire.prepare(length);
+  return m_prepared;
+}
+
+void
+SigningEncoder::commit(size_t length)
+{
+  m_signer.update(m_prepared, length);
+  m_prepared += length;
+  m_signedSize += length;
+  m_wire.commit(length);
+}
+
+size_t
+SigningEncoder::append(const uint8_t* array, size_t length)
+{
+  m_signer.update(array, length);
+  m_signedSize += length;
+  return m_wire.appendArray(array, length);
+}
+
+size_t
+SigningEncoder::appendBlock(const BlockN& block)
+{
+  m_signer.update(block.begin(), block.size());
+  m_signedSize += block.size();
+  return m_wire.appendSharedBlock(block);
+}
+
+size_t
+SigningEncoder::appendWire(const Wire& wire)
+{
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    m_signer.update(static_cast<const uint8_t*>((*i).data()), (*i).size());
+  }
+  size_t length = m_wire.appendWire(&wire);
+  m_signedSize += length;
+  return length;
+}
+
+size_t
+SigningEncoder::appendSignatureInfo(const Wire* keyName)
+{
+  uint64_t type = m_signer.getType();
+  size_t typeSize = tlv::sizeOfNonNegativeInteger(type);
+  size_t infoSize = tlv::sizeOfVarNumber(tlv::SignatureType) + tlv::sizeOfVarNumber(typeSize) +
+                    typeSize;
+  size_t keyNameSize = keyName != nullptr ? keyName->size() : 0;
+  if (keyName != nullptr) {
+    infoSize += tlv::sizeOfVarNumber(tlv::KeyLocator) + tlv::sizeOfVarNumber(keyNameSize) +
+                keyNameSize;
+  }
+
+  size_t length = appendTlvHeader<tlv::SignatureInfo>(infoSize);
+  length += appendTlvHeader<tlv::SignatureType>(typeSize);
+  length += appendNonNegativeInteger(type);
+  if (keyName != nullptr) {
+    length += appendTlvHeader<tlv::KeyLocator>(keyNameSize);
+    length += appendWire(*keyName);
+  }
+  return length;
+}
+
+size_t
+SigningEncoder::finish()
+{
+  if (m_isFinished)
+    BOOST_THROW_EXCEPTION(Error("The packet is already signed"));
+  m_isFinished = true;
+
+  // the SignatureValue is not signed, so it bypasses commit()
+  ConstBufferPtr signature = m_signer.sign();
+  WireSink sink(m_wire);
+  size_t valueSize = m_signedSize + sink.appendTlvHeader<tlv::SignatureValue>(signature->size());
+  valueSize += sink.append(signature->data(), signature->size());
+
+  uint8_t header[10];
+  SpanSink headerSink(header, header + sizeof(header));
+  headerSink.appendTlvHeader<tlv::Data>(valueSize);
+  m_wire.prependArray(header, headerSink.size());
+  return m_wire.size();
+}
+
+} // namespace encoding
+} // namespace ndn
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_SIGNING_ENCODER_HPP
+#define NDN_ENCODING_SIGNING_ENCODER_HPP
+
+#include "byte-sink.hpp"
+#include "signer.hpp"
+
+namespace ndn {
+namespace encoding {
+
+/**
+ * @brief Encoder of a signed Data packet into a Wire in a single pass
+ *
+ * The fields of the signed portion, Name through SignatureInfo, are appended in order through
+ * the ByteSink interface, or as pre-encoded blocks and wires shared by reference.  Every byte
+ * is passed to the Signer as soon as it is committed, so the signed portion is neither
+ * linearized nor encoded twice.  finish() then appends the SignatureValue, and prepends the
+ * Data TLV header with Wire::prependArray(), as its length is only known at that point: an
+ * ECDSA signature has a variable size.
+ *
+ * Usage example:
+ * @code
+ *      Wire wire(1024);
+ *      DigestSha256Signer signer;
+ *      SigningEncoder encoder(wire, signer);
+ *      encoder.appendWire(name);
+ *      encoder.appendTlvHeader<tlv::Content>(content.size());
+ *      encoder.appendWire(content);
+ *      encoder.appendSignatureInfo();
+ *      encoder.finish();
+ * @endcode
+ */
+class SigningEncoder : public ByteSink<SigningEncoder>, noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * @brief Encode into @p wire, signing with @p signer
+   * @throw Error @p wire has no block or is not empty
+   */
+  SigningEncoder(Wire& wire, Signer& signer);
+
+  uint8_t*
+  prepare(size_t length);
+
+  void
+  commit(size_t length);
+
+  /**
+   * @brief Append @p length bytes of @p array, spreading them over segments as needed
+   */
+  size_t
+  append(const uint8_t* array, size_t length);
+
+  /**
+   * @brief Append the pre-encoded TLV block @p block, sharing its buffer
+   */
+  size_t
+  appendBlock(const BlockN& block);
+
+  /**
+   * @brief Append all blocks of the pre-encoded @p wire, sharing their buffers
+   */
+  size_t
+  appendWire(const Wire& wire);
+
+  /**
+   * @brief Append a SignatureInfo with the SignatureType of the signer and, if @p keyName is
+   *        not null, a KeyLocator holding the Name TLV @p keyName
+   */
+  size_t
+  appendSignatureInfo(const Wire* keyName = nullptr);
+
+  /**
+   * @brief Sign, append the SignatureValue and prepend the Data TLV header
+   * @return size of the Data packet
+   * @throw Error already finished
+   */
+  size_t
+  finish();
+
+  /**
+   * @brief Return the number of bytes signed so far
+   */
+  size_t
+  getSignedSize() const
+  {
+    return m_signedSize;
+  }
+
+private:
+  Wire& m_wire;
+  Signer& m_signer;
+  uint8_t* m_prepared;
+  size_t m_signedSize;
+  bool m_isFinished;
+};
+
+} // namespace encoding
+} // namespace ndn
+
+#endif // NDN_ENCODING_SIGNING_ENCODER_HPP
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/signing-encoder.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/asio/buffer.hpp>
+
+namespace ndn {
+namespace tests {
+
+using encoding::SigningEncoder;
+
+/** @brief Signer of signatures of a chosen size, recording the signed bytes
+ */
+class RecordingSigner : public Signer
+{
+public:
+  explicit
+  RecordingSigner(size_t signatureSize)
+    : signatureSize(signatureSize)
+  {
+  }
+
+  tlv::SignatureTypeValue
+  getType() const final
+  {
+    return tlv::SignatureSha256WithEcdsa;
+  }
+
+  void
+  update(const uint8_t* data, size_t length) final
+  {
+    signedBytes.insert(signedBytes.end(), data, data + length);
+  }
+
+  ConstBufferPtr
+  sign() final
+  {
+    return make_shared<Buffer>(signatureSize);
+  }
+
+public:
+  size_t signatureSize;
+  std::vector<uint8_t> signedBytes;
+};
+
+static std::vector<uint8_t>
+getBytes(const Wire& wire)
+{
+  std::vector<uint8_t> bytes;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>((*i).data());
+    bytes.insert(bytes.end(), data, data + (*i).size());
+  }
+  return bytes;
+}
+
+/** @brief Encode a Data packet with a Name split over two blocks and a shared Content
+ */
+static size_t
+encodeData(SigningEncoder& encoder, const BlockN& content, const Wire* keyName = nullptr)
+{
+  const uint8_t name[] = {0x07, 0x08, 0x08, 0x02, 'n', 'd', 0x08, 0x02, 'n', '1'};
+  Wire nameWire(4);
+  nameWire.appendArray(name, 5);
+  nameWire.appendSharedBlock(BlockN(name + 5, sizeof(name) - 5));
+
+  size_t length = encoder.appendWire(nameWire);
+  length += encoder.appendTlvHeader<tlv::MetaInfo>(3);
+  length += encoder.appendTlvHeader<tlv::ContentType>(1);
+  length += encoder.appendNonNegativeInteger(0);
+  length += encoder.appendTlvHeader<tlv::Content>(content.size());
+  length += encoder.appendBlock(content);
+  length += encoder.appendSignatureInfo(keyName);
+  return length;
+}
+
+BOOST_AUTO_TEST_SUITE(EncodingSigningEncoder)
+
+BOOST_AUTO_TEST_CASE(DigestSha256)
+{
+  std::vector<uint8_t> payload(100, 0xAB);
+  BlockN content(make_shared<Buffer>(payload.begin(), payload.end()));
+
+  Wire wire(64);
+  DigestSha256Signer signer;
+  SigningEncoder encoder(wire, signer);
+  size_t signedSize = encodeData(encoder, content);
+  BOOST_CHECK_EQUAL(encoder.getSignedSize(), signedSize);
+  size_t dataSize = encoder.finish();
+  BOOST_CHECK_THROW(encoder.finish(), SigningEncoder::Error);
+
+  // Data header, then the signed portion, then the SignatureValue
+  size_t valueSize = signedSize + 2 + Sha256::DIGEST_SIZE;
+  BOOST_REQUIRE_EQUAL(dataSize, 2 + valueSize);
+  BOOST_CHECK_EQUAL(wire.size(), dataSize);
+  std::vector<uint8_t> bytes = getBytes(wire);
+  BOOST_CHECK_EQUAL(bytes[0], tlv::Data);
+  BOOST_CHECK_EQUAL(bytes[1], valueSize);
+  BOOST_CHECK_EQUAL(bytes[2 + signedSize], tlv::SignatureValue);
+  BOOST_CHECK_EQUAL(bytes[2 + signedSize + 1], Sha256::DIGEST_SIZE);
+
+  ConstBufferPtr digest = wire.computeSha256Digest(2, signedSize);
+  BOOST_CHECK_EQUAL_COLLECTIONS(digest->begin(), digest->end(),
+                                bytes.end() - Sha256::DIGEST_SIZE, bytes.end());
+
+  // SignatureInfo holds SignatureType 0
+  const uint8_t signatureInfo[] = {0x16, 0x03, 0x1B, 0x01, 0x00};
+  BOOST_CHECK_EQUAL_COLLECTIONS(bytes.begin() + 2 + signedSize - sizeof(signatureInfo),
+                                bytes.begin() + 2 + signedSize,
+                                signatureInfo, signatureInfo + sizeof(signatureInfo));
+
+  // the Content is shared, not copied
+  bool isShared = false;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    isShared = isShared || static_cast<const uint8_t*>((*i).data()) == content.begin();
+  }
+  BOOST_CHECK(isShared);
+}
+
+BOOST_AUTO_TEST_CASE(SignatureSizes)
+{
+  std::vector<uint8_t> payload(150, 0xCD);
+  BlockN content(make_shared<Buffer>(payload.begin(), payload.end()));
+  const uint8_t keyNameBytes[] = {0x07, 0x03, 0x08, 0x01, 'k'};
+  Wire keyName(8);
+  keyName.appendArray(keyNameBytes, sizeof(keyNameBytes));
+
+  // the Data TLV-LENGTH takes 1 octet below 253 and 3 octets from 253
+  for (size_t signatureSize : {8, 70, 71, 72, 300}) {
+    Wire wire(32);
+    RecordingSigner signer(signatureSize);
+    SigningEncoder encoder(wire, signer);
+    size_t signedSize = encodeData(encoder, content, &keyName);
+    size_t dataSize = encoder.finish();
+
+    std::vector<uint8_t> bytes = getBytes(wire);
+    BOOST_REQUIRE_EQUAL(bytes.size(), dataSize);
+    size_t signatureValueSize = (signatureSize < 253 ? 2 : 4) + signatureSize;
+    size_t valueSize = signedSize + signatureValueSize;
+    size_t headerSize = valueSize < 253 ? 2 : 4;
+    BOOST_CHECK_EQUAL(dataSize, headerSize + valueSize);
+    BOOST_CHECK_EQUAL(bytes[0], tlv::Data);
+    if (headerSize == 4) {
+      BOOST_CHECK_EQUAL(bytes[1], 253);
+      BOOST_CHECK_EQUAL(bytes[2] << 8 | bytes[3], valueSize);
+    }
+    else {
+      BOOST_CHECK_EQUAL(bytes[1], valueSize);
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(signer.signedBytes.begin(), signer.signedBytes.end(),
+                                  bytes.begin() + headerSize,
+                                  bytes.begin() + headerSize + signedSize);
+    BOOST_CHECK_EQUAL_COLLECTIONS(bytes.begin() + headerSize + signedSize - sizeof(keyNameBytes),
+                                  bytes.begin() + headerSize + signedSize,
+                                  keyNameBytes, keyNameBytes + sizeof(keyNameBytes));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NonEmptyWire)
+{
+  DigestSha256Signer signer;
+  Wire wire(16);
+  wire.writeUint8(1);
+  BOOST_CHECK_THROW(SigningEncoder(wire, signer), SigningEncoder::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -25,9 +25,11 @@
 #include <stdexcept>
 #include <iostream>
 #include <iterator>
+#include <cstring>
 #include <limits>
 
 #include "buffer.hpp"
+#include "encoding-counters.hpp"
 #include "endian.hpp"
 #include "wire_test.hpp"
 
@@ -57,6 +59,23 @@ public:
   }
 };
 
+/// @cond include_hidden
+namespace detail {
+
+/** @brief Count a TLV error in EncodingCounters::@p kind, then throw it
+ */
+[[noreturn]] inline void
+throwError(EncodingCounters::Counter kind, const char* what)
+{
+#ifdef NDN_CXX_HAVE_ENCODING_COUNTERS
+  EncodingCounters::increment(kind);
+#endif
+  BOOST_THROW_EXCEPTION(Error(what));
+}
+
+} // namespace detail
+/// @endcond
+
 enum {
   Interest      = 5,
   Data          = 6,
@@ -192,8 +211,10 @@ readType(InputIterator& begin, const InputIterator& end);
 
 /**
  * @brief Get number of bytes necessary to hold value of VAR-NUMBER
+ *
+ * This is a constant expression for a constant @p varNumber, and has no branches otherwise.
  */
-inline size_t
+constexpr size_t
 sizeOfVarNumber(uint64_t varNumber);
 
 /**
@@ -202,6 +223,16 @@ sizeOfVarNumber(uint64_t varNumber);
 inline size_t
 writeVarNumber(std::ostream& os, uint64_t varNumber);
 
+/**
+ * @brief Write VAR-NUMBER to the memory at @p pos
+ *
+ * The caller must provide sizeOfVarNumber(varNumber) bytes (at most 9) at @p pos.
+ *
+ * @return pointer to the first byte after the written VAR-NUMBER
+ */
+inline uint8_t*
+writeVarNumber(uint8_t* pos, uint64_t varNumber);
+
 /**
  * @brief Read nonNegativeInteger in NDN-TLV encoding
  *
@@ -218,8 +249,10 @@ readNonNegativeInteger(size_t size, InputIterator& begin, const InputIterator& e
 
 /**
  * @brief Get number of bytes necessary to hold value of nonNegativeInteger
+ *
+ * This is a constant expression for a constant @p varNumber, and has no branches otherwise.
  */
-inline size_t
+constexpr size_t
 sizeOfNonNegativeInteger(uint64_t varNumber);
 
 /**
@@ -228,6 +261,16 @@ sizeOfNonNegativeInteger(uint64_t varNumber);
 inline size_t
 writeNonNegativeInteger(std::ostream& os, uint64_t varNumber);
 
+/**
+ * @brief Write nonNegativeInteger to the memory at @p pos
+ *
+ * The caller must provide sizeOfNonNegativeInteger(varNumber) bytes (at most 8) at @p pos.
+ *
+ * @return pointer to the first byte after the written nonNegativeInteger
+ */
+inline uint8_t*
+writeNonNegativeInteger(uint8_t* pos, uint64_t varNumber);
+
 /**
  * @brief Read VAR-NUMBER in NDN-TLV encoding (overload for Wire)
  *
@@ -357,12 +400,14 @@ inline uint64_t
 readVarNumber(InputIterator& begin, const InputIterator& end)
 {
   if (begin == end)
-    BOOST_THROW_EXCEPTION(Error("Empty buffer during TLV processing"));
+    detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                       "Empty buffer during TLV processing");
 
   uint64_t value;
   bool isOk = readVarNumber(begin, end, value);
   if (!isOk)
-    BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+    detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                       "Insufficient data during TLV processing");
 
   return value;
 }
@@ -425,27 +470,47 @@ readType(InputIterator& begin, const InputIterator& end)
 {
   uint64_t type = readVarNumber(begin, end);
   if (type > std::numeric_limits<uint32_t>::max()) {
-    BOOST_THROW_EXCEPTION(Error("TLV type code exceeds allowed maximum"));
+    detail::throwError(EncodingCounters::TLV_ERRORS_TYPE_OVERFLOW,
+                       "TLV type code exceeds allowed maximum");
   }
 
   return static_cast<uint32_t>(type);
 }
 
-size_t
+/// @cond include_hidden
+namespace detail {
+
+/**
+ * @brief Return the number of significant octets of @p value, from 1 to 8
+ *
+ * Compiles to a single lzcnt/bsr instruction.
+ */
+constexpr size_t
+countOctets(uint64_t value)
+{
+  return static_cast<size_t>(71 - __builtin_clzll(value | 1)) >> 3;
+}
+
+/**
+ * @brief Check whether @p value is 253, 254 or 255, which take a 1-octet
+ *        number of significant octets but are reserved as VAR-NUMBER markers
+ */
+constexpr size_t
+isMarkerOctet(uint64_t value)
+{
+  return static_cast<size_t>(value - 253 < 3);
+}
+
+} // namespace detail
+/// @endcond
+
+constexpr size_t
 sizeOfVarNumber(uint64_t varNumber)
 {
-  if (varNumber < 253) {
-    return 1;
-  }
-  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
-    return 3;
-  }
-  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
-    return 5;
-  }
-  else {
-    return 9;
-  }
+  // encoded size per number of significant octets, one nibble each: 1 => 1, 2 => 3,
+  // 3..4 => 5, 5..8 => 9
+  return ((UINT64_C(0x999955310) >> (4 * detail::countOctets(varNumber))) & 0xF) +
+         2 * detail::isMarkerOctet(varNumber);
 }
 
 inline size_t
@@ -475,6 +540,33 @@ writeVarNumber(std::ostream& os, uint64_t varNumber)
   }
 }
 
+inline uint8_t*
+writeVarNumber(uint8_t* pos, uint64_t varNumber)
+{
+  if (varNumber < 253) {
+    *pos = static_cast<uint8_t>(varNumber);
+    return pos + 1;
+  }
+  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
+    *pos = 253;
+    uint16_t value = htobe16(static_cast<uint16_t>(varNumber));
+    std::memcpy(pos + 1, &value, 2);
+    return pos + 3;
+  }
+  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
+    *pos = 254;
+    uint32_t value = htobe32(static_cast<uint32_t>(varNumber));
+    std::memcpy(pos + 1, &value, 4);
+    return pos + 5;
+  }
+  else {
+    *pos = 255;
+    uint64_t value = htobe64(varNumber);
+    std::memcpy(pos + 1, &value, 8);
+    return pos + 9;
+  }
+}
+
 template<class InputIterator>
 inline uint64_t
 readNonNegativeInteger(size_t size, InputIterator& begin, const InputIterator& end)
@@ -483,7 +575,8 @@ readNonNegativeInteger(size_t size, InputIterator& begin, const InputIterator& e
   case 1:
     {
       if (end - begin < 1)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       uint8_t value = *begin;
       begin++;
@@ -492,7 +585,8 @@ readNonNegativeInteger(size_t size, InputIterator& begin, const InputIterator& e
   case 2:
     {
       if (end - begin < 2)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       uint16_t value = *reinterpret_cast<const uint16_t*>(&*begin);
       begin += 2;
@@ -501,7 +595,8 @@ readNonNegativeInteger(size_t size, InputIterator& begin, const InputIterator& e
   case 4:
     {
       if (end - begin < 4)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       uint32_t value = *reinterpret_cast<const uint32_t*>(&*begin);
       begin += 4;
@@ -510,14 +605,16 @@ readNonNegativeInteger(size_t size, InputIterator& begin, const InputIterator& e
   case 8:
     {
       if (end - begin < 8)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       uint64_t value = *reinterpret_cast<const uint64_t*>(&*begin);
       begin += 8;
       return be64toh(value);
     }
   }
-  BOOST_THROW_EXCEPTION(Error("Invalid length for nonNegativeInteger (only 1, 2, 4, and 8 are allowed)"));
+  detail::throwError(EncodingCounters::TLV_ERRORS_INVALID_INTEGER,
+                     "Invalid length for nonNegativeInteger (only 1, 2, 4, and 8 are allowed)");
 }
 
 template<>
@@ -530,7 +627,8 @@ readNonNegativeInteger<std::istream_iterator<uint8_t> >(size_t size,
   case 1:
     {
       if (begin == end)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       uint64_t value = *begin;
       begin++;
@@ -547,7 +645,8 @@ readNonNegativeInteger<std::istream_iterator<uint8_t> >(size_t size,
         }
 
       if (count != 2)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       return value;
     }
@@ -562,7 +661,8 @@ readNonNegativeInteger<std::istream_iterator<uint8_t> >(size_t size,
         }
 
       if (count != 4)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       return value;
     }
@@ -577,52 +677,70 @@ readNonNegativeInteger<std::istream_iterator<uint8_t> >(size_t size,
         }
 
       if (count != 8)
-        BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+        detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                           "Insufficient data during TLV processing");
 
       return value;
     }
   }
-  BOOST_THROW_EXCEPTION(Error("Invalid length for nonNegativeInteger (only 1, 2, 4, and 8 are allowed)"));
+  detail::throwError(EncodingCounters::TLV_ERRORS_INVALID_INTEGER,
+                     "Invalid length for nonNegativeInteger (only 1, 2, 4, and 8 are allowed)");
 }
 
-inline size_t
+constexpr size_t
 sizeOfNonNegativeInteger(uint64_t varNumber)
+{
+  // encoded size per number of significant octets, one nibble each: 1 => 1, 2 => 2,
+  // 3..4 => 4, 5..8 => 8
+  return ((UINT64_C(0x888844210) >> (4 * detail::countOctets(varNumber))) & 0xF) +
+         detail::isMarkerOctet(varNumber);
+}
+
+inline size_t
+writeNonNegativeInteger(std::ostream& os, uint64_t varNumber)
 {
   if (varNumber < 253) {
+    os.put(static_cast<char>(varNumber));
     return 1;
   }
   else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
+    uint16_t value = htobe16(static_cast<uint16_t>(varNumber));
+    os.write(reinterpret_cast<const char*>(&value), 2);
     return 2;
   }
   else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
+    uint32_t value = htobe32(static_cast<uint32_t>(varNumber));
+    os.write(reinterpret_cast<const char*>(&value), 4);
     return 4;
   }
   else {
+    uint64_t value = htobe64(varNumber);
+    os.write(reinterpret_cast<const char*>(&value), 8);
     return 8;
   }
 }
 
-inline size_t
-writeNonNegativeInteger(std::ostream& os, uint64_t varNumber)
+inline uint8_t*
+writeNonNegativeInteger(uint8_t* pos, uint64_t varNumber)
 {
   if (varNumber < 253) {
-    os.put(static_cast<char>(varNumber));
-    return 1;
+    *pos = static_cast<uint8_t>(varNumber);
+    return pos + 1;
   }
   else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
     uint16_t value = htobe16(static_cast<uint16_t>(varNumber));
-    os.write(reinterpret_cast<const char*>(&value), 2);
-    return 2;
+    std::memcpy(pos, &value, 2);
+    return pos + 2;
   }
   else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
     uint32_t value = htobe32(static_cast<uint32_t>(varNumber));
-    os.write(reinterpret_cast<const char*>(&value), 4);
-    return 4;
+    std::memcpy(pos, &value, 4);
+    return pos + 4;
   }
   else {
     uint64_t value = htobe64(varNumber);
-    os.write(reinterpret_cast<const char*>(&value), 8);
-    return 8;
+    std::memcpy(pos, &value, 8);
+    return pos + 8;
   }
 }
 
@@ -665,7 +783,7 @@ readVarNumber(const Wire& wire, size_t& begin, size_t& end, uint64_t& value)
     if (count != 4)
       return false;
   }
-  else // if (firstOctet == 255) {
+  else { // if (firstOctet == 255)
     value = 0;
     size_t count = 0;
     uint8_t tmp = 0;
@@ -677,6 +795,7 @@ readVarNumber(const Wire& wire, size_t& begin, size_t& end, uint64_t& value)
 	
     if (count != 8)
       return false;
+  }
 
   return true;
 }
@@ -686,12 +805,14 @@ inline uint64_t
 readVarNumber(const Wire& wire, size_t& begin, size_t& end)
 {
   if (begin == end)
-    BOOST_THROW_EXCEPTION(Error("Empty buffer during TLV processing"));
+    detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                       "Empty buffer during TLV processing");
 
   uint64_t value;
   bool isOk = readVarNumber(wire, begin, end, value);
   if (!isOk)
-    BOOST_THROW_EXCEPTION(Error("Insufficient data during TLV processing"));
+    detail::throwError(EncodingCounters::TLV_ERRORS_TRUNCATED,
+                       "Insufficient data during TLV processing");
 
   return value;
 }
@@ -714,7 +835,8 @@ readType(const Wire& wire, size_t& begin, size_t& end)
 {
   uint64_t type = readVarNumber(wire, begin, end);
   if (type > std::numeric_limits<uint32_t>::max()) {
-    BOOST_THROW_EXCEPTION(Error("TLV type code exceeds allowed maximum"));
+    detail::throwError(EncodingCounters::TLV_ERRORS_TYPE_OVERFLOW,
+                       "TLV type code exceeds allowed maximum");
   }
 
   return static_cast<uint32_t>(type);
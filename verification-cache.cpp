@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "verification-cache.hpp"
+#include "fast-hash.hpp"
+#include "sha256.hpp"
+
+#include <openssl/x509.h>
+
+#include <cstring>
+
+namespace ndn {
+
+size_t
+VerificationCache::DigestHash::operator()(const Digest& digest) const
+{
+  // SHA-256 output is uniform already
+  size_t hash;
+  std::memcpy(&hash, digest.data(), sizeof(hash));
+  return hash;
+}
+
+VerificationCache::VerificationCache(size_t capacity, size_t nShards)
+  : m_capacity(capacity)
+  , m_shardCapacity(0)
+{
+  nShards = std::max<size_t>(1, std::min(nShards, capacity));
+  m_shardCapacity = capacity / nShards;
+  for (size_t i = 0; i < nShards; ++i) {
+    m_shards.push_back(make_unique<Shard>());
+    Shard& shard = *m_shards.back();
+    shard.nHits = shard.nMisses = shard.nInsertions = shard.nEvictions = shard.nInvalidations = 0;
+  }
+}
+
+VerificationCache::~VerificationCache() = default;
+
+bool
+VerificationCache::verify(const Wire& data, evp_pkey_st* key)
+{
+  Digest keyDigest;
+  if (!computeKeyDigest(key, keyDigest.data()))
+    return DataSignature(data).verify(data, key);
+
+  ConstBufferPtr digest = data.getSha256Digest();
+  if (find(digest->data(), keyDigest.data()))
+    return true;
+
+  DataSignature signature(data);
+  if (!signature.verify(data, key))
+    return false;
+  insert(digest->data(), signature.getKeyId(), keyDigest.data());
+  return true;
+}
+
+bool
+VerificationCache::verify(const Wire& data, const DataSignature& signature, evp_pkey_st* key)
+{
+  Digest keyDigest;
+  if (!computeKeyDigest(key, keyDigest.data()))
+    return signature.verify(data, key);
+
+  ConstBufferPtr digest = data.getSha256Digest();
+  if (find(digest->data(), keyDigest.data()))
+    return true;
+
+  if (!signature.verify(data, key))
+    return false;
+  insert(digest->data(), signature.getKeyId(), keyDigest.data());
+  return true;
+}
+
+bool
+VerificationCache::computeKeyDigest(evp_pkey_st* key, uint8_t* keyDigest)
+{
+  if (key == nullptr) {
+    std::fill_n(keyDigest, std::tuple_size<Digest>::value, 0);
+    return true;
+  }
+
+  int size = i2d_PUBKEY(key, nullptr);
+  if (size <= 0)
+    return false;
+  std::vector<uint8_t> der(size);
+  uint8_t* end = der.data();
+  if (i2d_PUBKEY(key, &end) != size)
+    return false;
+  Sha256::compute(der.data(), der.size(), keyDigest);
+  return true;
+}
+
+bool
+VerificationCache::find(const uint8_t* digest, const uint8_t* keyDigest)
+{
+  Digest key;
+  std::copy(digest, digest + key.size(), key.begin());
+  Shard& shard = getShard(digest);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it == shard.index.end() ||
+      !std::equal(it->second->keyDigest.begin(), it->second->keyDigest.end(), keyDigest)) {
+    ++shard.nMisses;
+    return false;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+  ++shard.nHits;
+  return true;
+}
+
+void
+VerificationCache::insert(const uint8_t* digest, uint64_t keyId, const uint8_t* keyDigest)
+{
+  if (m_shardCapacity == 0)
+    return;
+
+  Digest key;
+  std::copy(digest, digest + key.size(), key.begin());
+  Digest keyIdentity;
+  std::copy(keyDigest, keyDigest + keyIdentity.size(), keyIdentity.begin());
+  Shard& shard = getShard(digest);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    it->second->keyDigest = keyIdentity;
+    it->second->keyId = keyId;
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return;
+  }
+
+  if (shard.entries.size() >= m_shardCapacity) {
+    shard.index.erase(shard.entries.back().digest);
+    shard.entries.pop_back();
+    ++shard.nEvictions;
+  }
+  shard.entries.push_front(Entry{key, keyIdentity, keyId});
+  shard.index.emplace(key, shard.entries.begin());
+  ++shard.nInsertions;
+}
+
+size_t
+VerificationCache::invalidateKey(const uint8_t* keyLocator, size_t size)
+{
+  uint64_t keyId = FastHash::compute(keyLocator, size);
+  size_t nRemoved = 0;
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (auto it = shard->entries.begin(); it != shard->entries.end(); ) {
+      if (it->keyId != keyId) {
+        ++it;
+        continue;
+      }
+      shard->index.erase(it->digest);
+      it = shard->entries.erase(it);
+      ++shard->nInvalidations;
+      ++nRemoved;
+    }
+  }
+  return nRemoved;
+}
+
+void
+VerificationCache::clear()
+{
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->index.clear();
+    shard->entries.clear();
+  }
+}
+
+VerificationCache::Statistics
+VerificationCache::getStatistics() const
+{
+  Statistics statistics = {};
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    statistics.nHits += shard->nHits;
+    statistics.nMisses += shard->nMisses;
+    statistics.nInsertions += shard->nInsertions;
+    statistics.nEvictions += shard->nEvictions;
+    statistics.nInvalidations += shard->nInvalidations;
+    statistics.nEntries += shard->entries.size();
+  }
+  return statistics;
+}
+
+VerificationCache::Shard&
+VerificationCache::getShard(const uint8_t* digest)
+{
+  // bytes other than those of DigestHash, so that shards do not skew their buckets
+  uint64_t hash;
+  std::memcpy(&hash, digest + 8, sizeof(hash));
+  return *m_shards[hash % m_shards.size()];
+}
+
+} // namespace ndn
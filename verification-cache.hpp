@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_VERIFICATION_CACHE_HPP
+#define NDN_ENCODING_VERIFICATION_CACHE_HPP
+
+#include "data-signature.hpp"
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace ndn {
+
+/** @brief Bounded cache of successful Data signature verifications, keyed by packet digest
+ *
+ *  An entry records that the Data packet with a given implicit SHA-256 digest has a valid
+ *  signature under a given public key.  The key is identified by the SHA-256 digest of its
+ *  DER-encoded SubjectPublicKeyInfo (see computeKeyDigest()), and a lookup hits only with the
+ *  same key: the packet digest covers the KeyLocator, which names a key but does not prove
+ *  which one the caller trusts.  A hit skips both parsing the signature and the public-key
+ *  operation.  Each entry also keeps a hash of the KeyLocator so that invalidateKey() can drop
+ *  every packet signed by a revoked or replaced key.  Failed verifications are not cached: the
+ *  key may only be missing for now.
+ *
+ *  Entries are spread over shards by digest, each an LRU list with its own mutex, so threads
+ *  verifying different packets rarely contend.  All member functions are thread-safe.
+ */
+class VerificationCache : noncopyable
+{
+public:
+  /** @brief Snapshot of cache counters, summed over the shards
+   */
+  struct Statistics
+  {
+    uint64_t nHits;
+    uint64_t nMisses;
+    uint64_t nInsertions;
+    uint64_t nEvictions;
+    uint64_t nInvalidations; ///< entries removed by invalidateKey()
+    size_t nEntries;
+
+    /** @brief Return the fraction of lookups that hit, 0 if there were none
+     */
+    double
+    getHitRate() const
+    {
+      uint64_t nLookups = nHits + nMisses;
+      return nLookups == 0 ? 0.0 : static_cast<double>(nHits) / nLookups;
+    }
+  };
+
+  /** @brief Create a cache of at most @p capacity entries, split into @p nShards shards
+   */
+  explicit
+  VerificationCache(size_t capacity, size_t nShards = 16);
+
+  ~VerificationCache();
+
+  /** @brief Check the signature of the Data packet @p data, using the cached result if any
+   *  @param key public key passed to DataSignature::verify() on a miss; only a result cached
+   *             for this same key is used
+   *  @throw DataSignature::Error on a miss, @p data is not a signed Data packet
+   */
+  bool
+  verify(const Wire& data, evp_pkey_st* key);
+
+  /** @brief Check the signature of the Data packet @p data, located already in @p signature
+   */
+  bool
+  verify(const Wire& data, const DataSignature& signature, evp_pkey_st* key);
+
+  /** @brief Return whether the packet with implicit digest @p digest is known to be valid
+   *         under the key with identity @p keyDigest
+   */
+  bool
+  find(const uint8_t* digest, const uint8_t* keyDigest);
+
+  /** @brief Record that the packet with implicit digest @p digest, signed by the key with
+   *         id @p keyId (see DataSignature::getKeyId()), is valid under the key with
+   *         identity @p keyDigest
+   */
+  void
+  insert(const uint8_t* digest, uint64_t keyId, const uint8_t* keyDigest);
+
+  /** @brief Write the identity of @p key, the SHA-256 digest of its DER-encoded
+   *         SubjectPublicKeyInfo, to the 32 bytes at @p keyDigest
+   *
+   *  A null key, as used with DigestSha256 signatures, has an all-zero identity.
+   *  @return false if @p key cannot be encoded
+   */
+  static bool
+  computeKeyDigest(evp_pkey_st* key, uint8_t* keyDigest);
+
+  /** @brief Remove the entries of packets signed by the key with KeyLocator TLV
+   *         [@p keyLocator, @p keyLocator + @p size)
+   *  @return the number of entries removed
+   */
+  size_t
+  invalidateKey(const uint8_t* keyLocator, size_t size);
+
+  /** @brief Remove all entries, keeping the counters
+   */
+  void
+  clear();
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+  Statistics
+  getStatistics() const;
+
+private:
+  typedef std::array<uint8_t, 32> Digest;
+
+  struct Entry
+  {
+    Digest digest;
+    Digest keyDigest; ///< identity of the key the packet was verified with
+    uint64_t keyId;
+  };
+
+  typedef std::list<Entry> EntryList; // most recently used first
+
+  struct DigestHash
+  {
+    size_t
+    operator()(const Digest& digest) const;
+  };
+
+  struct Shard
+  {
+    std::mutex mutex;
+    EntryList entries;
+    std::unordered_map<Digest, EntryList::iterator, DigestHash> index;
+    uint64_t nHits;
+    uint64_t nMisses;
+    uint64_t nInsertions;
+    uint64_t nEvictions;
+    uint64_t nInvalidations;
+  };
+
+  Shard&
+  getShard(const uint8_t* digest);
+
+private:
+  size_t m_capacity;
+  size_t m_shardCapacity;
+  std::vector<unique_ptr<Shard>> m_shards;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_VERIFICATION_CACHE_HPP
@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/verification-cache.hpp"
+
+#include "boost-test.hpp"
+#include "make-signed-data.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+static unique_ptr<Wire>
+makeKeyName(char id)
+{
+  const uint8_t keyName[] = {0x07, 0x03, 0x08, 0x01, static_cast<uint8_t>(id)};
+  unique_ptr<Wire> wire = make_unique<Wire>(16);
+  wire->appendArray(keyName, sizeof(keyName));
+  return wire;
+}
+
+BOOST_AUTO_TEST_SUITE(EncodingVerificationCache)
+
+BOOST_AUTO_TEST_CASE(HitSkipsVerification)
+{
+  shared_ptr<EVP_PKEY> key = generateEcKey();
+  PrivateKeySigner signer(key.get());
+  unique_ptr<Wire> keyName = makeKeyName('a');
+  unique_ptr<Wire> data = makeSignedData(signer, 1, keyName.get());
+
+  VerificationCache cache(100);
+  BOOST_CHECK(cache.verify(*data, key.get()));
+  BOOST_CHECK(cache.verify(*data, key.get()));
+  BOOST_CHECK(cache.verify(*data, DataSignature(*data), key.get()));
+  uint8_t keyDigest[32];
+  BOOST_REQUIRE(VerificationCache::computeKeyDigest(key.get(), keyDigest));
+  BOOST_CHECK(cache.find(data->getSha256Digest()->data(), keyDigest));
+
+  VerificationCache::Statistics statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.nHits, 3);
+  BOOST_CHECK_EQUAL(statistics.nMisses, 1);
+  BOOST_CHECK_EQUAL(statistics.nInsertions, 1);
+  BOOST_CHECK_EQUAL(statistics.nEntries, 1);
+  BOOST_CHECK_CLOSE(statistics.getHitRate(), 0.75, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(FailureNotCached)
+{
+  shared_ptr<EVP_PKEY> key = generateEcKey();
+  shared_ptr<EVP_PKEY> otherKey = generateEcKey();
+  PrivateKeySigner signer(key.get());
+  unique_ptr<Wire> data = makeSignedData(signer, 1);
+
+  VerificationCache cache(100);
+  BOOST_CHECK(!cache.verify(*data, otherKey.get()));
+  BOOST_CHECK(!cache.verify(*data, nullptr));
+  BOOST_CHECK_EQUAL(cache.getStatistics().nEntries, 0);
+  BOOST_CHECK(cache.verify(*data, key.get()));
+  BOOST_CHECK_EQUAL(cache.getStatistics().nEntries, 1);
+  BOOST_CHECK_EQUAL(cache.getStatistics().getHitRate(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(HitNeedsSameKey)
+{
+  shared_ptr<EVP_PKEY> keyA = generateEcKey();
+  shared_ptr<EVP_PKEY> keyB = generateEcKey();
+  PrivateKeySigner signer(keyA.get());
+  unique_ptr<Wire> data = makeSignedData(signer, 1);
+
+  VerificationCache cache(100);
+  BOOST_CHECK(cache.verify(*data, keyA.get()));
+  // the entry for keyA does not vouch for the packet under keyB, nor without a key
+  BOOST_CHECK(!cache.verify(*data, keyB.get()));
+  BOOST_CHECK(!cache.verify(*data, DataSignature(*data), keyB.get()));
+  BOOST_CHECK(!cache.verify(*data, nullptr));
+  BOOST_CHECK(cache.verify(*data, keyA.get()));
+
+  VerificationCache::Statistics statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.nHits, 1);
+  BOOST_CHECK_EQUAL(statistics.nMisses, 4);
+  BOOST_CHECK_EQUAL(statistics.nEntries, 1);
+
+  uint8_t digestA[32];
+  uint8_t digestB[32];
+  BOOST_REQUIRE(VerificationCache::computeKeyDigest(keyA.get(), digestA));
+  BOOST_REQUIRE(VerificationCache::computeKeyDigest(keyB.get(), digestB));
+  BOOST_CHECK(!std::equal(digestA, digestA + 32, digestB));
+}
+
+BOOST_AUTO_TEST_CASE(InvalidateKey)
+{
+  shared_ptr<EVP_PKEY> keyA = generateEcKey();
+  shared_ptr<EVP_PKEY> keyB = generateEcKey();
+  PrivateKeySigner signerA(keyA.get());
+  PrivateKeySigner signerB(keyB.get());
+  unique_ptr<Wire> keyNameA = makeKeyName('a');
+  unique_ptr<Wire> keyNameB = makeKeyName('b');
+
+  std::vector<unique_ptr<Wire>> dataA;
+  std::vector<unique_ptr<Wire>> dataB;
+  VerificationCache cache(100);
+  for (uint8_t i = 0; i < 3; ++i) {
+    dataA.push_back(makeSignedData(signerA, i, keyNameA.get()));
+    dataB.push_back(makeSignedData(signerB, i, keyNameB.get()));
+    BOOST_CHECK(cache.verify(*dataA.back(), keyA.get()));
+    BOOST_CHECK(cache.verify(*dataB.back(), keyB.get()));
+  }
+
+  std::vector<uint8_t> keyLocatorA = DataSignature(*dataA[0]).getKeyLocator();
+  BOOST_CHECK_EQUAL(cache.invalidateKey(keyLocatorA.data(), keyLocatorA.size()), 3);
+  BOOST_CHECK_EQUAL(cache.invalidateKey(keyLocatorA.data(), keyLocatorA.size()), 0);
+  uint8_t keyDigestA[32];
+  BOOST_REQUIRE(VerificationCache::computeKeyDigest(keyA.get(), keyDigestA));
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK(!cache.find(dataA[i]->getSha256Digest()->data(), keyDigestA));
+    BOOST_CHECK(cache.verify(*dataB[i], keyB.get()));
+  }
+
+  VerificationCache::Statistics statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.nInvalidations, 3);
+  BOOST_CHECK_EQUAL(statistics.nEntries, 3);
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.getStatistics().nEntries, 0);
+  BOOST_CHECK_EQUAL(cache.getStatistics().nInsertions, 6);
+}
+
+BOOST_AUTO_TEST_CASE(LruEviction)
+{
+  VerificationCache cache(4, 1);
+  uint8_t digests[6][32] = {};
+  uint8_t keyDigest[32] = {};
+  for (uint8_t i = 0; i < 6; ++i) {
+    digests[i][0] = i;
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    cache.insert(digests[i], 0, keyDigest);
+  }
+  // digest 0 becomes the most recently used, so digests 1 and 2 are evicted
+  BOOST_CHECK(cache.find(digests[0], keyDigest));
+  cache.insert(digests[4], 0, keyDigest);
+  cache.insert(digests[5], 0, keyDigest);
+
+  BOOST_CHECK(cache.find(digests[0], keyDigest));
+  BOOST_CHECK(!cache.find(digests[1], keyDigest));
+  BOOST_CHECK(!cache.find(digests[2], keyDigest));
+  BOOST_CHECK(cache.find(digests[3], keyDigest));
+  BOOST_CHECK(cache.find(digests[5], keyDigest));
+
+  VerificationCache::Statistics statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.nEvictions, 2);
+  BOOST_CHECK_EQUAL(statistics.nEntries, 4);
+
+  VerificationCache disabled(0);
+  disabled.insert(digests[0], 0, keyDigest);
+  BOOST_CHECK(!disabled.find(digests[0], keyDigest));
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentVerifiers)
+{
+  const size_t N_THREADS = 4;
+  const size_t N_PACKETS = 50;
+  const size_t N_ROUNDS = 10;
+  VerificationCache cache(10000);
+
+  // each thread verifies its own wires, some of them shared in content with other threads
+  std::vector<std::thread> threads;
+  std::vector<size_t> nValid(N_THREADS);
+  for (size_t t = 0; t < N_THREADS; ++t) {
+    threads.emplace_back([&cache, &nValid, t, N_PACKETS, N_ROUNDS] {
+      DigestSha256Signer signer;
+      std::vector<unique_ptr<Wire>> packets;
+      for (size_t i = 0; i < N_PACKETS; ++i) {
+        packets.push_back(makeSignedData(signer, static_cast<uint8_t>(t * N_PACKETS / 2 + i)));
+      }
+      for (size_t round = 0; round < N_ROUNDS; ++round) {
+        for (const auto& data : packets) {
+          nValid[t] += cache.verify(*data, nullptr);
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t t = 0; t < N_THREADS; ++t) {
+    BOOST_CHECK_EQUAL(nValid[t], N_PACKETS * N_ROUNDS);
+  }
+  VerificationCache::Statistics statistics = cache.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.nHits + statistics.nMisses, N_THREADS * N_PACKETS * N_ROUNDS);
+  // 125 distinct packets, each inserted at least once, at most once by each thread
+  BOOST_CHECK_EQUAL(statistics.nEntries, 125);
+  BOOST_CHECK_GE(statistics.nInsertions, 125);
+  BOOST_CHECK_EQUAL(statistics.nEvictions, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
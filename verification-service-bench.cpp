@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/verification-service.hpp"
+
+#include "boost-test.hpp"
+#include "make-signed-data.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+/** @brief Synthetic corpus: Data packets with a 1 KB Content, signed by a few ECDSA keys
+ */
+class SyntheticCorpus
+{
+public:
+  SyntheticCorpus(size_t nPackets, size_t nKeys)
+  {
+    std::vector<uint8_t> payload(1024, 0x42);
+    for (size_t i = 0; i < nKeys; ++i) {
+      keys.push_back(generateEcKey());
+    }
+    for (size_t i = 0; i < nPackets; ++i) {
+      EVP_PKEY* key = keys[i % nKeys].get();
+      PrivateKeySigner signer(key);
+      std::vector<uint8_t> name = {0x07, 0x0B, 0x08, 0x05, 'b', 'e', 'n', 'c', 'h', 0x08, 0x02,
+                                   static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+      shared_ptr<const Wire> data = makeSignedData(signer, name, payload);
+      packets.push_back(data);
+      packetKeys.push_back(key);
+    }
+  }
+
+public:
+  std::vector<shared_ptr<EVP_PKEY>> keys;
+  std::vector<shared_ptr<const Wire>> packets;
+  std::vector<EVP_PKEY*> packetKeys;
+};
+
+BOOST_AUTO_TEST_CASE(VerificationServiceScaling)
+{
+  SyntheticCorpus corpus(4000, 8);
+  size_t nCores = std::max(1u, std::thread::hardware_concurrency());
+  std::cout << corpus.packets.size() << " ECDSA P-256 packets, " << corpus.keys.size()
+            << " keys, " << nCores << " cores" << std::endl;
+
+  // inline verification on the parsing thread, the baseline
+  auto start = std::chrono::steady_clock::now();
+  size_t nValid = 0;
+  for (size_t i = 0; i < corpus.packets.size(); ++i) {
+    const Wire& data = *corpus.packets[i];
+    nValid += DataSignature(data).verify(data, corpus.packetKeys[i]);
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  BOOST_CHECK_EQUAL(nValid, corpus.packets.size());
+  double baseline = corpus.packets.size() / time.count();
+  std::cout << std::setw(10) << "inline" << std::setw(12) << std::fixed << std::setprecision(0)
+            << baseline << " packets/s" << std::endl;
+
+  std::vector<size_t> threadCounts;
+  for (size_t nThreads = 1; nThreads < nCores; nThreads *= 2) {
+    threadCounts.push_back(nThreads);
+  }
+  threadCounts.push_back(nCores);
+
+  for (size_t nThreads : threadCounts) {
+    VerificationService::Options options;
+    options.nThreads = nThreads;
+    VerificationService service(options);
+    VerificationService::CompletionQueue queue;
+    std::vector<VerificationService::Completion> completions;
+    completions.reserve(corpus.packets.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < corpus.packets.size(); ++i) {
+      service.submit(queue, corpus.packets[i], corpus.packetKeys[i], i);
+      queue.poll(completions);
+    }
+    while (queue.wait(completions) > 0) {
+    }
+    time = std::chrono::steady_clock::now() - start;
+
+    nValid = std::count_if(completions.begin(), completions.end(),
+                           [] (const VerificationService::Completion& c) { return c.isValid; });
+    BOOST_CHECK_EQUAL(nValid, corpus.packets.size());
+    double throughput = corpus.packets.size() / time.count();
+    std::cout << std::setw(3) << nThreads << " threads" << std::setw(12) << std::fixed
+              << std::setprecision(0) << throughput << " packets/s " << std::setprecision(2)
+              << std::setw(6) << throughput / baseline << "x" << std::endl;
+  }
+}
+
+} // namespace tests
+} // namespace ndn
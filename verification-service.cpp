@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "verification-service.hpp"
+
+#include <iterator>
+
+namespace ndn {
+
+VerificationService::CompletionQueue::CompletionQueue()
+  : m_nOutstanding(0)
+{
+}
+
+size_t
+VerificationService::CompletionQueue::poll(std::vector<Completion>& completions)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t nCompletions = m_completions.size();
+  std::move(m_completions.begin(), m_completions.end(), std::back_inserter(completions));
+  m_completions.clear();
+  m_nOutstanding -= nCompletions;
+  return nCompletions;
+}
+
+size_t
+VerificationService::CompletionQueue::wait(std::vector<Completion>& completions)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_hasCompletions.wait(lock, [this] { return !m_completions.empty() || m_nOutstanding == 0; });
+  size_t nCompletions = m_completions.size();
+  std::move(m_completions.begin(), m_completions.end(), std::back_inserter(completions));
+  m_completions.clear();
+  m_nOutstanding -= nCompletions;
+  return nCompletions;
+}
+
+size_t
+VerificationService::CompletionQueue::getOutstanding() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nOutstanding;
+}
+
+void
+VerificationService::CompletionQueue::push(Completion&& completion)
+{
+  // notified under the lock: once the completion is visible, the queue may be destroyed
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_completions.push_back(std::move(completion));
+  m_hasCompletions.notify_one();
+}
+
+VerificationService::VerificationService(const Options& options, VerificationCache* cache)
+  : m_options(options)
+  , m_cache(cache)
+  , m_nPending(0)
+  , m_nBlockedSubmitters(0)
+  , m_isStopping(false)
+{
+  m_options.nThreads = std::max<size_t>(1, m_options.nThreads);
+  m_options.maxPending = std::max<size_t>(1, m_options.maxPending);
+  m_options.maxBatchSize = std::max<size_t>(1, m_options.maxBatchSize);
+
+  for (size_t i = 0; i < m_options.nThreads; ++i) {
+    m_workers.push_back(make_unique<Worker>());
+  }
+  for (size_t i = 0; i < m_options.nThreads; ++i) {
+    m_workers[i]->thread = std::thread(&VerificationService::runWorker, this, i);
+  }
+}
+
+VerificationService::~VerificationService()
+{
+  m_isStopping = true;
+  for (const auto& worker : m_workers) {
+    {
+      // a worker checks m_isStopping under its mutex before waiting
+      std::lock_guard<std::mutex> lock(worker->mutex);
+    }
+    worker->hasWork.notify_one();
+  }
+  for (const auto& worker : m_workers) {
+    worker->thread.join();
+  }
+}
+
+void
+VerificationService::submit(CompletionQueue& queue, shared_ptr<const Wire> data,
+                            evp_pkey_st* key, uint64_t tag)
+{
+  if (!reservePending()) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_nBlockedSubmitters;
+    m_notFull.wait(lock, [this] { return reservePending(); });
+    --m_nBlockedSubmitters;
+  }
+  enqueue(Request{&queue, std::move(data), key, tag});
+}
+
+bool
+VerificationService::trySubmit(CompletionQueue& queue, shared_ptr<const Wire> data,
+                               evp_pkey_st* key, uint64_t tag)
+{
+  if (!reservePending())
+    return false;
+  enqueue(Request{&queue, std::move(data), key, tag});
+  return true;
+}
+
+size_t
+VerificationService::getPending() const
+{
+  return m_nPending;
+}
+
+bool
+VerificationService::reservePending()
+{
+  size_t nPending = m_nPending;
+  do {
+    if (nPending >= m_options.maxPending)
+      return false;
+  } while (!m_nPending.compare_exchange_weak(nPending, nPending + 1));
+  return true;
+}
+
+void
+VerificationService::releasePending(size_t nCompleted)
+{
+  m_nPending -= nCompleted;
+  // a blocked submitter is counted before it checks m_nPending under m_mutex, so either it
+  // sees this release or it is counted here and waiting by the time the lock is acquired
+  if (m_nBlockedSubmitters > 0) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notFull.notify_all();
+  }
+}
+
+void
+VerificationService::enqueue(Request&& request)
+{
+  {
+    std::lock_guard<std::mutex> lock(request.queue->m_mutex);
+    ++request.queue->m_nOutstanding;
+  }
+
+  // key objects are aligned, so their addresses are mixed before picking a worker
+  uint64_t hash = reinterpret_cast<uintptr_t>(request.key) * UINT64_C(0x9E3779B97F4A7C15);
+  size_t index = (hash >> 32) % m_workers.size();
+  Worker& owner = *m_workers[index];
+  {
+    std::lock_guard<std::mutex> lock(owner.mutex);
+    owner.requests.push_back(std::move(request));
+  }
+  owner.hasWork.notify_one();
+  if (owner.isIdle)
+    return;
+
+  // the owner is busy: let an idle worker steal the request
+  for (size_t i = 1; i < m_workers.size(); ++i) {
+    Worker& thief = *m_workers[(index + i) % m_workers.size()];
+    if (thief.isIdle) {
+      {
+        std::lock_guard<std::mutex> lock(thief.mutex);
+        thief.shouldSteal = true;
+      }
+      thief.hasWork.notify_one();
+      return;
+    }
+  }
+}
+
+bool
+VerificationService::takeBatch(size_t index, std::vector<Request>& batch)
+{
+  Worker& own = *m_workers[index];
+  {
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.requests.empty()) {
+      // the front request and the requests with its key among the next few
+      evp_pkey_st* key = own.requests.front().key;
+      size_t window = std::min(own.requests.size(), 4 * m_options.maxBatchSize);
+      size_t nKept = 0;
+      for (size_t i = 0; i < window; ++i) {
+        Request& request = own.requests[i];
+        if (request.key == key && batch.size() < m_options.maxBatchSize) {
+          batch.push_back(std::move(request));
+        }
+        else {
+          if (nKept != i)
+            own.requests[nKept] = std::move(request);
+          ++nKept;
+        }
+      }
+      own.requests.erase(own.requests.begin() + nKept, own.requests.begin() + window);
+      return true;
+    }
+  }
+
+  for (size_t i = 1; i < m_workers.size(); ++i) {
+    Worker& victim = *m_workers[(index + i) % m_workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.requests.empty()) {
+      batch.push_back(std::move(victim.requests.back()));
+      victim.requests.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+VerificationService::runWorker(size_t index)
+{
+  Worker& own = *m_workers[index];
+  std::vector<Request> batch;
+  std::vector<bool> results;
+  while (true) {
+    if (!takeBatch(index, batch)) {
+      std::unique_lock<std::mutex> lock(own.mutex);
+      if (own.requests.empty() && !own.shouldSteal) {
+        // requests are not submitted any more, and the other deques are drained by their owners
+        if (m_isStopping)
+          return;
+        own.isIdle = true;
+        own.hasWork.wait(lock, [&] {
+          return !own.requests.empty() || own.shouldSteal || m_isStopping;
+        });
+        own.isIdle = false;
+      }
+      own.shouldSteal = false;
+      continue;
+    }
+
+    for (Request& request : batch) {
+      bool isValid = false;
+      try {
+        if (m_cache != nullptr)
+          isValid = m_cache->verify(*request.data, request.key);
+        else
+          isValid = DataSignature(*request.data).verify(*request.data, request.key);
+      }
+      catch (const tlv::Error&) {
+      }
+      results.push_back(isValid);
+    }
+
+    // released first, so that a submitter holding all its completions sees them completed
+    releasePending(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      Request& request = batch[i];
+      request.queue->push(Completion{std::move(request.data), request.tag, results[i]});
+    }
+    batch.clear();
+    results.clear();
+  }
+}
+
+} // namespace ndn
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_VERIFICATION_SERVICE_HPP
+#define NDN_ENCODING_VERIFICATION_SERVICE_HPP
+
+#include "verification-cache.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+
+/** @brief Verifies the signatures of Data packets on a pool of worker threads
+ *
+ *  A thread submits a parsed Data Wire together with the key to check it against and a
+ *  CompletionQueue of its own, then goes on with other work and collects the results from
+ *  that queue when it likes.  Each worker has a deque of pending requests: a request goes to
+ *  the deque of the worker its key hashes to, and a worker whose deque is empty steals from
+ *  the back of the others.  A worker takes the request at the front of its deque along with
+ *  the following ones with the same key, up to Options::maxBatchSize, and checks them back to
+ *  back, so that the key stays hot in its cache and the deque is locked once per batch.
+ *  A request wakes only the worker that owns its deque, plus one idle worker to steal it if
+ *  the owner is busy.
+ *
+ *  At most Options::maxPending requests are in flight: submit() then blocks until one
+ *  completes, and trySubmit() fails, so producers slow down to the pace of the pool.  The
+ *  count is atomic; the service-wide mutex is only taken by submitters waiting on a full pool
+ *  and by the workers waking them.
+ *
+ *  If a VerificationCache is given, workers look each packet up before verifying it and
+ *  record valid packets in it.
+ */
+class VerificationService : noncopyable
+{
+public:
+  struct Options
+  {
+    Options()
+      : nThreads(std::max(1u, std::thread::hardware_concurrency()))
+      , maxPending(4096)
+      , maxBatchSize(16)
+    {
+    }
+
+    size_t nThreads;     ///< worker threads
+    size_t maxPending;   ///< requests submitted and not completed, beyond which submit() waits
+    size_t maxBatchSize; ///< same-key requests a worker takes at a time
+  };
+
+  /** @brief Result of a request
+   */
+  struct Completion
+  {
+    shared_ptr<const Wire> data;
+    uint64_t tag;  ///< as given to submit()
+    bool isValid;  ///< false also if the packet is not a signed Data packet
+  };
+
+  /** @brief Queue receiving the completions of the requests of one submitter
+   *
+   *  A queue must outlive the requests submitted with it.
+   */
+  class CompletionQueue : noncopyable
+  {
+  public:
+    CompletionQueue();
+
+    /** @brief Move the completions received so far to the end of @p completions
+     *  @return the number of completions moved
+     */
+    size_t
+    poll(std::vector<Completion>& completions);
+
+    /** @brief Like poll(), but wait for at least one completion if any request is outstanding
+     */
+    size_t
+    wait(std::vector<Completion>& completions);
+
+    /** @brief Return the number of requests submitted with this queue and not collected yet
+     */
+    size_t
+    getOutstanding() const;
+
+  private:
+    void
+    push(Completion&& completion);
+
+  private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_hasCompletions;
+    std::vector<Completion> m_completions;
+    size_t m_nOutstanding;
+
+    friend class VerificationService;
+  };
+
+  explicit
+  VerificationService(const Options& options = Options(), VerificationCache* cache = nullptr);
+
+  /** @brief Complete the pending requests, then stop the workers
+   */
+  ~VerificationService();
+
+  /** @brief Verify the Data packet @p data against @p key, waiting while the pool is saturated
+   *
+   *  The completion, carrying @p tag, is delivered to @p queue.  Until then @p data must not be
+   *  modified nor submitted again, and @p key must stay valid.
+   *  @sa DataSignature::verify()
+   */
+  void
+  submit(CompletionQueue& queue, shared_ptr<const Wire> data, evp_pkey_st* key, uint64_t tag = 0);
+
+  /** @brief Like submit(), but fail instead of waiting
+   *  @return whether the request was submitted
+   */
+  bool
+  trySubmit(CompletionQueue& queue, shared_ptr<const Wire> data, evp_pkey_st* key,
+            uint64_t tag = 0);
+
+  /** @brief Return the number of requests submitted and not completed
+   */
+  size_t
+  getPending() const;
+
+private:
+  struct Request
+  {
+    CompletionQueue* queue;
+    shared_ptr<const Wire> data;
+    evp_pkey_st* key;
+    uint64_t tag;
+  };
+
+  struct Worker
+  {
+    Worker()
+      : isIdle(false)
+      , shouldSteal(false)
+    {
+    }
+
+    std::mutex mutex;
+    std::condition_variable hasWork;
+    std::deque<Request> requests;
+    std::atomic<bool> isIdle; ///< waiting on hasWork
+    bool shouldSteal;         ///< woken to steal from a busy worker, guarded by mutex
+    std::thread thread;
+  };
+
+  /** @brief Count one more pending request unless Options::maxPending are pending
+   */
+  bool
+  reservePending();
+
+  /** @brief Count @p nCompleted requests as completed, waking blocked submitters if any
+   */
+  void
+  releasePending(size_t nCompleted);
+
+  void
+  enqueue(Request&& request);
+
+  /** @brief Take a batch of same-key requests from the deque of worker @p index, or steal one
+   *         from another worker
+   */
+  bool
+  takeBatch(size_t index, std::vector<Request>& batch);
+
+  void
+  runWorker(size_t index);
+
+private:
+  Options m_options;
+  VerificationCache* m_cache;
+
+  std::mutex m_mutex; // only for waiting on m_notFull
+  std::condition_variable m_notFull;
+  std::atomic<size_t> m_nPending; // requests submitted and not completed
+  std::atomic<size_t> m_nBlockedSubmitters;
+  std::atomic<bool> m_isStopping;
+  std::vector<unique_ptr<Worker>> m_workers;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_VERIFICATION_SERVICE_HPP
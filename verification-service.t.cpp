@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/verification-service.hpp"
+
+#include "boost-test.hpp"
+#include "make-signed-data.hpp"
+
+namespace ndn {
+namespace tests {
+
+/** @brief Collect the completions of all requests submitted with @p queue
+ */
+static std::vector<VerificationService::Completion>
+collect(VerificationService::CompletionQueue& queue)
+{
+  std::vector<VerificationService::Completion> completions;
+  while (queue.wait(completions) > 0) {
+  }
+  return completions;
+}
+
+BOOST_AUTO_TEST_SUITE(EncodingVerificationService)
+
+BOOST_AUTO_TEST_CASE(Verify)
+{
+  shared_ptr<EVP_PKEY> keyA = generateEcKey();
+  shared_ptr<EVP_PKEY> keyB = generateEcKey();
+  PrivateKeySigner signerA(keyA.get());
+  PrivateKeySigner signerB(keyB.get());
+
+  VerificationService::Options options;
+  options.nThreads = 3;
+  VerificationService service(options);
+  VerificationService::CompletionQueue queue;
+
+  // packets i signed by A when i is even, checked against A when i % 3 != 0
+  std::vector<shared_ptr<const Wire>> packets;
+  for (uint8_t i = 0; i < 60; ++i) {
+    packets.push_back(makeSignedData(i % 2 == 0 ? signerA : signerB, i));
+    service.submit(queue, packets.back(), i % 3 != 0 ? keyA.get() : keyB.get(), i);
+  }
+  const uint8_t notData[] = {0x05, 0x02, 0x07, 0x00};
+  shared_ptr<Wire> interest = make_shared<Wire>(16);
+  interest->appendArray(notData, sizeof(notData));
+  service.submit(queue, interest, keyA.get(), 1000);
+
+  std::vector<VerificationService::Completion> completions = collect(queue);
+  BOOST_REQUIRE_EQUAL(completions.size(), 61);
+  BOOST_CHECK_EQUAL(queue.getOutstanding(), 0);
+  BOOST_CHECK_EQUAL(service.getPending(), 0);
+
+  std::vector<bool> isSeen(61);
+  for (const VerificationService::Completion& completion : completions) {
+    if (completion.tag == 1000) {
+      BOOST_CHECK(!completion.isValid);
+      isSeen[60] = true;
+      continue;
+    }
+    BOOST_REQUIRE_LT(completion.tag, 60);
+    BOOST_CHECK(completion.data == packets[completion.tag]);
+    bool isSignedByA = completion.tag % 2 == 0;
+    bool isCheckedWithA = completion.tag % 3 != 0;
+    BOOST_CHECK_EQUAL(completion.isValid, isSignedByA == isCheckedWithA);
+    isSeen[completion.tag] = true;
+  }
+  BOOST_CHECK(std::all_of(isSeen.begin(), isSeen.end(), [] (bool isTrue) { return isTrue; }));
+}
+
+BOOST_AUTO_TEST_CASE(Backpressure)
+{
+  shared_ptr<EVP_PKEY> key = generateEcKey();
+  PrivateKeySigner signer(key.get());
+
+  VerificationService::Options options;
+  options.nThreads = 1;
+  options.maxPending = 2;
+  VerificationService service(options);
+  VerificationService::CompletionQueue queue;
+
+  size_t nRejected = 0;
+  for (uint8_t i = 0; i < 50; ++i) {
+    shared_ptr<const Wire> data = makeSignedData(signer, i);
+    if (!service.trySubmit(queue, data, key.get(), i)) {
+      ++nRejected;
+      service.submit(queue, data, key.get(), i);
+    }
+    BOOST_CHECK_LE(service.getPending(), 2);
+  }
+  // an ECDSA verification takes much longer than a submission
+  BOOST_CHECK_GT(nRejected, 0);
+
+  std::vector<VerificationService::Completion> completions = collect(queue);
+  BOOST_CHECK_EQUAL(completions.size(), 50);
+  for (const VerificationService::Completion& completion : completions) {
+    BOOST_CHECK(completion.isValid);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Cache)
+{
+  DigestSha256Signer signer;
+  shared_ptr<const Wire> data = makeSignedData(signer, 1);
+  VerificationCache cache(100);
+  VerificationService service(VerificationService::Options(), &cache);
+  VerificationService::CompletionQueue queue;
+
+  for (int i = 0; i < 3; ++i) {
+    service.submit(queue, data, nullptr);
+    std::vector<VerificationService::Completion> completions = collect(queue);
+    BOOST_REQUIRE_EQUAL(completions.size(), 1);
+    BOOST_CHECK(completions[0].isValid);
+  }
+  BOOST_CHECK_EQUAL(cache.getStatistics().nMisses, 1);
+  BOOST_CHECK_EQUAL(cache.getStatistics().nHits, 2);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentSubmitters)
+{
+  const size_t N_SUBMITTERS = 4;
+  const size_t N_PACKETS = 100;
+  VerificationService::Options options;
+  options.nThreads = 2;
+  options.maxPending = 16;
+  VerificationService service(options);
+
+  // each submitter receives exactly the completions of its own requests
+  std::vector<std::thread> submitters;
+  std::vector<size_t> nValid(N_SUBMITTERS);
+  for (size_t s = 0; s < N_SUBMITTERS; ++s) {
+    submitters.emplace_back([&service, &nValid, s, N_PACKETS] {
+      DigestSha256Signer signer;
+      VerificationService::CompletionQueue queue;
+      std::vector<VerificationService::Completion> completions;
+      for (size_t i = 0; i < N_PACKETS; ++i) {
+        service.submit(queue, makeSignedData(signer, static_cast<uint8_t>(i)), nullptr, s);
+        queue.poll(completions);
+      }
+      while (queue.wait(completions) > 0) {
+      }
+      for (const VerificationService::Completion& completion : completions) {
+        nValid[s] += completion.tag == s && completion.isValid;
+      }
+    });
+  }
+  for (std::thread& submitter : submitters) {
+    submitter.join();
+  }
+
+  for (size_t s = 0; s < N_SUBMITTERS; ++s) {
+    BOOST_CHECK_EQUAL(nValid[s], N_PACKETS);
+  }
+  BOOST_CHECK_EQUAL(service.getPending(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_WIRE_ASIO_HPP
+#define NDN_ENCODING_WIRE_ASIO_HPP
+
+#include "wire_test.hpp"
+#include "byte-sink.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/write.hpp>
+
+namespace ndn {
+
+/** @brief Maximum number of buffers asio passes to a single gathering system call
+ */
+const size_t MAX_GATHER_BUFFERS = 64;
+
+/// @cond include_hidden
+namespace detail {
+
+inline shared_ptr<Buffer>
+linearize(const Wire::ConstBuffers& buffers)
+{
+  BufferSink sink;
+  for (Wire::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+    sink.append(static_cast<const uint8_t*>((*i).data()), (*i).size());
+  }
+  return sink.buf();
+}
+
+} // namespace detail
+/// @endcond
+
+/**
+ * @brief Write @p wire to a stream socket (TCP or Unix stream) with gathering writes
+ *
+ * The segments of the wire are written in place, and @p wire must stay unchanged until
+ * @p handler is invoked.
+ */
+template<class AsyncWriteStream, class WriteHandler>
+void
+asyncWrite(AsyncWriteStream& stream, const Wire& wire, WriteHandler handler)
+{
+  boost::asio::async_write(stream, wire.buffers(), handler);
+}
+
+/**
+ * @brief Send @p wire as one datagram on a connected datagram socket (UDP or Unix datagram)
+ *
+ * The segments of the wire are sent in place, and @p wire must stay unchanged until
+ * @p handler is invoked.  A wire of more than MAX_GATHER_BUFFERS segments is linearized
+ * first, because asio would silently send only the first of them.
+ */
+template<class DatagramSocket, class WriteHandler>
+void
+asyncSend(DatagramSocket& socket, const Wire& wire, WriteHandler handler)
+{
+  Wire::ConstBuffers buffers = wire.buffers();
+  if (buffers.count() <= MAX_GATHER_BUFFERS) {
+    socket.async_send(buffers, handler);
+    return;
+  }
+
+  shared_ptr<Buffer> buffer = detail::linearize(buffers);
+  socket.async_send(boost::asio::buffer(*buffer),
+                    [buffer, handler] (const boost::system::error_code& error,
+                                       size_t nBytesSent) mutable {
+                      handler(error, nBytesSent);
+                    });
+}
+
+/**
+ * @brief Send @p wire as one datagram to @p endpoint on a datagram socket
+ * @sa asyncSend
+ */
+template<class DatagramSocket, class WriteHandler>
+void
+asyncSendTo(DatagramSocket& socket, const Wire& wire,
+            const typename DatagramSocket::endpoint_type& endpoint, WriteHandler handler)
+{
+  Wire::ConstBuffers buffers = wire.buffers();
+  if (buffers.count() <= MAX_GATHER_BUFFERS) {
+    socket.async_send_to(buffers, endpoint, handler);
+    return;
+  }
+
+  shared_ptr<Buffer> buffer = detail::linearize(buffers);
+  socket.async_send_to(boost::asio::buffer(*buffer), endpoint,
+                       [buffer, handler] (const boost::system::error_code& error,
+                                          size_t nBytesSent) mutable {
+                         handler(error, nBytesSent);
+                       });
+}
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_WIRE_ASIO_HPP
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/wire-asio.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/datagram_protocol.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+
+namespace ndn {
+namespace tests {
+
+static_assert(boost::asio::is_const_buffer_sequence<Wire>::value,
+              "Wire must model ConstBufferSequence");
+static_assert(boost::asio::is_const_buffer_sequence<Wire::ConstBuffers>::value,
+              "Wire::ConstBuffers must model ConstBufferSequence");
+
+/** @brief Return a wire of @p nSegments non-empty segments and the bytes it holds
+ */
+static Wire
+makeSegmentedWire(size_t nSegments, std::vector<uint8_t>& bytes)
+{
+  bytes.clear();
+  Wire wire(2048);
+  for (size_t i = 0; i < nSegments; ++i) {
+    std::vector<uint8_t> segment(1 + i % 40, static_cast<uint8_t>(i));
+    wire.appendSharedBlock(BlockN(segment.data(), segment.size()));
+    bytes.insert(bytes.end(), segment.begin(), segment.end());
+  }
+  return wire;
+}
+
+class AsioFixture
+{
+public:
+  /** @brief Run the io_service until @p handler was invoked, then check its results
+   */
+  void
+  run(size_t expectedSize)
+  {
+    io.restart();
+    io.run();
+    BOOST_REQUIRE(isDone);
+    BOOST_CHECK(!error);
+    BOOST_CHECK_EQUAL(nBytesSent, expectedSize);
+    isDone = false;
+  }
+
+  std::function<void(const boost::system::error_code&, size_t)>
+  makeHandler()
+  {
+    return [this] (const boost::system::error_code& e, size_t n) {
+      error = e;
+      nBytesSent = n;
+      isDone = true;
+    };
+  }
+
+public:
+  boost::asio::io_service io;
+  bool isDone = false;
+  boost::system::error_code error;
+  size_t nBytesSent = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(EncodingWireAsio)
+
+BOOST_AUTO_TEST_CASE(ConstBufferSequence)
+{
+  std::vector<uint8_t> bytes;
+  Wire wire = makeSegmentedWire(5, bytes);
+  BOOST_CHECK_EQUAL(wire.buffers().count(), 6); // and the spare segment
+  BOOST_CHECK_EQUAL(boost::asio::buffer_size(wire), bytes.size());
+  BOOST_CHECK_EQUAL(boost::asio::buffer_size(wire.buffers()), bytes.size());
+
+  std::vector<uint8_t> gathered;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>((*i).data());
+    gathered.insert(gathered.end(), data, data + (*i).size());
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(gathered.begin(), gathered.end(), bytes.begin(), bytes.end());
+
+  std::vector<uint8_t> copied(bytes.size());
+  BOOST_CHECK_EQUAL(boost::asio::buffer_copy(boost::asio::buffer(copied), wire.buffers()),
+                    bytes.size());
+  BOOST_CHECK_EQUAL_COLLECTIONS(copied.begin(), copied.end(), bytes.begin(), bytes.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(StreamGather, AsioFixture)
+{
+  boost::asio::local::stream_protocol::socket sender(io);
+  boost::asio::local::stream_protocol::socket receiver(io);
+  boost::asio::local::connect_pair(sender, receiver);
+
+  std::vector<uint8_t> bytes;
+  Wire wire = makeSegmentedWire(100, bytes);
+  asyncWrite(sender, wire, makeHandler());
+  run(bytes.size());
+
+  std::vector<uint8_t> received(bytes.size());
+  boost::asio::read(receiver, boost::asio::buffer(received));
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(), bytes.begin(), bytes.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(DatagramGather, AsioFixture)
+{
+  boost::asio::local::datagram_protocol::socket sender(io);
+  boost::asio::local::datagram_protocol::socket receiver(io);
+  boost::asio::local::connect_pair(sender, receiver);
+
+  std::vector<uint8_t> bytes;
+  Wire wire = makeSegmentedWire(MAX_GATHER_BUFFERS - 1, bytes);
+  BOOST_REQUIRE_EQUAL(wire.buffers().count(), MAX_GATHER_BUFFERS);
+  asyncSend(sender, wire, makeHandler());
+  run(bytes.size());
+
+  std::vector<uint8_t> received(8800);
+  received.resize(receiver.receive(boost::asio::buffer(received)));
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(), bytes.begin(), bytes.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(DatagramLinearized, AsioFixture)
+{
+  boost::asio::local::datagram_protocol::socket sender(io);
+  boost::asio::local::datagram_protocol::socket receiver(io);
+  boost::asio::local::connect_pair(sender, receiver);
+
+  // asio would send only the first MAX_GATHER_BUFFERS segments of this wire
+  std::vector<uint8_t> bytes;
+  Wire wire = makeSegmentedWire(3 * MAX_GATHER_BUFFERS, bytes);
+  BOOST_REQUIRE_GT(wire.buffers().count(), MAX_GATHER_BUFFERS);
+  asyncSend(sender, wire, makeHandler());
+  run(bytes.size());
+
+  std::vector<uint8_t> received(8800);
+  received.resize(receiver.receive(boost::asio::buffer(received)));
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(), bytes.begin(), bytes.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(DatagramSendTo, AsioFixture)
+{
+  using boost::asio::ip::udp;
+  udp::socket receiver(io, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  udp::socket sender(io, udp::v4());
+
+  std::vector<uint8_t> bytes;
+  Wire small = makeSegmentedWire(10, bytes);
+  asyncSendTo(sender, small, receiver.local_endpoint(), makeHandler());
+  run(bytes.size());
+  std::vector<uint8_t> received(8800);
+  received.resize(receiver.receive(boost::asio::buffer(received)));
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(), bytes.begin(), bytes.end());
+
+  Wire large = makeSegmentedWire(2 * MAX_GATHER_BUFFERS, bytes);
+  asyncSendTo(sender, large, receiver.local_endpoint(), makeHandler());
+  run(bytes.size());
+  received.resize(8800);
+  received.resize(receiver.receive(boost::asio::buffer(received)));
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(), bytes.begin(), bytes.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
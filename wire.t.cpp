@@ -0,0 +1,553 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2016 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/wire_test.hpp"
+#include "encoding/segment-pool.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <algorithm>
+#include <thread>
+#include <unordered_set>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingWire)
+
+static std::vector<uint8_t>
+makeBytes(size_t size, uint8_t seed)
+{
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(seed + i * 7);
+  }
+  return bytes;
+}
+
+/** @brief Return a wire of two 1000-byte segments with 100 bytes used in each
+ */
+static Wire
+makeSparseWire(const std::vector<uint8_t>& bytes)
+{
+  Wire wire(1000);
+  wire.appendArray(bytes.data(), 100);
+  wire.expand(1000);
+  wire.expandIfNeeded();
+  wire.appendArray(bytes.data() + 100, 100);
+  return wire;
+}
+
+BOOST_AUTO_TEST_CASE(GetBufferResize)
+{
+  std::vector<uint8_t> bytes = makeBytes(200, 1);
+  Wire wire = makeSparseWire(bytes);
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), bytes.begin(), bytes.end());
+  BOOST_CHECK(buffer->get_allocator().isDefaultInit());
+
+  buffer->resize(300, 0);
+  BOOST_CHECK(std::equal(bytes.begin(), bytes.end(), buffer->begin()));
+  BOOST_CHECK(std::all_of(buffer->begin() + 200, buffer->end(), [] (uint8_t b) { return b == 0; }));
+}
+
+BOOST_AUTO_TEST_SUITE(Compaction)
+
+BOOST_AUTO_TEST_CASE(Compact)
+{
+  std::vector<uint8_t> bytes = makeBytes(200, 1);
+  Wire wire = makeSparseWire(bytes);
+  wire.finalize();
+  BOOST_CHECK_EQUAL(wire.countBlock(), 2);
+  BOOST_CHECK_EQUAL(wire.getSlack(), 1800);
+
+  BOOST_CHECK_EQUAL(wire.compact(), 1800);
+  BOOST_CHECK_EQUAL(wire.getSlack(), 0);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 1);
+  BOOST_CHECK_EQUAL(wire.size(), 200);
+  BOOST_CHECK_EQUAL(wire.capacity(), 200);
+
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), bytes.begin(), bytes.end());
+
+  // nothing is left to reclaim, and writing continues after the compacted bytes
+  BOOST_CHECK_EQUAL(wire.compact(), 0);
+  wire.appendArray(bytes.data(), 10);
+  BOOST_CHECK_EQUAL(wire.size(), 210);
+  BOOST_CHECK_EQUAL(wire.readUint8(205), bytes[5]);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferUntouched)
+{
+  shared_ptr<Buffer> held = make_shared<Buffer>(1000);
+  std::vector<uint8_t> bytes = makeBytes(100, 3);
+  std::copy(bytes.begin(), bytes.end(), held->begin());
+
+  Wire wire(held, held->begin(), held->begin() + 100);
+  BOOST_CHECK_EQUAL(wire.getSlack(), 0);
+  BOOST_CHECK_EQUAL(wire.compact(), 0);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 1);
+  BOOST_CHECK(wire.begin() != wire.end());
+  BOOST_CHECK_EQUAL(static_cast<const uint8_t*>((*wire.begin()).data()), held->data());
+
+  // once the buffer is no longer shared, its unused bytes are slack
+  const uint8_t* data = held->data();
+  held.reset();
+  BOOST_CHECK_EQUAL(wire.getSlack(), 900);
+  BOOST_CHECK_EQUAL(wire.compact(), 900);
+  BOOST_CHECK_NE(static_cast<const uint8_t*>((*wire.begin()).data()), data);
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), bytes.begin(), bytes.end());
+}
+
+BOOST_AUTO_TEST_CASE(AutoCompact)
+{
+  std::vector<uint8_t> bytes = makeBytes(200, 5);
+  Wire wire = makeSparseWire(bytes);
+  wire.setAutoCompactThreshold(2000);
+  wire.finalize();
+  BOOST_CHECK_EQUAL(wire.countBlock(), 2);
+
+  wire.setAutoCompactThreshold(1000);
+  wire.finalize();
+  BOOST_CHECK_EQUAL(wire.countBlock(), 1);
+  BOOST_CHECK_EQUAL(wire.getSlack(), 0);
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), bytes.begin(), bytes.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Compaction
+
+BOOST_AUTO_TEST_SUITE(SharedBlocks)
+
+/** @brief Return the used size of each block of @p wire
+ */
+static std::vector<size_t>
+getBlockSizes(const Wire& wire)
+{
+  std::vector<size_t> sizes;
+  for (Wire::const_iterator i = wire.begin(); i != wire.end(); ++i) {
+    sizes.push_back((*i).size());
+  }
+  return sizes;
+}
+
+static const uint8_t*
+getBlockData(const Wire& wire, size_t position)
+{
+  BlockN::const_iterator begin;
+  wire.findPosition(begin, position);
+  return begin;
+}
+
+BOOST_AUTO_TEST_CASE(AppendSharedBlock)
+{
+  std::vector<uint8_t> bytes = makeBytes(150, 7);
+  Wire wire(1000);
+  wire.appendArray(bytes.data(), 100);
+  const uint8_t* segment = getBlockData(wire, 0);
+
+  BlockN block(bytes.data() + 100, 50);
+  BOOST_CHECK_EQUAL(wire.appendSharedBlock(block), 50);
+  BOOST_CHECK_EQUAL(wire.size(), 150);
+  BOOST_CHECK_EQUAL(wire.position(), 150);
+  // the spare 900 bytes of the first segment follow the reference
+  BOOST_CHECK_EQUAL(wire.capacity(), 100 + 50 + 900);
+  std::vector<size_t> sizes = {100, 50, 0};
+  std::vector<size_t> actual = getBlockSizes(wire);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), sizes.begin(), sizes.end());
+
+  BlockN::const_iterator begin;
+  BlockN* reference = wire.findPosition(begin, 100);
+  BOOST_CHECK_EQUAL(reference->offset(), 100);
+  BOOST_CHECK_EQUAL(begin, block.begin());
+
+  // writing continues in the spare capacity of the first segment
+  wire.appendArray(bytes.data(), 10);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 3);
+  BOOST_CHECK_EQUAL(getBlockData(wire, 150), segment + 100);
+  BOOST_CHECK_EQUAL(wire.findPosition(begin, 155)->offset(), 150);
+  BOOST_CHECK_EQUAL(wire.capacity(), 1050);
+}
+
+BOOST_AUTO_TEST_CASE(AppendSharedBlocksInARow)
+{
+  std::vector<uint8_t> bytes = makeBytes(100, 8);
+  Wire wire(1000);
+  wire.appendArray(bytes.data(), 10);
+  const uint8_t* segment = getBlockData(wire, 0);
+  for (size_t i = 0; i < 3; ++i) {
+    wire.appendSharedBlock(BlockN(bytes.data(), 30));
+  }
+  wire.appendSharedBlock(BlockN(bytes.data(), 5)); // inline
+
+  // the spare left by each append is reused, so no empty block is left between references
+  std::vector<size_t> sizes = {10, 30, 30, 30, 5, 0};
+  std::vector<size_t> actual = getBlockSizes(wire);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), sizes.begin(), sizes.end());
+  BOOST_CHECK_EQUAL(wire.size(), 105);
+  BOOST_CHECK_EQUAL(wire.capacity(), 105 + 990);
+  BlockN::const_iterator begin;
+  BOOST_CHECK_EQUAL(wire.findPosition(begin, 70)->offset(), 70);
+  BOOST_CHECK_EQUAL(wire.findPosition(begin, 100)->offset(), 100);
+
+  wire.appendArray(bytes.data(), 1);
+  BOOST_CHECK_EQUAL(getBlockData(wire, 105), segment + 10);
+}
+
+BOOST_AUTO_TEST_CASE(AppendSharedBlockSmallSpare)
+{
+  std::vector<uint8_t> bytes = makeBytes(150, 9);
+  Wire wire(110);
+  wire.appendArray(bytes.data(), 100);
+
+  // 10 spare bytes are not worth a block of their own
+  BOOST_CHECK_EQUAL(wire.appendSharedBlock(BlockN(bytes.data() + 100, 50)), 50);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 2);
+  BOOST_CHECK_EQUAL(wire.capacity(), 150);
+
+  wire.appendArray(bytes.data(), 10);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 3);
+  BOOST_CHECK_EQUAL(wire.size(), 160);
+}
+
+BOOST_AUTO_TEST_CASE(AppendWire)
+{
+  std::vector<uint8_t> bytes = makeBytes(200, 11);
+  Wire source(100);
+  source.appendArray(bytes.data(), 150);
+  source.expand(500); // an empty trailing segment
+  BOOST_REQUIRE_EQUAL(source.countBlock(), 3);
+
+  Wire wire(1000);
+  wire.appendArray(bytes.data() + 150, 10);
+  const uint8_t* segment = getBlockData(wire, 0);
+  BOOST_CHECK_EQUAL(wire.appendWire(&source), 150);
+  BOOST_CHECK_EQUAL(wire.size(), 160);
+
+  // one reference per non-empty block of the source, then the spare of the first segment
+  std::vector<size_t> sizes = {10, 100, 50, 0};
+  std::vector<size_t> actual = getBlockSizes(wire);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), sizes.begin(), sizes.end());
+  BOOST_CHECK_EQUAL(wire.capacity(), 10 + 150 + 990);
+
+  BlockN::const_iterator begin;
+  BOOST_CHECK_EQUAL(wire.findPosition(begin, 10)->offset(), 10);
+  BOOST_CHECK_EQUAL(begin, getBlockData(source, 0));
+  BOOST_CHECK_EQUAL(wire.findPosition(begin, 110)->offset(), 110);
+  BOOST_CHECK_EQUAL(begin, getBlockData(source, 100));
+
+  wire.appendArray(bytes.data(), 5);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 4);
+  BOOST_CHECK_EQUAL(getBlockData(wire, 160), segment + 10);
+
+  std::vector<uint8_t> expected(bytes.begin() + 150, bytes.begin() + 160);
+  expected.insert(expected.end(), bytes.begin(), bytes.begin() + 150);
+  expected.insert(expected.end(), bytes.begin(), bytes.begin() + 5);
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(AppendWireToItself)
+{
+  std::vector<uint8_t> bytes = makeBytes(100, 13);
+  Wire wire(1000);
+  wire.appendArray(bytes.data(), 100);
+
+  BOOST_CHECK_EQUAL(wire.appendWire(&wire), 100);
+  BOOST_CHECK_EQUAL(wire.size(), 200);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 3);
+  BOOST_CHECK_EQUAL(wire.capacity(), 1100);
+
+  std::vector<uint8_t> expected(bytes);
+  expected.insert(expected.end(), bytes.begin(), bytes.end());
+  shared_ptr<Buffer> buffer = wire.getBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(buffer->begin(), buffer->end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(AppendEmptyWire)
+{
+  Wire wire(100);
+  wire.appendArray(makeBytes(10, 0).data(), 10);
+  Wire empty;
+  BOOST_CHECK_EQUAL(wire.appendWire(&empty), 0);
+  BOOST_CHECK_EQUAL(wire.countBlock(), 1);
+  BOOST_CHECK_EQUAL(wire.capacity(), 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // SharedBlocks
+
+BOOST_AUTO_TEST_SUITE(Comparison)
+
+/** @brief Return a wire holding @p bytes, split into blocks of @p blockSize bytes
+ */
+static Wire
+makeSplitWire(const std::vector<uint8_t>& bytes, size_t blockSize)
+{
+  Wire wire(blockSize);
+  for (size_t offset = 0; offset < bytes.size(); offset += blockSize) {
+    size_t size = std::min(blockSize, bytes.size() - offset);
+    wire.appendSharedBlock(BlockN(bytes.data() + offset, size));
+  }
+  wire.finalize();
+  return wire;
+}
+
+BOOST_AUTO_TEST_CASE(DifferentSegmentation)
+{
+  std::vector<uint8_t> bytes = makeBytes(1000, 17);
+  Wire whole = makeSplitWire(bytes, 1000);
+  Wire small = makeSplitWire(bytes, 7);
+  Wire large = makeSplitWire(bytes, 300);
+  BOOST_CHECK_GT(small.countBlock(), 100);
+
+  BOOST_CHECK(whole.equals(small));
+  BOOST_CHECK(small == large);
+  BOOST_CHECK(!(large != whole));
+  BOOST_CHECK(small == small);
+  BOOST_CHECK_EQUAL(whole.hash(), small.hash());
+  BOOST_CHECK_EQUAL(whole.hash(), large.hash());
+  BOOST_CHECK_EQUAL(std::hash<Wire>()(whole), std::hash<Wire>()(small));
+
+  std::unordered_set<Wire> wires;
+  wires.insert(whole);
+  BOOST_CHECK(wires.count(small) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(Unequal)
+{
+  std::vector<uint8_t> bytes = makeBytes(1000, 19);
+  Wire wire = makeSplitWire(bytes, 100);
+
+  std::vector<uint8_t> changed(bytes);
+  changed[555] ^= 0x01;
+  Wire other = makeSplitWire(changed, 33);
+  BOOST_CHECK(wire != other);
+  BOOST_CHECK(!wire.equals(other));
+  BOOST_CHECK_NE(wire.hash(), other.hash());
+  // the cached hashes decide the comparison
+  BOOST_CHECK(wire != other);
+
+  std::vector<uint8_t> prefix(bytes.begin(), bytes.begin() + 999);
+  Wire shorter = makeSplitWire(prefix, 100);
+  BOOST_CHECK(wire != shorter);
+
+  Wire empty;
+  BOOST_CHECK(empty == Wire());
+  BOOST_CHECK(wire != empty);
+  BOOST_CHECK(empty != wire);
+}
+
+BOOST_AUTO_TEST_CASE(HashInvalidation)
+{
+  std::vector<uint8_t> bytes = makeBytes(200, 23);
+  Wire wire(1000);
+  wire.appendArray(bytes.data(), 100);
+  Wire other = makeSplitWire(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 100), 10);
+  uint64_t hash = wire.hash();
+  BOOST_CHECK_EQUAL(hash, other.hash());
+  BOOST_CHECK(wire == other);
+
+  wire.appendArray(bytes.data() + 100, 100);
+  BOOST_CHECK_NE(wire.hash(), hash);
+  BOOST_CHECK_EQUAL(wire.hash(), makeSplitWire(bytes, 50).hash());
+  BOOST_CHECK(wire != other);
+
+  // overwriting a byte in place changes the hash too
+  hash = wire.hash();
+  wire.setPositon(5);
+  wire.writeUint8(static_cast<uint8_t>(bytes[5] + 1));
+  BOOST_CHECK_NE(wire.hash(), hash);
+
+  wire.setPositon(5);
+  wire.writeUint8(bytes[5]);
+  BOOST_CHECK_EQUAL(wire.hash(), hash);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentCaches)
+{
+  std::vector<uint8_t> bytes = makeBytes(5000, 29);
+  const Wire wire = makeSplitWire(bytes, 700);
+  const Wire reference = makeSplitWire(bytes, 5000);
+  uint64_t expectedHash = reference.hash();
+  ConstBufferPtr expectedDigest = reference.getSha256Digest();
+
+  // readers of a shared wire fill its caches concurrently
+  std::vector<uint64_t> hashes(4);
+  std::vector<ConstBufferPtr> digests(4);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    readers.emplace_back([&wire, &hashes, &digests, i] {
+      digests[i] = wire.getSha256Digest();
+      hashes[i] = wire.hash();
+    });
+  }
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    BOOST_CHECK_EQUAL(hashes[i], expectedHash);
+    BOOST_CHECK_EQUAL_COLLECTIONS(digests[i]->begin(), digests[i]->end(),
+                                  expectedDigest->begin(), expectedDigest->end());
+  }
+  BOOST_CHECK(wire == reference);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Comparison
+
+BOOST_AUTO_TEST_SUITE(Parsing)
+
+/** @brief Make a wire of one block per chunk, linked with appendBlock()
+ */
+static Wire
+makeChainedWire(const std::vector<std::vector<uint8_t>>& chunks)
+{
+  Wire wire(new BlockN(chunks[0].data(), chunks[0].size()));
+  for (size_t i = 1; i < chunks.size(); ++i) {
+    BOOST_CHECK_EQUAL(wire.appendBlock(new BlockN(chunks[i].data(), chunks[i].size())),
+                      chunks[i].size());
+  }
+  return wire;
+}
+
+BOOST_AUTO_TEST_CASE(FindEnd)
+{
+  Wire wire = makeChainedWire({{1, 2, 3}, {4, 5}});
+  BlockN::const_iterator begin;
+  BlockN* last = wire.findPosition(begin, 5);
+  BOOST_CHECK_EQUAL(last->offset(), 3);
+  BOOST_CHECK(begin == last->begin() + last->size());
+  BOOST_CHECK_EQUAL(*(wire.findPosition(begin, 4)->begin()), 4);
+  BOOST_CHECK_EQUAL(*begin, 5);
+  BOOST_CHECK_THROW(wire.findPosition(begin, 6), Wire::Error);
+
+  BlockN* linked = new BlockN(begin, 1);
+  linked->setNext(last);
+  BOOST_CHECK_THROW(wire.appendBlock(linked), Wire::Error);
+  delete linked;
+}
+
+BOOST_AUTO_TEST_CASE(ElementsAcrossBlocks)
+{
+  // the second element spans three blocks, the others are within one
+  Wire wire = makeChainedWire({{0x08, 0x02, 'a', 'b', 0x08, 0x06, 'c', 'd'},
+                               {'e', 'f', 'g'},
+                               {'h', 0x07, 0x01, 'z'}});
+  wire.parse();
+  BOOST_REQUIRE_EQUAL(wire.elements().size(), 3);
+
+  const uint8_t expected[] = {0x08, 0x02, 'a', 'b', 0x08, 0x06, 'c', 'd', 'e', 'f', 'g', 'h',
+                              0x07, 0x01, 'z'};
+  const size_t elementSizes[] = {4, 8, 3};
+  const uint32_t types[] = {0x08, 0x08, 0x07};
+  const size_t blockCounts[] = {1, 3, 1};
+  size_t offset = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    Wire element = wire.elements()[i];
+    BOOST_CHECK_EQUAL(element.type(), types[i]);
+    BOOST_CHECK_EQUAL(element.countBlock(), blockCounts[i]);
+
+    std::vector<uint8_t> bytes;
+    for (Wire::const_iterator j = element.begin(); j != element.end(); ++j) {
+      const uint8_t* data = static_cast<const uint8_t*>((*j).data());
+      bytes.insert(bytes.end(), data, data + (*j).size());
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(bytes.begin(), bytes.end(),
+                                  expected + offset, expected + offset + elementSizes[i]);
+    offset += elementSizes[i];
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Parsing
+
+BOOST_AUTO_TEST_SUITE(Ownership)
+
+BOOST_AUTO_TEST_CASE(Copy)
+{
+  std::vector<uint8_t> bytes = makeBytes(300, 5);
+  Wire wire(128);
+  wire.appendArray(bytes.data(), bytes.size());
+  wire.hash();
+
+  Wire copy(wire);
+  BOOST_CHECK(copy == wire);
+  BOOST_CHECK_EQUAL(copy.hash(), wire.hash());
+  BOOST_CHECK_EQUAL(copy.position(), wire.position());
+
+  // the copy has blocks of its own on the same buffers
+  BlockN::const_iterator begin;
+  BlockN::const_iterator copyBegin;
+  BOOST_CHECK(copy.findPosition(copyBegin, 200) != wire.findPosition(begin, 200));
+  BOOST_CHECK(copyBegin == begin);
+
+  // writing continues in each wire independently
+  copy.writeUint8(0xAA);
+  BOOST_CHECK_EQUAL(copy.size(), 301);
+  BOOST_CHECK_EQUAL(wire.size(), 300);
+
+  Wire assigned;
+  assigned = wire;
+  wire = Wire(16);
+  BOOST_CHECK_EQUAL(assigned.size(), 300);
+  BOOST_CHECK_EQUAL(assigned.readUint8(299), bytes[299]);
+}
+
+BOOST_AUTO_TEST_CASE(Move)
+{
+  Wire wire(128);
+  wire.writeUint8(0x06);
+  BlockN::const_iterator begin;
+  BlockN* block = wire.findPosition(begin, 0);
+
+  Wire moved(std::move(wire));
+  BOOST_CHECK(!wire.hasWire());
+  BOOST_CHECK(moved.findPosition(begin, 0) == block);
+
+  Wire assigned(16);
+  assigned = std::move(moved);
+  BOOST_CHECK(!moved.hasWire());
+  BOOST_CHECK(assigned.findPosition(begin, 0) == block);
+}
+
+BOOST_AUTO_TEST_CASE(ReleaseSegments)
+{
+  SegmentPool::Statistics before = SegmentPool::get().getStatistics();
+  {
+    Wire wire(256);
+    std::vector<uint8_t> bytes = makeBytes(3000, 1);
+    wire.appendArray(bytes.data(), bytes.size());
+    Wire copy(wire);
+    std::vector<Wire> wires(3, copy);
+  }
+  // every segment is returned once the last wire referring to it is destroyed
+  SegmentPool::Statistics after = SegmentPool::get().getStatistics();
+  BOOST_CHECK_GT(after.nAllocations, before.nAllocations);
+  BOOST_CHECK_EQUAL(after.nAllocations - before.nAllocations,
+                    after.nDeallocations - before.nDeallocations);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Ownership
+
+BOOST_AUTO_TEST_SUITE_END() // EncodingWire
+
+} // namespace tests
+} // namespace ndn